@@ -0,0 +1,413 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    Benchmark.cpp
+  \brief   Sweeps UVF conversion parameters over synthetic volumes and
+           reports throughput, compression ratio, memory, brick read
+           latency, brick access trace replay latency and UVF re-brick
+           time per thread count.
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <StdTuvokDefines.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SyntheticVolume.h"
+#include "../Convert/BrickLayout.h"
+#include "../Convert/UVFReBricker.h"
+#include "../DebugOut/StatsTimer.h"
+#include "../Util/ProcessStats.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <Basics/SysTools.h>
+#include <IO/IOManager.h>
+#include <IO/uvfDataset.h>
+
+#pragma GCC diagnostic pop
+
+#pragma warning( disable: 4275 )
+#  include <boost/program_options.hpp>
+#pragma warning( default: 4275 )
+
+using namespace std;
+using namespace tuvok;
+namespace po = boost::program_options;
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+  }
+
+  struct Result {
+    uint64_t iSize;
+    string   strType;
+    double   fEntropy;
+    uint32_t iCompression;
+    uint32_t iLevel;
+    uint32_t iBrickSize;
+    uint32_t iBrickOverlap;
+    uint32_t iLayout;
+    bool     bOk;
+    uint64_t iRawBytes;
+    uint64_t iUVFBytes;
+    double   fConvertSeconds;
+    uint64_t iPeakRSS;
+    uint64_t iBricks;
+    double   fSeqReadMs;   // mean per brick, LOD 0, in index order
+    double   fRandReadMs;  // mean per brick, LOD 0, shuffled order
+    uint64_t iTraceReads;  // trace requests replayed
+    double   fTraceReadMs; // mean per request
+    double   fTraceP99Ms;
+    uint64_t iModelSeeks;  // seeks BrickLayout predicts for the replay
+    double   fStatsSeconds;      // Tuvok's statistics passes, timed from its
+                                 // progress messages
+    uint32_t iStagingThreads; // 0 if no re-brick was timed
+    double   fReBrickSeconds;  // whole re-brick; only staging uses the threads
+  };
+
+  /// Reads every LOD 0 brick once in the given order; returns the mean time
+  /// per brick in ms.  The file is evicted from the page cache first where
+  /// the OS allows it.
+  double TimeBrickReads(const IOManager& ioMan, const string& strUVF,
+                        vector<size_t> order, bool bShuffle)
+  {
+    ProcessStats::DropFileCache(strUVF);
+    std::unique_ptr<Dataset> ds(ioMan.CreateDataset(strUVF, 256, false));
+    if (!ds) return -1.0;
+    if (bShuffle) {
+      std::mt19937 rng(42);
+      std::shuffle(order.begin(), order.end(), rng);
+    }
+    vector<uint8_t> brick;
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0;i<order.size();i++) {
+      ds->GetBrick(BrickKey(0, 0, order[i]), brick);
+    }
+    return order.empty() ? 0.0 : Seconds(start) * 1000.0 / order.size();
+  }
+
+  /// Replays trace against strUVF, cold cache, in request order; requests
+  /// the file has no brick for are skipped.  Fills the trace columns of r.
+  void ReplayBrickTrace(const IOManager& ioMan, const string& strUVF,
+                        const BrickTrace& trace, Result& r)
+  {
+    ProcessStats::DropFileCache(strUVF);
+    std::unique_ptr<Dataset> ds(ioMan.CreateDataset(strUVF, 256, false));
+    const UVFDataset* uvf = dynamic_cast<const UVFDataset*>(ds.get());
+    if (!uvf) return;
+    vector<double> latencies;
+    vector<uint8_t> brick;
+    for (auto a = trace.cbegin(); a != trace.cend(); ++a) {
+      if (a->iLOD >= uvf->GetLODLevelCount()) continue;
+      const UINTVECTOR3 layout = uvf->GetBrickLayout(a->iLOD, 0);
+      if (a->iBrick[0] >= layout.x || a->iBrick[1] >= layout.y ||
+          a->iBrick[2] >= layout.z) {
+        continue;
+      }
+      const size_t iIndex = (size_t(a->iBrick[2]) * layout.y + a->iBrick[1]) *
+                            layout.x + a->iBrick[0];
+      const Clock::time_point start = Clock::now();
+      uvf->GetBrick(BrickKey(0, a->iLOD, iIndex), brick);
+      latencies.push_back(Seconds(start) * 1000.0);
+    }
+    r.iTraceReads = latencies.size();
+    if (latencies.empty()) return;
+    double fSum = 0.0;
+    for (size_t i = 0;i<latencies.size();i++) fSum += latencies[i];
+    r.fTraceReadMs = fSum / latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+    r.fTraceP99Ms = latencies[std::min(latencies.size() - 1,
+                                       latencies.size() * 99 / 100)];
+  }
+
+  void WriteCSV(ostream& out, const vector<Result>& results)
+  {
+    out << "size,type,entropy,compression,level,bricksize,brickoverlap,"
+           "bricklayout,ok,raw_bytes,uvf_bytes,ratio,convert_s,mb_per_s,"
+           "peak_rss_mb,bricks,seq_read_ms,rand_read_ms,trace_reads,"
+           "trace_read_ms,trace_p99_ms,model_seeks,stats_s,staging_threads,"
+           "staging_rebrick_s\n";
+    for (auto r = results.cbegin(); r != results.cend(); ++r) {
+      out << r->iSize << "," << r->strType << "," << r->fEntropy << ","
+          << r->iCompression << "," << r->iLevel << "," << r->iBrickSize << ","
+          << r->iBrickOverlap << "," << r->iLayout << "," << r->bOk << ","
+          << r->iRawBytes << "," << r->iUVFBytes << ","
+          << (r->iUVFBytes ? double(r->iRawBytes)/r->iUVFBytes : 0.0) << ","
+          << r->fConvertSeconds << ","
+          << (r->fConvertSeconds > 0 ? r->iRawBytes/1048576.0/r->fConvertSeconds : 0.0) << ","
+          << r->iPeakRSS/1048576.0 << "," << r->iBricks << ","
+          << r->fSeqReadMs << "," << r->fRandReadMs << ","
+          << r->iTraceReads << "," << r->fTraceReadMs << ","
+          << r->fTraceP99Ms << "," << r->iModelSeeks << ","
+          << r->fStatsSeconds << ","
+          << r->iStagingThreads << "," << r->fReBrickSeconds << "\n";
+    }
+  }
+
+  void WriteJSON(ostream& out, const vector<Result>& results)
+  {
+    out << "[\n";
+    for (auto r = results.cbegin(); r != results.cend(); ++r) {
+      out << "  {\"size\": " << r->iSize
+          << ", \"type\": \"" << r->strType << "\""
+          << ", \"entropy\": " << r->fEntropy
+          << ", \"compression\": " << r->iCompression
+          << ", \"level\": " << r->iLevel
+          << ", \"bricksize\": " << r->iBrickSize
+          << ", \"brickoverlap\": " << r->iBrickOverlap
+          << ", \"bricklayout\": " << r->iLayout
+          << ", \"ok\": " << (r->bOk ? "true" : "false")
+          << ", \"raw_bytes\": " << r->iRawBytes
+          << ", \"uvf_bytes\": " << r->iUVFBytes
+          << ", \"ratio\": " << (r->iUVFBytes ? double(r->iRawBytes)/r->iUVFBytes : 0.0)
+          << ", \"convert_s\": " << r->fConvertSeconds
+          << ", \"mb_per_s\": " << (r->fConvertSeconds > 0 ? r->iRawBytes/1048576.0/r->fConvertSeconds : 0.0)
+          << ", \"peak_rss_mb\": " << r->iPeakRSS/1048576.0
+          << ", \"bricks\": " << r->iBricks
+          << ", \"seq_read_ms\": " << r->fSeqReadMs
+          << ", \"rand_read_ms\": " << r->fRandReadMs
+          << ", \"trace_reads\": " << r->iTraceReads
+          << ", \"trace_read_ms\": " << r->fTraceReadMs
+          << ", \"trace_p99_ms\": " << r->fTraceP99Ms
+          << ", \"model_seeks\": " << r->iModelSeeks
+          << ", \"stats_s\": " << r->fStatsSeconds
+          << ", \"staging_threads\": " << r->iStagingThreads
+          << ", \"staging_rebrick_s\": " << r->fReBrickSeconds
+          << "}" << (r+1 == results.cend() ? "\n" : ",\n");
+    }
+    out << "]\n";
+  }
+}
+
+int main(int argc, const char* argv[])
+{
+  typedef vector<uint32_t> UInts;
+  vector<uint64_t> sizes(1, 128);
+  vector<string> types(1, "uint8");
+  vector<double> entropies(1, 0.1);
+  UInts compressions;
+  UInts levels(1, 1);
+  UInts bricksizes(1, 64);
+  UInts overlaps(1, 2);
+  UInts layouts(1, 0);
+  UInts threads;
+  string strTempDir = "./";
+  string strOutput;
+  string strFormat = "csv";
+  string strTrace;
+  uint32_t iViews = 16;
+  uint32_t iSeed = 1;
+
+  compressions.push_back(0);
+  compressions.push_back(1);
+  compressions.push_back(3);
+
+  try {
+    po::options_description options("uvf converter benchmark");
+    bool showHelp(false);
+    options.add_options()
+      ("help,h", po::bool_switch(&showHelp)->default_value(false), "show help message")
+      ("size", po::value<vector<uint64_t>>(&sizes)->multitoken(), "edge lengths of the cubic test volumes")
+      ("type", po::value<vector<string>>(&types)->multitoken(), "voxel types: uint8, uint16, float")
+      ("entropy", po::value<vector<double>>(&entropies)->multitoken(), "noise fractions in [0,1]")
+      ("compression", po::value<UInts>(&compressions)->multitoken(), "UVF compression methods to sweep")
+      ("level", po::value<UInts>(&levels)->multitoken(), "compression levels to sweep")
+      ("bricksize", po::value<UInts>(&bricksizes)->multitoken(), "brick sizes to sweep")
+      ("brickoverlap", po::value<UInts>(&overlaps)->multitoken(), "brick overlaps to sweep")
+      ("bricklayout", po::value<UInts>(&layouts)->multitoken(), "brick layouts to sweep")
+      ("threads", po::value<UInts>(&threads)->multitoken(), "also time re-bricking every converted UVF with these raw staging thread counts (0: one per core); the LOD build does not use them")
+      ("trace", po::value<string>(&strTrace), "brick requests to replay against every UVF, one 'lod x y z' line each (default: a simulated viewer)")
+      ("views", po::value<uint32_t>(&iViews), "views of the simulated viewer, 0 skips the replay")
+      ("seed", po::value<uint32_t>(&iSeed), "seed for the synthetic data")
+      ("tmpdir", po::value<string>(&strTempDir), "directory for test volumes")
+      ("format", po::value<string>(&strFormat), "result format: csv or json")
+      ("output,o", po::value<string>(&strOutput), "result file (default: stdout)");
+
+    po::variables_map variableMap;
+    po::store(po::command_line_parser(argc, argv).options(options).run(),
+              variableMap);
+    po::notify(variableMap);
+    if (showHelp) {
+      cout << options << endl;
+      return EXIT_SUCCESS;
+    }
+  } catch (const std::exception& e) {
+    cerr << "Command line parse error: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+  if (strFormat != "csv" && strFormat != "json") {
+    cerr << "Unknown result format '" << strFormat << "'\n";
+    return EXIT_FAILURE;
+  }
+  if (!strTempDir.empty() && strTempDir.back() != '/' &&
+      strTempDir.back() != '\\') {
+    strTempDir += "/";
+  }
+
+  BrickTrace recorded;
+  if (!strTrace.empty() && !LoadBrickTrace(strTrace, recorded)) {
+    cerr << "Could not read brick trace '" << strTrace << "'\n";
+    return EXIT_FAILURE;
+  }
+
+  IOManager ioMan;
+  vector<Result> results;
+  StatsTimer* statsTimer = new StatsTimer();
+  statsTimer->SetOutput(true, true, true, true);
+  Controller::Instance().AddDebugOut(statsTimer);
+
+  for (auto size = sizes.cbegin(); size != sizes.cend(); ++size) {
+  for (auto type = types.cbegin(); type != types.cend(); ++type) {
+  for (auto entropy = entropies.cbegin(); entropy != entropies.cend(); ++entropy) {
+    RawVolumeInfo info;
+    if (!SyntheticVolumeInfo(*type, *size, info)) {
+      cerr << "Unknown voxel type '" << *type << "'\n";
+      return EXIT_FAILURE;
+    }
+    const string strRaw  = strTempDir + "bench_volume.raw";
+    const string strNhdr = strTempDir + "bench_volume.nhdr";
+    const string strUVF  = strTempDir + "bench_volume.uvf";
+    const string strReBricked = strTempDir + "bench_rebricked.uvf";
+    cerr << "Generating " << *size << "^3 " << *type << " volume, entropy "
+         << *entropy << "\n";
+    if (!WriteSyntheticVolume(strRaw, strNhdr, info, *entropy, iSeed)) {
+      cerr << "Could not write test volume to " << strTempDir << "\n";
+      return EXIT_FAILURE;
+    }
+
+    for (auto c = compressions.cbegin(); c != compressions.cend(); ++c) {
+    for (auto l = levels.cbegin(); l != levels.cend(); ++l) {
+    for (auto bs = bricksizes.cbegin(); bs != bricksizes.cend(); ++bs) {
+    for (auto ov = overlaps.cbegin(); ov != overlaps.cend(); ++ov) {
+    for (auto lay = layouts.cbegin(); lay != layouts.cend(); ++lay) {
+      Result r = Result();
+      r.iSize = *size; r.strType = *type; r.fEntropy = *entropy;
+      r.iCompression = *c; r.iLevel = *l; r.iBrickSize = *bs;
+      r.iBrickOverlap = *ov; r.iLayout = *lay;
+      r.iRawBytes = info.Bytes();
+
+      cerr << "  compression " << *c << " level " << *l << " bricksize "
+           << *bs << " overlap " << *ov << " layout " << *lay << "\n";
+      ioMan.SetCompression(*c);
+      ioMan.SetCompressionLevel(*l);
+      ioMan.SetLayout(*lay);
+      std::remove(strUVF.c_str());
+      ProcessStats::ResetPeakRSS();
+      statsTimer->Reset();
+
+      const Clock::time_point start = Clock::now();
+      r.bOk = ioMan.ConvertDataset(strNhdr, strUVF, strTempDir, true, *bs, *ov);
+      r.fConvertSeconds = Seconds(start);
+      statsTimer->Stop();
+      r.fStatsSeconds = statsTimer->TotalSeconds();
+      r.iPeakRSS = ProcessStats::PeakRSS();
+
+      if (r.bOk) {
+        r.iUVFBytes = ProcessStats::FileSize(strUVF);
+        std::unique_ptr<Dataset> ds(ioMan.CreateDataset(strUVF, 256, false));
+        vector<size_t> order(ds ? ds->GetBrickCount(0, 0) : 0);
+        ds.reset();
+        for (size_t i = 0;i<order.size();i++) order[i] = i;
+        r.iBricks = order.size();
+        r.fSeqReadMs  = TimeBrickReads(ioMan, strUVF, order, false);
+        r.fRandReadMs = TimeBrickReads(ioMan, strUVF, order, true);
+
+        const uint64_t iDims[3] = {*size, *size, *size};
+        const BrickGrid grid(iDims, *bs, *ov, info.BytesPerVoxel());
+        const BrickTrace trace = strTrace.empty() && iViews > 0
+          ? ViewerTrace(grid, iViews, iSeed) : recorded;
+        if (!trace.empty()) {
+          ReplayBrickTrace(ioMan, strUVF, trace, r);
+          if (*lay < LAYOUT_COUNT) {
+            r.iModelSeeks = ReplayTrace(grid, BrickOffsets(grid, BrickLayout(*lay)),
+                                        trace, ReadCostModel()).iSeeks;
+          }
+        }
+      }
+      r.fReBrickSeconds = -1.0;
+      if (!r.bOk || threads.empty()) {
+        results.push_back(r);
+        continue;
+      }
+
+      // one row per staging thread count.  The threads only parallelize
+      // this tree's raw staging; the LOD pyramid that follows is Tuvok's
+      // and runs the same way for every row.
+      for (auto t = threads.cbegin(); t != threads.cend(); ++t) {
+        cerr << "    re-brick with " << *t << " staging threads\n";
+        std::remove(strReBricked.c_str());
+        ProcessStats::DropFileCache(strUVF);
+        const Clock::time_point rebrick = Clock::now();
+        const bool bOk = ReBrickUVF(ioMan, strUVF, strReBricked, strTempDir,
+                                    *bs, *ov, *t);
+        r.iStagingThreads = *t;
+        r.fReBrickSeconds = bOk ? Seconds(rebrick) : -1.0;
+        results.push_back(r);
+      }
+      std::remove(strReBricked.c_str());
+    }}}}}
+
+    std::remove(strUVF.c_str());
+    std::remove(strRaw.c_str());
+    std::remove(strNhdr.c_str());
+  }}}
+
+  std::ofstream file;
+  if (!strOutput.empty()) {
+    file.open(strOutput.c_str());
+    if (!file.is_open()) {
+      cerr << "Could not create '" << strOutput << "'\n";
+      return EXIT_FAILURE;
+    }
+  }
+  ostream& out = strOutput.empty() ? cout : file;
+  if (strFormat == "json") {
+    WriteJSON(out, results);
+  } else {
+    WriteCSV(out, results);
+  }
+  return EXIT_SUCCESS;
+}
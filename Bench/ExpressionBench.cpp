@@ -0,0 +1,209 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    ExpressionBench.cpp
+  \brief   Compares the interpreted and the compiled merge expression
+           evaluators on random voxels.
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Convert/VoxelType.h"
+#include "../Expr/CompiledExpression.h"
+#include "../Expr/Expression.h"
+
+#pragma warning( disable: 4275 )
+#  include <boost/program_options.hpp>
+#pragma warning( default: 4275 )
+
+using namespace std;
+namespace po = boost::program_options;
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+  }
+
+  bool ParseType(const string& strType, VoxelType& t) {
+    const char* names[] = {"uint8", "int8", "uint16", "int16",
+                           "uint32", "int32", "float", "double"};
+    for (int i = 0;i<VT_UNSUPPORTED;i++) {
+      if (strType == names[i]) {
+        t = VoxelType(i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Random voxels covering most of the type's range.
+  void FillRandom(VoxelType t, vector<uint8_t>& data, size_t iCount,
+                  std::mt19937& rng) {
+    vector<double> values(iCount);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    double fMax = 1.0;
+    switch (t) {
+      case VT_UINT8:  case VT_INT8:  fMax = 127.0; break;
+      case VT_UINT16: case VT_INT16: fMax = 32767.0; break;
+      case VT_UINT32: case VT_INT32: fMax = 2147483647.0; break;
+      default: fMax = 1000.0; break;
+    }
+    for (size_t i = 0;i<iCount;i++) values[i] = dist(rng) * fMax;
+    data.resize(iCount * GetVoxelTypeSize(t));
+    StoreFromDouble(t, &values[0], &data[0], iCount);
+  }
+}
+
+int main(int argc, const char* argv[])
+{
+  string strExpression, strType;
+  size_t iVoxels, iRepeat, iInputs;
+
+  po::options_description desc("Options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("expression", po::value<string>(&strExpression)->default_value(
+       "v[0] > 64 ? (v[0] + v[1]) * 0.5 : max(v[1] - 10, 0)"),
+     "merge expression to evaluate")
+    ("type", po::value<string>(&strType)->default_value("uint16"),
+     "voxel type of every input and the output: uint8, int8, uint16, "
+     "int16, uint32, int32, float or double")
+    ("inputs", po::value<size_t>(&iInputs)->default_value(2),
+     "number of input volumes")
+    ("voxels", po::value<size_t>(&iVoxels)->default_value(1<<22),
+     "voxels per input")
+    ("repeat", po::value<size_t>(&iRepeat)->default_value(5),
+     "timed passes, the fastest one is reported");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+  } catch (const po::error& e) {
+    cerr << e.what() << "\n" << desc << "\n";
+    return EXIT_FAILURE;
+  }
+  if (vm.count("help")) {
+    cout << desc << "\n";
+    return EXIT_SUCCESS;
+  }
+
+  VoxelType t;
+  if (!ParseType(strType, t) || iVoxels == 0 || iInputs == 0) {
+    cerr << "Invalid --type, --voxels or --inputs\n" << desc << "\n";
+    return EXIT_FAILURE;
+  }
+
+  try {
+    const Expression expr(strExpression);
+    if (expr.GetVolumeCount() > iInputs) {
+      cerr << "The expression needs " << expr.GetVolumeCount()
+           << " inputs\n";
+      return EXIT_FAILURE;
+    }
+
+    std::mt19937 rng(42);
+    vector<vector<uint8_t>> inputs(iInputs);
+    vector<const uint8_t*> pInputs(iInputs);
+    for (size_t i = 0;i<iInputs;i++) {
+      FillRandom(t, inputs[i], iVoxels, rng);
+      pInputs[i] = &inputs[i][0];
+    }
+    const size_t iVoxelSize = GetVoxelTypeSize(t);
+    vector<uint8_t> interpreted(iVoxels * iVoxelSize);
+    vector<uint8_t> compiled(iVoxels * iVoxelSize);
+
+    // interpreted: the former per voxel path of the bricked evaluator
+    const size_t iRow = 256;
+    vector<vector<double>> rows(iInputs, vector<double>(iRow));
+    vector<double> voxel(iInputs), result(iRow);
+    double fInterpreted = 1e30;
+    for (size_t r = 0;r<iRepeat;r++) {
+      const Clock::time_point start = Clock::now();
+      for (size_t iStart = 0;iStart<iVoxels;iStart+=iRow) {
+        const size_t n = std::min(iRow, iVoxels-iStart);
+        for (size_t i = 0;i<iInputs;i++) {
+          LoadAsDouble(t, pInputs[i] + iStart*iVoxelSize, &rows[i][0], n);
+        }
+        for (size_t x = 0;x<n;x++) {
+          for (size_t i = 0;i<iInputs;i++) voxel[i] = rows[i][x];
+          result[x] = expr.Evaluate(&voxel[0]);
+        }
+        StoreFromDouble(t, &result[0], &interpreted[iStart*iVoxelSize], n);
+      }
+      fInterpreted = std::min(fInterpreted, Seconds(start));
+    }
+
+    const CompiledExpression kernel(expr, vector<VoxelType>(iInputs, t), t);
+    vector<uint8_t> scratch;
+    double fCompiled = 1e30;
+    for (size_t r = 0;r<iRepeat;r++) {
+      const Clock::time_point start = Clock::now();
+      kernel.Evaluate(&pInputs[0], iVoxels, &compiled[0], scratch);
+      fCompiled = std::min(fCompiled, Seconds(start));
+    }
+
+    vector<double> a(iVoxels), b(iVoxels);
+    LoadAsDouble(t, &interpreted[0], &a[0], iVoxels);
+    LoadAsDouble(t, &compiled[0], &b[0], iVoxels);
+    double fMaxDiff = 0.0;
+    size_t iMismatches = 0;
+    for (size_t i = 0;i<iVoxels;i++) {
+      const double d = std::fabs(a[i] - b[i]);
+      if (d > 0.0 || std::isnan(d)) iMismatches++;
+      if (d > fMaxDiff) fMaxDiff = d;
+    }
+
+    cout << "expression:    " << strExpression << "\n"
+         << "type:          " << strType << " x " << iInputs << "\n"
+         << "kernel:        "
+         << (kernel.IsSinglePrecision() ? "single" : "double") << " precision, "
+         << CompiledExpression::GetInstructionSet() << "\n"
+         << "interpreted:   " << iVoxels/1e6/fInterpreted << " Mvoxels/s\n"
+         << "compiled:      " << iVoxels/1e6/fCompiled << " Mvoxels/s\n"
+         << "speedup:       " << fInterpreted/fCompiled << "x\n"
+         << "mismatches:    " << iMismatches << " (max abs diff "
+         << fMaxDiff << ")\n";
+  } catch (const std::exception& e) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    SyntheticVolume.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "SyntheticVolume.h"
+
+bool SyntheticVolumeInfo(const std::string& strType, uint64_t iSize,
+                         RawVolumeInfo& info)
+{
+  info = RawVolumeInfo();
+  info.iSize[0] = info.iSize[1] = info.iSize[2] = iSize;
+  if (strType == "uint8") {
+    info.iBitWidth = 8;
+  } else if (strType == "uint16") {
+    info.iBitWidth = 16;
+  } else if (strType == "float") {
+    info.iBitWidth = 32;
+    info.bFloat = true;
+    info.bSigned = true;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+namespace {
+  template<typename T> void Store(double v, uint8_t* dst) {
+    const T t = T(v * double(std::numeric_limits<T>::max()));
+    memcpy(dst, &t, sizeof(T));
+  }
+  template<> void Store<float>(double v, uint8_t* dst) {
+    const float f = float(v);
+    memcpy(dst, &f, sizeof(float));
+  }
+}
+
+bool WriteSyntheticVolume(const std::string& strRawFile,
+                          const std::string& strHeaderFile,
+                          const RawVolumeInfo& info,
+                          double fEntropy, uint32_t iSeed)
+{
+  std::ofstream raw(strRawFile.c_str(), std::ios::out | std::ios::binary |
+                                        std::ios::trunc);
+  if (!raw.is_open()) return false;
+
+  std::mt19937 rng(iSeed);
+  std::uniform_real_distribution<double> noise(0.0, 1.0);
+  const double fNoise = std::min(1.0, std::max(0.0, fEntropy));
+  // a handful of blobs across the volume, independent of its size
+  const double fFreq = 6.2831853 * 3.0 / double(info.iSize[0]);
+
+  const uint64_t bpv = info.BytesPerVoxel();
+  std::vector<uint8_t> slice(size_t(info.BytesPerSlice()));
+  for (uint64_t z = 0;z<info.iSize[2];z++) {
+    uint8_t* dst = &slice[0];
+    for (uint64_t y = 0;y<info.iSize[1];y++) {
+      for (uint64_t x = 0;x<info.iSize[0];x++) {
+        const double smooth = 0.5 + 0.5 * std::sin(x*fFreq) *
+                              std::sin(y*fFreq) * std::sin(z*fFreq);
+        const double v = (1.0-fNoise)*smooth + fNoise*noise(rng);
+        switch (info.iBitWidth) {
+          case 8:  Store<uint8_t>(v, dst);  break;
+          case 16: Store<uint16_t>(v, dst); break;
+          default: Store<float>(v, dst);    break;
+        }
+        dst += bpv;
+      }
+    }
+    raw.write(reinterpret_cast<const char*>(&slice[0]),
+              std::streamsize(slice.size()));
+  }
+  if (!raw.good()) return false;
+  raw.close();
+
+  return WriteNRRDHeader(strHeaderFile, strRawFile, info);
+}
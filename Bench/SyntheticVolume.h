@@ -0,0 +1,58 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    SyntheticVolume.h
+  \brief   Generates reproducible test volumes for benchmarking.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef SYNTHETICVOLUME_H
+#define SYNTHETICVOLUME_H
+
+#include <string>
+#include "../Convert/RawStaging.h"
+
+/// Fills the type and size fields of a cubic volume.  strType is one of
+/// uint8, uint16, float.  Returns false for unknown types.
+bool SyntheticVolumeInfo(const std::string& strType, uint64_t iSize,
+                         RawVolumeInfo& info);
+
+/// Writes a raw volume plus detached NRRD header.  The data is a smooth
+/// blob field mixed with uniform noise; fEntropy in [0,1] is the noise
+/// fraction, so 0 compresses very well and 1 hardly at all.  The same seed
+/// always yields the same bytes.
+bool WriteSyntheticVolume(const std::string& strRawFile,
+                          const std::string& strHeaderFile,
+                          const RawVolumeInfo& info,
+                          double fEntropy, uint32_t iSeed);
+
+#endif // SYNTHETICVOLUME_H
@@ -0,0 +1,190 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    WriterBench.cpp
+  \brief   Compares the staging file backends of AsyncFileWriter with the
+           buffered stream writes staging used before, while a compute
+           pass runs between the writes.
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Util/AsyncWriter.h"
+#include "../Util/ProcessStats.h"
+
+#pragma warning( disable: 4275 )
+#  include <boost/program_options.hpp>
+#pragma warning( default: 4275 )
+
+using namespace std;
+namespace po = boost::program_options;
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+  }
+
+  /// Stand-in for bricking and compression: iPasses rounds of a cheap
+  /// hash over the box, which also changes its bytes.
+  void Compute(vector<uint8_t>& box, uint32_t iPasses, uint32_t& iState) {
+    for (uint32_t p = 0;p<iPasses;p++) {
+      for (size_t i = 0;i<box.size();i++) {
+        iState = (iState ^ box[i]) * 16777619u;
+        box[i] = uint8_t(iState >> 24);
+      }
+    }
+  }
+
+  /// Writes iBoxes boxes of full width slabs, computing each before it is
+  /// written, like a staging run with a single producer.  The time includes
+  /// getting the data to the device, not just into the page cache.
+  template <class Sink>
+  double Run(Sink& sink, const string& strFile, size_t iBoxes,
+             size_t iBoxBytes, uint32_t iPasses) {
+    vector<uint8_t> box(iBoxBytes);
+    uint32_t iState = 2166136261u;
+    const Clock::time_point start = Clock::now();
+    for (size_t b = 0;b<iBoxes;b++) {
+      Compute(box, iPasses, iState);
+      if (!sink.Write(uint64_t(b) * iBoxBytes, &box[0], box.size())) return -1.0;
+    }
+    if (!sink.Close()) return -1.0;
+    // syncs, and keeps the data from flattering the next run
+    ProcessStats::DropFileCache(strFile);
+    return Seconds(start);
+  }
+
+  /// The former RawStagingFile output.
+  struct StreamSink {
+    explicit StreamSink(const string& strFile) :
+      file(strFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc) {}
+    bool Write(uint64_t iOffset, const uint8_t* p, size_t iBytes) {
+      file.seekp(std::streamoff(iOffset));
+      file.write(reinterpret_cast<const char*>(p), std::streamsize(iBytes));
+      return file.good();
+    }
+    bool Close() {
+      file.close();
+      return !file.fail();
+    }
+    std::fstream file;
+  };
+}
+
+int main(int argc, const char* argv[])
+{
+  size_t iMegabytes, iBoxMegabytes;
+  uint32_t iPasses;
+  string strFile;
+  vector<string> backends;
+
+  po::options_description desc("Options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("file", po::value<string>(&strFile)->default_value("writerbench.raw"),
+     "scratch file, on the device to measure")
+    ("size", po::value<size_t>(&iMegabytes)->default_value(2048),
+     "MB written per run")
+    ("box", po::value<size_t>(&iBoxMegabytes)->default_value(8),
+     "MB per staged box")
+    ("compute", po::value<uint32_t>(&iPasses)->default_value(1),
+     "hash passes over every box before it is written, 0 for pure I/O")
+    ("backend", po::value<vector<string>>(&backends)->multitoken(),
+     "backends to time: stream, sync, threads, uring (default: all)");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+  } catch (const po::error& e) {
+    cerr << e.what() << "\n" << desc << "\n";
+    return EXIT_FAILURE;
+  }
+  if (vm.count("help")) {
+    cout << desc << "\n";
+    return EXIT_SUCCESS;
+  }
+  if (iMegabytes == 0 || iBoxMegabytes == 0) {
+    cerr << "Invalid --size or --box\n" << desc << "\n";
+    return EXIT_FAILURE;
+  }
+  if (backends.empty()) {
+    backends.push_back("stream");
+    backends.push_back("sync");
+    backends.push_back("threads");
+    backends.push_back("uring");
+  }
+
+  const size_t iBoxBytes = iBoxMegabytes << 20;
+  const size_t iBoxes = std::max<size_t>(iMegabytes / iBoxMegabytes, 1);
+  const double fMegabytes = double(iBoxes * iBoxBytes) / 1048576.0;
+
+  cout << "backend  direct  seconds   MB/s\n";
+  for (auto b = backends.cbegin(); b != backends.cend(); ++b) {
+    AsyncFileWriter::Backend eBackend = AsyncFileWriter::BACKEND_SYNC;
+    if (*b != "stream" && !AsyncFileWriter::ParseBackend(*b, eBackend)) {
+      cerr << "Unknown backend '" << *b << "'\n";
+      return EXIT_FAILURE;
+    }
+    for (int iDirect = 0;iDirect<(*b == "stream" ? 1 : 2);iDirect++) {
+      std::remove(strFile.c_str());
+      double fSeconds;
+      string strUsed = *b;
+      bool bDirect = false;
+      if (*b == "stream") {
+        StreamSink sink(strFile);
+        fSeconds = Run(sink, strFile, iBoxes, iBoxBytes, iPasses);
+      } else {
+        AsyncFileWriter sink(strFile, true, eBackend, iDirect != 0);
+        strUsed = AsyncFileWriter::BackendName(sink.GetBackend());
+        bDirect = sink.IsDirect();
+        fSeconds = Run(sink, strFile, iBoxes, iBoxBytes, iPasses);
+      }
+      printf("%-8s %-6s  %7.2f  %6.0f%s\n", strUsed.c_str(),
+             bDirect ? "yes" : "no", fSeconds, fMegabytes / fSeconds,
+             fSeconds < 0 ? "  (write failed)" : "");
+      if (iDirect != 0 && !bDirect) {
+        printf("         direct I/O is not available for '%s'\n",
+               strFile.c_str());
+      }
+    }
+  }
+  std::remove(strFile.c_str());
+  return EXIT_SUCCESS;
+}
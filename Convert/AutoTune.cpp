@@ -0,0 +1,343 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    AutoTune.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+#include "AutoTune.h"
+#include "BrickLayout.h"
+#include "CompressionChoice.h"
+#include "UVFExport.h"
+#include "../DebugOut/ProfileOut.h"
+#include "../Util/ProcessStats.h"
+#include "../Util/WorkerPool.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <Basics/SysTools.h>
+#include <IO/IOManager.h>
+#include <IO/uvfDataset.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  double Seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+  }
+
+  /// Box of at most iVoxels in the center of a volume of iSize, as cubic as
+  /// the volume allows: axes shorter than the cube are taken whole and the
+  /// others grow to use up the budget.
+  void CenterBox(const uint64_t iSize[3], uint64_t iVoxels,
+                 uint64_t iOrigin[3], uint64_t iBox[3])
+  {
+    bool bWhole[3] = {false, false, false};
+    for (int iPass = 0;iPass<3;iPass++) {
+      uint64_t iFixed = 1;
+      int iFree = 0;
+      for (int i = 0;i<3;i++) {
+        if (bWhole[i]) iFixed *= iBox[i]; else iFree++;
+      }
+      if (iFree == 0) break;
+      const uint64_t iSide = std::max<uint64_t>(1, uint64_t(1e-6 +
+        std::pow(double(std::max<uint64_t>(iVoxels / iFixed, 1)), 1.0 / iFree)));
+      bool bChanged = false;
+      for (int i = 0;i<3;i++) {
+        if (bWhole[i]) continue;
+        iBox[i] = std::min(iSize[i], iSide);
+        if (iSize[i] <= iSide) bWhole[i] = bChanged = true;
+      }
+      if (!bChanged) break;
+    }
+    for (int i = 0;i<3;i++) iOrigin[i] = (iSize[i] - iBox[i]) / 2;
+  }
+
+  /// Copies a box out of a headerless, x fastest raw file, swapping the
+  /// bytes of each component if bSwap.
+  bool CopyBox(const std::string& strSource, uint64_t iHeaderSkip,
+               const RawVolumeInfo& volume, bool bSwap,
+               const uint64_t iOrigin[3], const uint64_t iBox[3],
+               const std::string& strTarget)
+  {
+    std::ifstream in(strSource.c_str(), std::ios::binary);
+    std::ofstream out(strTarget.c_str(), std::ios::binary | std::ios::trunc);
+    if (!in.is_open() || !out.is_open()) return false;
+
+    const uint64_t bpv = volume.BytesPerVoxel();
+    const size_t iComponentBytes = volume.iBitWidth / 8;
+    std::vector<char> row(size_t(iBox[0] * bpv));
+    for (uint64_t z = iOrigin[2];z<iOrigin[2]+iBox[2];z++) {
+      for (uint64_t y = iOrigin[1];y<iOrigin[1]+iBox[1];y++) {
+        in.seekg(std::streamoff(iHeaderSkip +
+          ((z * volume.iSize[1] + y) * volume.iSize[0] + iOrigin[0]) * bpv));
+        if (!in.read(&row[0], std::streamsize(row.size()))) return false;
+        if (bSwap && iComponentBytes > 1) {
+          for (size_t i = 0;i<row.size();i+=iComponentBytes) {
+            std::reverse(row.begin()+i, row.begin()+i+iComponentBytes);
+          }
+        }
+        out.write(&row[0], std::streamsize(row.size()));
+      }
+    }
+    return bool(out.flush());
+  }
+
+  /// Mean cold cache time in ms to read the bricks a viewer orbiting the
+  /// UVF asks for per view.  Requests outside the file's bricking are
+  /// skipped.
+  double TimeViews(const IOManager& ioMan, const std::string& strUVF,
+                   const RawVolumeInfo& info, const TuneTrial& trial)
+  {
+    const size_t iViews = 8;
+    const BrickGrid grid(info.iSize, trial.iBrickSize, trial.iBrickOverlap,
+                         info.BytesPerVoxel());
+    const BrickTrace trace = ViewerTrace(grid, iViews);
+
+    ProcessStats::DropFileCache(strUVF);
+    std::unique_ptr<Dataset> ds(ioMan.CreateDataset(strUVF, 256, false));
+    const UVFDataset* uvf = dynamic_cast<const UVFDataset*>(ds.get());
+    if (!uvf) return -1.0;
+    std::vector<uint8_t> brick;
+    const Clock::time_point start = Clock::now();
+    for (auto a = trace.cbegin(); a != trace.cend(); ++a) {
+      if (a->iLOD >= uvf->GetLODLevelCount()) continue;
+      const UINTVECTOR3 layout = uvf->GetBrickLayout(a->iLOD, 0);
+      if (a->iBrick[0] >= layout.x || a->iBrick[1] >= layout.y ||
+          a->iBrick[2] >= layout.z) {
+        continue;
+      }
+      const size_t iIndex = (size_t(a->iBrick[2]) * layout.y + a->iBrick[1]) *
+                            layout.x + a->iBrick[0];
+      uvf->GetBrick(BrickKey(0, a->iLOD, iIndex), brick);
+    }
+    return Seconds(start) * 1000.0 / iViews;
+  }
+
+  /// Lower is better.  Trials within 2% of the best size count as equally
+  /// small, so the faster of them wins.
+  double Cost(const TuneTrial& trial, TuneGoal eGoal)
+  {
+    switch (eGoal) {
+      case TUNE_FILE_SIZE:     return double(trial.iUVFBytes);
+      case TUNE_READ_LATENCY:  return trial.fViewMs;
+      default:                 return trial.fConvertSeconds;
+    }
+  }
+
+  size_t Best(const std::vector<TuneTrial>& vTrials, size_t iFirst,
+              TuneGoal eGoal)
+  {
+    size_t iBest = vTrials.size();
+    for (size_t i = iFirst;i<vTrials.size();i++) {
+      if (!vTrials[i].bOk) continue;
+      if (iBest == vTrials.size()) {
+        iBest = i;
+        continue;
+      }
+      const double fCost = Cost(vTrials[i], eGoal);
+      const double fBest = Cost(vTrials[iBest], eGoal);
+      if (eGoal == TUNE_FILE_SIZE && std::abs(fCost - fBest) <= 0.02 * fBest) {
+        if (vTrials[i].fConvertSeconds < vTrials[iBest].fConvertSeconds) iBest = i;
+      } else if (fCost < fBest) {
+        iBest = i;
+      }
+    }
+    return iBest;
+  }
+}
+
+bool ParseTuneGoal(const std::string& strGoal, TuneGoal& eGoal)
+{
+  for (int i = 0;i<TUNE_GOAL_COUNT;i++) {
+    if (strGoal == TuneGoalName(TuneGoal(i))) {
+      eGoal = TuneGoal(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* TuneGoalName(TuneGoal eGoal)
+{
+  switch (eGoal) {
+    case TUNE_CONVERT_SPEED: return "convert-speed";
+    case TUNE_FILE_SIZE:     return "file-size";
+    case TUNE_READ_LATENCY:  return "read-latency";
+    default:                 return "unknown";
+  }
+}
+
+double TuneResult::Throughput(size_t i) const
+{
+  const TuneTrial& trial = vTrials[i];
+  return trial.fConvertSeconds > 0.0
+    ? double(iSampleBytes) / 1024.0 / 1024.0 / trial.fConvertSeconds : 0.0;
+}
+
+bool SampleVolume(const IOManager& ioMan, const std::string& strSource,
+                  const std::string& strRawFile, const std::string& strTempDir,
+                  uint64_t iMaxBytes, RawVolumeInfo& volume,
+                  RawVolumeInfo& sample)
+{
+  ProfileScope stage("SampleVolume");
+  uint64_t iOrigin[3], iBox[3];
+  if (!ioMan.NeedsConversion(strSource)) {
+    std::unique_ptr<Dataset> ds(ioMan.CreateDataset(strSource, 256, false));
+    if (!ds) return false;
+    volume = RawVolumeInfo(*ds);
+    ds.reset();
+    CenterBox(volume.iSize, iMaxBytes / volume.BytesPerVoxel(), iOrigin, iBox);
+    sample = volume;
+    std::vector<uint64_t> vRegion;
+    for (int i = 0;i<3;i++) {
+      sample.iSize[i] = iBox[i];
+      vRegion.push_back(iOrigin[i]);
+    }
+    for (int i = 0;i<3;i++) vRegion.push_back(iOrigin[i] + iBox[i]);
+    return ExportUVF(ioMan, strSource, strRawFile, strTempDir, 0, vRegion,
+                     64, 2, WorkerPool::HardwareThreads());
+  }
+
+  // most converters hand back the source itself with a header to skip,
+  // the others stage all of it, which the conversion does anyway
+  std::string strIntermediate;
+  uint64_t iHeaderSkip = 0;
+  bool bConvertEndianness = false;
+  bool bDeleteIntermediate = false;
+  if (!StageRawSource(ioMan, strSource, strTempDir, strIntermediate,
+                      iHeaderSkip, bConvertEndianness, volume,
+                      bDeleteIntermediate)) {
+    return false;
+  }
+  CenterBox(volume.iSize, iMaxBytes / volume.BytesPerVoxel(), iOrigin, iBox);
+  sample = volume;
+  for (int i = 0;i<3;i++) sample.iSize[i] = iBox[i];
+  const bool bOk = CopyBox(strIntermediate, iHeaderSkip, volume,
+                           bConvertEndianness, iOrigin, iBox, strRawFile) &&
+                   WriteNRRDHeader(SysTools::ChangeExt(strRawFile, "nhdr"),
+                                   strRawFile, sample);
+  if (bDeleteIntermediate) std::remove(strIntermediate.c_str());
+  return bOk;
+}
+
+bool AutoTune(IOManager& ioMan, const std::string& strSource,
+              const std::string& strTempDir, TuneGoal eGoal,
+              uint32_t iBrickOverlap, TuneResult& result,
+              uint64_t iSampleBytes)
+{
+  ProfileScope stage("AutoTune");
+  const std::string strRaw = SysTools::FindNextSequenceName(
+    strTempDir + SysTools::GetFilename(SysTools::RemoveExt(strSource)) +
+    "_sample.raw");
+  const std::string strHeader = SysTools::ChangeExt(strRaw, "nhdr");
+  const std::string strUVF = SysTools::RemoveExt(strRaw) + "_trial.uvf";
+
+  RawVolumeInfo sample;
+  if (!SampleVolume(ioMan, strSource, strRaw, strTempDir, iSampleBytes,
+                    result.volume, sample)) {
+    std::remove(strRaw.c_str());
+    std::remove(strHeader.c_str());
+    return false;
+  }
+  result.iSampleBytes = sample.Bytes();
+  MESSAGE("Sampled %ux%ux%u voxels of '%s'", unsigned(sample.iSize[0]),
+          unsigned(sample.iSize[1]), unsigned(sample.iSize[2]),
+          strSource.c_str());
+
+  // fast codecs for speed and latency; for size also the slow ones, at
+  // a level that still decodes quickly
+  struct Codec { uint32_t iCompression, iLevel; };
+  static const Codec fastCodecs[] = {{0, 1}, {3, 1}, {1, 1}};
+  static const Codec smallCodecs[] = {{3, 1}, {1, 1}, {1, 6}, {2, 1}};
+  const Codec* pCodecs = eGoal == TUNE_FILE_SIZE ? smallCodecs : fastCodecs;
+  const size_t iCodecs = eGoal == TUNE_FILE_SIZE ? 4 : 3;
+
+  auto trial = [&](uint32_t iBrickSize, uint32_t iCompression, uint32_t iLevel) {
+    TuneTrial t;
+    t.iBrickSize = iBrickSize;
+    t.iBrickOverlap = iBrickOverlap;
+    t.iCompression = iCompression;
+    t.iLevel = iLevel;
+    MESSAGE("Trial: brick size %u, %s level %u", unsigned(iBrickSize),
+            CompressionName(iCompression), unsigned(iLevel));
+    ioMan.SetCompression(iCompression);
+    ioMan.SetCompressionLevel(iLevel);
+    std::remove(strUVF.c_str());
+    ProcessStats::DropFileCache(strRaw);
+    const Clock::time_point start = Clock::now();
+    t.bOk = ioMan.ConvertDataset(strHeader, strUVF, strTempDir, true,
+                                 iBrickSize, iBrickOverlap);
+    t.fConvertSeconds = Seconds(start);
+    if (t.bOk) {
+      t.iUVFBytes = ProcessStats::FileSize(strUVF);
+      t.fViewMs = TimeViews(ioMan, strUVF, sample, t);
+    }
+    result.vTrials.push_back(t);
+  };
+
+  uint64_t iLargest = 0;
+  for (int i = 0;i<3;i++) iLargest = std::max(iLargest, sample.iSize[i]);
+  const uint32_t iFirstSize = 64;
+  for (size_t i = 0;i<iCodecs;i++) {
+    trial(iFirstSize, pCodecs[i].iCompression, pCodecs[i].iLevel);
+  }
+  const size_t iCodec = Best(result.vTrials, 0, eGoal);
+  if (iCodec < result.vTrials.size()) {
+    // a brick size past the sample only repeats the previous trial
+    static const uint32_t sizes[] = {32, 128, 256};
+    for (size_t i = 0;i<3;i++) {
+      if (sizes[i] <= 2*iBrickOverlap) continue;
+      if (sizes[i]/2 >= iLargest) break;
+      trial(sizes[i], result.vTrials[iCodec].iCompression,
+            result.vTrials[iCodec].iLevel);
+    }
+  }
+  result.iBest = Best(result.vTrials, 0, eGoal);
+
+  std::remove(strUVF.c_str());
+  std::remove(strRaw.c_str());
+  std::remove(strHeader.c_str());
+  return result.iBest < result.vTrials.size();
+}
@@ -0,0 +1,111 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    AutoTune.h
+  \brief   Picks brick size and compression for a dataset from trial
+           conversions of a sample of it.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <string>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+#include "RawStaging.h"
+
+namespace tuvok {
+  class IOManager;
+}
+
+/// What --auto-tune optimizes for.
+enum TuneGoal {
+  TUNE_CONVERT_SPEED,  ///< raw MB converted per second
+  TUNE_FILE_SIZE,      ///< smallest UVF
+  TUNE_READ_LATENCY,   ///< shortest time to load the bricks of a view
+  TUNE_GOAL_COUNT
+};
+
+/// Parses convert-speed, file-size or read-latency.
+bool ParseTuneGoal(const std::string& strGoal, TuneGoal& eGoal);
+const char* TuneGoalName(TuneGoal eGoal);
+
+/// Settings and measurements of one trial conversion of the sample.
+struct TuneTrial {
+  TuneTrial() : iBrickSize(0), iBrickOverlap(0), iCompression(0), iLevel(1),
+    bOk(false), iUVFBytes(0), fConvertSeconds(0.0), fViewMs(0.0) {}
+
+  uint32_t iBrickSize;
+  uint32_t iBrickOverlap;
+  uint32_t iCompression;
+  uint32_t iLevel;
+  bool     bOk;
+  uint64_t iUVFBytes;
+  double   fConvertSeconds;
+  double   fViewMs;        ///< mean cold cache time to read the bricks of
+                           ///< one simulated view
+};
+
+struct TuneResult {
+  TuneResult() : iBest(0), iSampleBytes(0) {}
+
+  /// Megabytes of raw sample converted per second by trial i.
+  double Throughput(size_t i) const;
+
+  RawVolumeInfo          volume;   ///< the whole input
+  std::vector<TuneTrial> vTrials;
+  size_t                 iBest;    ///< index into vTrials
+  uint64_t               iSampleBytes;
+};
+
+/// Copies a box of at most iMaxBytes from the center of strSource to the
+/// raw file strRawFile, with a detached NRRD header next to it (same name,
+/// .nhdr).  UVFs are read brick by brick through ExportUVF, other formats
+/// through the raw data their Tuvok converter stages.  volume describes
+/// the whole source, sample the box.
+bool SampleVolume(const tuvok::IOManager& ioMan, const std::string& strSource,
+                  const std::string& strRawFile, const std::string& strTempDir,
+                  uint64_t iMaxBytes, RawVolumeInfo& volume,
+                  RawVolumeInfo& sample);
+
+/// Converts a sample of strSource with candidate settings and picks the
+/// best trial for eGoal.  Compression methods are tried first at a brick
+/// size of 64, then brick sizes with the best method.  The overlap stays
+/// at iBrickOverlap and the layout at whatever ioMan is set to; ioMan's
+/// compression is left at the last trial's.  Fails if no trial converted.
+bool AutoTune(tuvok::IOManager& ioMan, const std::string& strSource,
+              const std::string& strTempDir, TuneGoal eGoal,
+              uint32_t iBrickOverlap, TuneResult& result,
+              uint64_t iSampleBytes = 32*1024*1024);
+
+#endif // AUTOTUNE_H
@@ -0,0 +1,350 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    BrickLayout.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+#include "BrickLayout.h"
+
+namespace {
+  uint64_t MortonKey(const uint32_t p[3]) {
+    uint64_t iKey = 0;
+    for (unsigned b = 0;b<21;b++) {
+      for (unsigned i = 0;i<3;i++) {
+        iKey |= uint64_t((p[i] >> b) & 1) << (3*b + i);
+      }
+    }
+    return iKey;
+  }
+
+  /// Skilling's transform of coordinates with iBits bits each to their
+  /// distance along a Hilbert curve.
+  uint64_t HilbertKey(const uint32_t p[3], unsigned iBits) {
+    uint32_t x[3] = {p[0], p[1], p[2]};
+    const uint32_t M = 1u << (iBits - 1);
+    for (uint32_t Q = M;Q>1;Q >>= 1) {
+      const uint32_t P = Q - 1;
+      for (unsigned i = 0;i<3;i++) {
+        if (x[i] & Q) {
+          x[0] ^= P;
+        } else {
+          const uint32_t t = (x[0] ^ x[i]) & P;
+          x[0] ^= t;
+          x[i] ^= t;
+        }
+      }
+    }
+    for (unsigned i = 1;i<3;i++) x[i] ^= x[i-1];
+    uint32_t t = 0;
+    for (uint32_t Q = M;Q>1;Q >>= 1) {
+      if (x[2] & Q) t ^= Q - 1;
+    }
+    for (unsigned i = 0;i<3;i++) x[i] ^= t;
+
+    uint64_t iKey = 0;
+    for (unsigned b = iBits;b-- > 0;) {
+      for (unsigned i = 0;i<3;i++) iKey = (iKey << 1) | ((x[i] >> b) & 1);
+    }
+    return iKey;
+  }
+
+  void BrickCoords(const BrickGrid::Level& level, uint64_t iIndex,
+                   uint32_t iBrick[3]) {
+    iBrick[0] = uint32_t(iIndex % level.iBricks[0]);
+    iBrick[1] = uint32_t(iIndex / level.iBricks[0] % level.iBricks[1]);
+    iBrick[2] = uint32_t(iIndex / (level.iBricks[0] * level.iBricks[1]));
+  }
+}
+
+const char* BrickLayoutName(BrickLayout eLayout)
+{
+  switch (eLayout) {
+    case LAYOUT_SCANLINE: return "scanline";
+    case LAYOUT_MORTON:   return "morton";
+    case LAYOUT_HILBERT:  return "hilbert";
+    case LAYOUT_RANDOM:   return "random";
+    default:              return "";
+  }
+}
+
+BrickGrid::BrickGrid(const uint64_t iSize[3], uint64_t iBrickSize,
+                     uint64_t iBrickOverlap, uint64_t iVoxelBytes) :
+  iInner(iBrickSize > 2*iBrickOverlap ? iBrickSize - 2*iBrickOverlap : 1),
+  iOverlap(iBrickOverlap),
+  iBytesPerVoxel(iVoxelBytes)
+{
+  Level level;
+  for (int i = 0;i<3;i++) level.iSize[i] = std::max<uint64_t>(iSize[i], 1);
+  for (;;) {
+    for (int i = 0;i<3;i++) {
+      level.iBricks[i] = (level.iSize[i] + iInner - 1) / iInner;
+    }
+    vLevels.push_back(level);
+    if (level.iBricks[0] * level.iBricks[1] * level.iBricks[2] == 1) break;
+    for (int i = 0;i<3;i++) level.iSize[i] = (level.iSize[i] + 1) / 2;
+  }
+}
+
+uint64_t BrickGrid::BrickCount(size_t iLOD) const
+{
+  const Level& level = vLevels[iLOD];
+  return level.iBricks[0] * level.iBricks[1] * level.iBricks[2];
+}
+
+uint64_t BrickGrid::BrickIndex(size_t iLOD, const uint32_t iBrick[3]) const
+{
+  const Level& level = vLevels[iLOD];
+  return (uint64_t(iBrick[2]) * level.iBricks[1] + iBrick[1]) *
+         level.iBricks[0] + iBrick[0];
+}
+
+uint64_t BrickGrid::BrickBytes(size_t iLOD, const uint32_t iBrick[3]) const
+{
+  const Level& level = vLevels[iLOD];
+  uint64_t iBytes = iBytesPerVoxel;
+  for (int i = 0;i<3;i++) {
+    iBytes *= std::min(iInner, level.iSize[i] - iBrick[i]*iInner) + 2*iOverlap;
+  }
+  return iBytes;
+}
+
+bool BrickGrid::Contains(size_t iLOD, const uint32_t iBrick[3]) const
+{
+  if (iLOD >= vLevels.size()) return false;
+  const Level& level = vLevels[iLOD];
+  return iBrick[0] < level.iBricks[0] && iBrick[1] < level.iBricks[1] &&
+         iBrick[2] < level.iBricks[2];
+}
+
+bool LoadBrickTrace(const std::string& strFile, BrickTrace& trace)
+{
+  std::ifstream in(strFile.c_str());
+  if (!in.is_open()) return false;
+  trace.clear();
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t iFirst = line.find_first_not_of(" \t\r");
+    if (iFirst == std::string::npos || line[iFirst] == '#') continue;
+    std::istringstream fields(line);
+    BrickAccess access;
+    if (!(fields >> access.iLOD >> access.iBrick[0] >> access.iBrick[1]
+                 >> access.iBrick[2])) {
+      return false;
+    }
+    trace.push_back(access);
+  }
+  return !in.bad();
+}
+
+bool SaveBrickTrace(const std::string& strFile, const BrickTrace& trace)
+{
+  std::ofstream out(strFile.c_str());
+  out << "# lod x y z\n";
+  for (auto a = trace.cbegin(); a != trace.cend(); ++a) {
+    out << a->iLOD << " " << a->iBrick[0] << " " << a->iBrick[1] << " "
+        << a->iBrick[2] << "\n";
+  }
+  out.close();
+  return !out.fail();
+}
+
+void TraceExtent(const BrickTrace& trace, uint64_t iBrickSize,
+                 uint64_t iOverlap, uint64_t iSize[3])
+{
+  const uint64_t iInner = iBrickSize > 2*iOverlap ? iBrickSize - 2*iOverlap : 1;
+  for (int i = 0;i<3;i++) iSize[i] = 1;
+  for (auto a = trace.cbegin(); a != trace.cend(); ++a) {
+    for (int i = 0;i<3;i++) {
+      iSize[i] = std::max(iSize[i],
+                          (uint64_t(a->iBrick[i]) + 1) * iInner << a->iLOD);
+    }
+  }
+}
+
+BrickTrace ViewerTrace(const BrickGrid& grid, size_t iViews, uint32_t iSeed)
+{
+  std::mt19937 rng(iSeed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  const BrickGrid::Level& full = grid.vLevels[0];
+  double fCenter[3], fDiagonal = 0.0;
+  for (int i = 0;i<3;i++) {
+    fCenter[i] = full.iSize[i] * 0.5;
+    fDiagonal += double(full.iSize[i]) * double(full.iSize[i]);
+  }
+  fDiagonal = std::sqrt(fDiagonal);
+
+  BrickTrace trace;
+  std::vector<std::pair<double, BrickAccess>> visible;
+  for (size_t v = 0;v<iViews;v++) {
+    const double fAzimuth = 2.0 * 3.14159265358979 * double(v) / double(iViews);
+    const double fElevation = unit(rng) - 0.5;
+    const double fEye[3] = {
+      fCenter[0] + 2.0 * fDiagonal * std::cos(fElevation) * std::cos(fAzimuth),
+      fCenter[1] + 2.0 * fDiagonal * std::cos(fElevation) * std::sin(fAzimuth),
+      fCenter[2] + 2.0 * fDiagonal * std::sin(fElevation)
+    };
+    double fFocus[3];
+    for (int i = 0;i<3;i++) {
+      fFocus[i] = full.iSize[i] * (0.25 + 0.5 * unit(rng));
+    }
+
+    // coarsest first; the coarsest LOD is seen whole, every finer one
+    // around half the distance to the point of interest
+    double fRadius = fDiagonal;
+    for (size_t iLOD = grid.LODCount();iLOD-- > 0;) {
+      const double fBrick = double(grid.iInner << iLOD);
+      fRadius = std::max(fRadius, fBrick);
+      visible.clear();
+      for (uint64_t b = 0;b<grid.BrickCount(iLOD);b++) {
+        BrickAccess access;
+        access.iLOD = uint32_t(iLOD);
+        BrickCoords(grid.vLevels[iLOD], b, access.iBrick);
+        double fFocusDist = 0.0, fEyeDist = 0.0;
+        for (int i = 0;i<3;i++) {
+          const double c = std::min((access.iBrick[i] + 0.5) * fBrick,
+                                    double(full.iSize[i]));
+          fFocusDist += (c - fFocus[i]) * (c - fFocus[i]);
+          fEyeDist += (c - fEye[i]) * (c - fEye[i]);
+        }
+        if (std::sqrt(fFocusDist) <= fRadius) {
+          visible.push_back(std::make_pair(fEyeDist, access));
+        }
+      }
+      std::stable_sort(visible.begin(), visible.end(),
+        [](const std::pair<double, BrickAccess>& a,
+           const std::pair<double, BrickAccess>& b) {
+          return a.first < b.first;
+        });
+      for (size_t i = 0;i<visible.size();i++) {
+        trace.push_back(visible[i].second);
+      }
+      fRadius *= 0.5;
+    }
+  }
+  return trace;
+}
+
+std::vector<std::vector<uint64_t>> BrickOffsets(const BrickGrid& grid,
+                                                BrickLayout eLayout)
+{
+  std::vector<std::vector<uint64_t>> vOffsets(grid.LODCount());
+  std::mt19937 rng(0);
+  uint64_t iOffset = 0;
+  for (size_t iLOD = 0;iLOD<grid.LODCount();iLOD++) {
+    const BrickGrid::Level& level = grid.vLevels[iLOD];
+    const uint64_t iCount = grid.BrickCount(iLOD);
+    uint64_t iMaxBricks = std::max(level.iBricks[0],
+                                   std::max(level.iBricks[1], level.iBricks[2]));
+    unsigned iBits = 1;
+    while ((uint64_t(1) << iBits) < iMaxBricks) iBits++;
+
+    std::vector<uint64_t> vOrder(iCount);
+    std::iota(vOrder.begin(), vOrder.end(), uint64_t(0));
+    if (eLayout == LAYOUT_RANDOM) {
+      std::shuffle(vOrder.begin(), vOrder.end(), rng);
+    } else if (eLayout != LAYOUT_SCANLINE) {
+      std::vector<uint64_t> vKeys(iCount);
+      uint32_t iBrick[3];
+      for (uint64_t b = 0;b<iCount;b++) {
+        BrickCoords(level, b, iBrick);
+        vKeys[b] = eLayout == LAYOUT_MORTON ? MortonKey(iBrick)
+                                            : HilbertKey(iBrick, iBits);
+      }
+      std::sort(vOrder.begin(), vOrder.end(),
+                [&](uint64_t a, uint64_t b) {return vKeys[a] < vKeys[b];});
+    }
+
+    vOffsets[iLOD].resize(iCount);
+    uint32_t iBrick[3];
+    for (uint64_t i = 0;i<iCount;i++) {
+      BrickCoords(level, vOrder[i], iBrick);
+      vOffsets[iLOD][vOrder[i]] = iOffset;
+      iOffset += grid.BrickBytes(iLOD, iBrick);
+    }
+  }
+  return vOffsets;
+}
+
+LayoutCost ReplayTrace(const BrickGrid& grid,
+                       const std::vector<std::vector<uint64_t>>& vOffsets,
+                       const BrickTrace& trace, const ReadCostModel& model)
+{
+  LayoutCost cost = {0.0, 0, 0, 0};
+  std::vector<std::vector<char>> vCached(grid.LODCount());
+  for (size_t i = 0;i<vCached.size();i++) {
+    vCached[i].resize(size_t(grid.BrickCount(i)), 0);
+  }
+
+  uint64_t iEnd = 0;
+  bool bFirst = true;
+  for (auto a = trace.cbegin(); a != trace.cend(); ++a) {
+    if (!grid.Contains(a->iLOD, a->iBrick)) continue;
+    const uint64_t iIndex = grid.BrickIndex(a->iLOD, a->iBrick);
+    if (vCached[a->iLOD][size_t(iIndex)]) continue;
+    vCached[a->iLOD][size_t(iIndex)] = 1;
+
+    const uint64_t iOffset = vOffsets[a->iLOD][size_t(iIndex)];
+    const uint64_t iBytes = grid.BrickBytes(a->iLOD, a->iBrick);
+    cost.iReads++;
+    if (!bFirst && iOffset >= iEnd && iOffset - iEnd <= model.iReadahead) {
+      cost.iBytes += iOffset + iBytes - iEnd;
+    } else {
+      cost.iSeeks++;
+      cost.iBytes += iBytes;
+    }
+    iEnd = iOffset + iBytes;
+    bFirst = false;
+  }
+  cost.fSeconds = double(cost.iSeeks) * model.fSeekSeconds +
+                  double(cost.iBytes) / model.fBytesPerSecond;
+  return cost;
+}
+
+BrickLayout ChooseBrickLayout(const BrickGrid& grid, const BrickTrace& trace,
+                              const ReadCostModel& model,
+                              std::vector<LayoutCost>* pCosts)
+{
+  BrickLayout eBest = LAYOUT_SCANLINE;
+  std::vector<LayoutCost> vCosts;
+  for (int i = 0;i<LAYOUT_COUNT;i++) {
+    vCosts.push_back(ReplayTrace(grid, BrickOffsets(grid, BrickLayout(i)),
+                                 trace, model));
+    if (vCosts[i].fSeconds < vCosts[eBest].fSeconds) eBest = BrickLayout(i);
+  }
+  if (pCosts) *pCosts = vCosts;
+  return eBest;
+}
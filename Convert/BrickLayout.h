@@ -0,0 +1,141 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    BrickLayout.h
+  \brief   Models the on-disk brick orders Tuvok offers and picks the one
+           that serves a brick access trace with the fewest seeks.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef BRICKLAYOUT_H
+#define BRICKLAYOUT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// The orders of --bricklayout, in its numbering.
+enum BrickLayout {
+  LAYOUT_SCANLINE,
+  LAYOUT_MORTON,
+  LAYOUT_HILBERT,
+  LAYOUT_RANDOM,
+  LAYOUT_COUNT
+};
+
+const char* BrickLayoutName(BrickLayout eLayout);
+
+/// The bricks of a volume: per LOD, LOD 0 at full resolution, bricks of up
+/// to iBrickSize voxels that include iBrickOverlap voxels on every side.  Each
+/// coarser LOD halves the size until a single brick holds it.
+struct BrickGrid {
+  BrickGrid(const uint64_t iSize[3], uint64_t iBrickSize,
+            uint64_t iBrickOverlap, uint64_t iVoxelBytes);
+
+  size_t   LODCount() const {return vLevels.size();}
+  uint64_t BrickCount(size_t iLOD) const;
+  /// x fastest index of a brick within its LOD.
+  uint64_t BrickIndex(size_t iLOD, const uint32_t iBrick[3]) const;
+  uint64_t BrickBytes(size_t iLOD, const uint32_t iBrick[3]) const;
+  bool Contains(size_t iLOD, const uint32_t iBrick[3]) const;
+
+  struct Level {
+    uint64_t iSize[3];
+    uint64_t iBricks[3];
+  };
+  std::vector<Level> vLevels;
+  uint64_t iInner;
+  uint64_t iOverlap;
+  uint64_t iBytesPerVoxel;
+};
+
+struct BrickAccess {
+  uint32_t iLOD;
+  uint32_t iBrick[3];
+};
+typedef std::vector<BrickAccess> BrickTrace;
+
+/// Reads a trace with one "lod x y z" line per brick request, brick
+/// coordinates counted within the LOD.  Empty lines and lines starting
+/// with # are skipped.
+bool LoadBrickTrace(const std::string& strFile, BrickTrace& trace);
+bool SaveBrickTrace(const std::string& strFile, const BrickTrace& trace);
+
+/// Smallest full resolution size whose grid holds every brick of trace.
+void TraceExtent(const BrickTrace& trace, uint64_t iBrickSize,
+                 uint64_t iOverlap, uint64_t iSize[3]);
+
+/// Requests of a renderer orbiting the volume in iViews steps.  Each view
+/// refines from the coarsest LOD down, every finer LOD around a smaller
+/// neighbourhood of a point of interest, front to back from the camera.
+BrickTrace ViewerTrace(const BrickGrid& grid, size_t iViews,
+                       uint32_t iSeed = 1);
+
+/// File offset of every brick, [LOD][BrickIndex()], with the LODs stored
+/// finest first and the bricks of each LOD in eLayout order.  The random
+/// order is a fixed shuffle, Tuvok's own one differs but behaves alike.
+std::vector<std::vector<uint64_t>> BrickOffsets(const BrickGrid& grid,
+                                                BrickLayout eLayout);
+
+/// Cold cache reads: a request within iReadahead bytes after the end of
+/// the previous one streams on, anything else costs a seek.  Bricks read
+/// once stay cached.  The defaults describe a striped disk array; only the
+/// ranking of the layouts matters.
+struct ReadCostModel {
+  ReadCostModel() :
+    fSeekSeconds(0.0005),
+    fBytesPerSecond(1e9),
+    iReadahead(uint64_t(1) << 20)
+  {}
+
+  double   fSeekSeconds;
+  double   fBytesPerSecond;
+  uint64_t iReadahead;
+};
+
+struct LayoutCost {
+  double   fSeconds;
+  uint64_t iReads;
+  uint64_t iSeeks;
+  uint64_t iBytes;   ///< including gaps streamed over
+};
+
+LayoutCost ReplayTrace(const BrickGrid& grid,
+                       const std::vector<std::vector<uint64_t>>& vOffsets,
+                       const BrickTrace& trace, const ReadCostModel& model);
+
+/// The layout with the cheapest replay of trace; pCosts receives the cost
+/// of every layout.
+BrickLayout ChooseBrickLayout(const BrickGrid& grid, const BrickTrace& trace,
+                              const ReadCostModel& model,
+                              std::vector<LayoutCost>* pCosts = NULL);
+
+#endif // BRICKLAYOUT_H
@@ -0,0 +1,290 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    BrickedExpression.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "BrickedExpression.h"
+#include "Quantizer.h"
+#include "RawStaging.h"
+#include "UVFBricks.h"
+#include "VoxelType.h"
+#include "../DebugOut/ProfileOut.h"
+#include "../Expr/CompiledExpression.h"
+#include "../Expr/Expression.h"
+#include "../Util/Journal.h"
+#include "../Util/MemoryGovernor.h"
+#include "../Util/WorkerPool.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <IO/IOManager.h>
+#include <IO/uvfDataset.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+namespace {
+  bool SameBricking(const UVFDataset& a, const UVFDataset& b)
+  {
+    const UINT64VECTOR3 da = a.GetDomainSize(0, 0), db = b.GetDomainSize(0, 0);
+    const UINTVECTOR3 la = a.GetBrickLayout(0, 0), lb = b.GetBrickLayout(0, 0);
+    const UINTVECTOR3 ma = a.GetMaxBrickSize(), mb = b.GetMaxBrickSize();
+    const UINTVECTOR3 oa = a.GetBrickOverlapSize(), ob = b.GetBrickOverlapSize();
+    return da.x == db.x && da.y == db.y && da.z == db.z &&
+           la.x == lb.x && la.y == lb.y && la.z == lb.z &&
+           ma.x == mb.x && ma.y == mb.y && ma.z == mb.z &&
+           oa.x == ob.x && oa.y == ob.y && oa.z == ob.z;
+  }
+}
+
+bool CanEvaluateBricked(const IOManager& ioMan,
+                        const std::vector<std::string>& vInputs)
+{
+  std::vector<std::unique_ptr<Dataset>> ds(vInputs.size());
+  for (size_t i = 0;i<vInputs.size();i++) {
+    std::vector<std::unique_ptr<Dataset>> one;
+    if (!OpenUVFPerWorker(ioMan, vInputs[i], 1, one)) return false;
+    ds[i] = std::move(one[0]);
+    if (ds[i]->GetComponentCount() != 1 ||
+        GetVoxelType(RawVolumeInfo(*ds[i])) == VT_UNSUPPORTED) {
+      return false;
+    }
+    if (i > 0 && !SameBricking(dynamic_cast<const UVFDataset&>(*ds[0]),
+                               dynamic_cast<const UVFDataset&>(*ds[i]))) {
+      return false;
+    }
+  }
+  return !ds.empty();
+}
+
+bool EvaluateExpressionBricked(const IOManager& ioMan,
+                               const Expression& expr,
+                               const std::vector<std::string>& vInputs,
+                               const std::string& strTarget,
+                               const std::string& strTempDir,
+                               uint64_t iBrickSize, uint64_t iBrickOverlap,
+                               size_t iWorkers, unsigned iQuantizeBits,
+                               Journal* pJournal)
+{
+  if (expr.GetVolumeCount() > vInputs.size()) {
+    T_ERROR("Expression uses v[%u] but only %u volumes were given",
+            unsigned(expr.GetVolumeCount()-1), unsigned(vInputs.size()));
+    return false;
+  }
+
+  // sources[input][worker]
+  WorkerPool pool(iWorkers);
+  std::vector<std::vector<std::unique_ptr<Dataset>>> sources(vInputs.size());
+  std::vector<VoxelType> types(vInputs.size());
+  for (size_t i = 0;i<vInputs.size();i++) {
+    if (!OpenUVFPerWorker(ioMan, vInputs[i], pool.GetWorkerCount(),
+                          sources[i])) {
+      return false;
+    }
+    types[i] = GetVoxelType(RawVolumeInfo(*sources[i][0]));
+  }
+
+  const UVFDataset& first = dynamic_cast<const UVFDataset&>(*sources[0][0]);
+  const RawVolumeInfo info(first);
+  const VoxelType outType = types[0];
+  const size_t iBricks = first.GetBrickCount(0, 0);
+  const std::string strRaw = StagingFilename(strTarget, strTempDir, !pJournal);
+  const uint64_t iStaged = StagedBoxes(pJournal, strRaw);
+  const CompiledExpression kernel(expr, types, outType);
+  MESSAGE("Evaluating expression in %s precision (%s)",
+          kernel.IsSinglePrecision() ? "single" : "double",
+          CompiledExpression::GetInstructionSet());
+  const bool bQuantize = iQuantizeBits != 0 &&
+                         Quantizer::IsUseful(info, iQuantizeBits);
+  if (iQuantizeBits != 0 && !bQuantize) {
+    WARNING("Result already fits %u bits, it is not quantized",
+            iQuantizeBits);
+  }
+  double fMin = 0.0;
+  double fMax = 0.0;
+  bool bRange = false;
+
+  // every worker holds one brick per input and the result box; when the
+  // memory budget is tight fewer of them run
+  const UINTVECTOR3 maxBrick = first.GetMaxBrickSize();
+  const uint64_t iBrickVoxels = uint64_t(maxBrick.x) * maxBrick.y * maxBrick.z;
+  uint64_t iPerWorker = iBrickVoxels * GetVoxelTypeSize(outType);
+  for (size_t i = 0;i<types.size();i++) {
+    iPerWorker += iBrickVoxels * GetVoxelTypeSize(types[i]);
+  }
+  {
+    const MemoryReservation memory(iPerWorker * pool.GetWorkerCount(), iPerWorker);
+    const WorkerPool workers(size_t(memory.GetBytes() / iPerWorker));
+    if (workers.GetWorkerCount() < pool.GetWorkerCount()) {
+      MESSAGE("Memory budget limits the expression to %u of %u workers",
+              unsigned(workers.GetWorkerCount()), unsigned(pool.GetWorkerCount()));
+      for (size_t i = 0;i<sources.size();i++) {
+        sources[i].resize(workers.GetWorkerCount());
+      }
+    }
+    ProfileScope stage("EvaluateBricks");
+    RawStagingFile raw(strRaw, info, iStaged);
+    if (!raw.IsOpen()) return false;
+    JournalStaging(pJournal, raw);
+    if (bQuantize) raw.TrackRange();
+
+    // per worker scratch: one brick per input, the row pointers handed to
+    // the kernel, its register file and the result box
+    struct Scratch {
+      std::vector<std::vector<uint8_t>> bricks;
+      std::vector<const uint8_t*> rows;
+      std::vector<uint8_t> registers;
+      std::vector<uint8_t> box;
+    };
+    std::vector<Scratch> scratch(workers.GetWorkerCount());
+    for (size_t w = 0;w<scratch.size();w++) {
+      scratch[w].bricks.resize(vInputs.size());
+      scratch[w].rows.resize(vInputs.size());
+    }
+
+    std::atomic<bool> bOk(true);
+    std::atomic<size_t> iDone(static_cast<size_t>(iStaged));
+    workers.Run(iBricks - std::min<size_t>(iBricks, size_t(iStaged)),
+             [&](size_t iTask, size_t worker) {
+      if (!bOk) return;
+      const size_t iBrick = size_t(iStaged) + iTask;
+      Scratch& s = scratch[worker];
+      const BrickInterior bi = GetBrickInterior(
+        dynamic_cast<const UVFDataset&>(*sources[0][worker]), 0, iBrick);
+
+      for (size_t iInput = 0;iInput<vInputs.size();iInput++) {
+        if (!sources[iInput][worker]->GetBrick(BrickKey(0, 0, iBrick),
+                                               s.bricks[iInput])) {
+          T_ERROR("Could not read brick %u of '%s'", unsigned(iBrick),
+                  vInputs[iInput].c_str());
+          bOk = false;
+          raw.Abort();
+          return;
+        }
+      }
+      const size_t iOutRow = size_t(bi.iSize[0]) * GetVoxelTypeSize(outType);
+      s.box.resize(size_t(bi.InteriorCount()) * GetVoxelTypeSize(outType));
+
+      uint8_t* out = &s.box[0];
+      for (uint64_t z = 0;z<bi.iSize[2];z++) {
+        for (uint64_t y = 0;y<bi.iSize[1];y++) {
+          const uint64_t iStart = bi.BrickIndex(0, y, z);
+          for (size_t iInput = 0;iInput<vInputs.size();iInput++) {
+            s.rows[iInput] = &s.bricks[iInput][size_t(
+              iStart * GetVoxelTypeSize(types[iInput]))];
+          }
+          kernel.Evaluate(&s.rows[0], size_t(bi.iSize[0]), out, s.registers);
+          out += iOutRow;
+        }
+      }
+
+      if (!raw.WriteBox(iBrick, bi.iOrigin, bi.iSize, &s.box[0])) {
+        bOk = false;
+        return;
+      }
+      MESSAGE("Evaluated brick %u of %u", unsigned(++iDone), unsigned(iBricks));
+    });
+
+    if (!raw.Close() || !bOk) {
+      // a journaled staging file is kept for the next attempt
+      if (!pJournal) std::remove(strRaw.c_str());
+      return false;
+    }
+    JournalStagingDone(pJournal, iBricks);
+    stage.SetBytes(info.Bytes() * vInputs.size(), info.Bytes());
+    bRange = bQuantize && raw.GetRange(fMin, fMax);
+  }
+  sources.clear();
+
+  // the staged result is quantized into a second staging file; a resumed
+  // run did not see the boxes staged before, so it scans for the range
+  std::string strBuild = strRaw;
+  RawVolumeInfo target = info;
+  if (bQuantize) {
+    if (!bRange && !ScanRawRange(strRaw, 0, false, info,
+                                 pool.GetWorkerCount(), fMin, fMax)) {
+      return false;
+    }
+    MESSAGE("Quantizing [%g, %g] to %u bits", fMin, fMax, iQuantizeBits);
+    const Quantizer quantizer(info, fMin, fMax, iQuantizeBits);
+    strBuild = StagingFilename(strTarget, strTempDir);
+    if (!QuantizeRaw(strRaw, 0, false, info, quantizer, strBuild,
+                     pool.GetWorkerCount())) {
+      return false;
+    }
+    std::remove(strRaw.c_str());
+    target = quantizer.GetTargetInfo();
+  }
+
+  if (!BuildUVFFromRaw(ioMan, strBuild, target, strTarget, strTempDir,
+                       iBrickSize, iBrickOverlap,
+                       pJournal != NULL && !bQuantize)) {
+    return false;
+  }
+  if (pJournal) pJournal->Remove();
+  return true;
+}
+
+std::string MergeExpression(const std::vector<double>& vScales,
+                            const std::vector<double>& vBiases,
+                            bool bUseMaxMode)
+{
+  std::ostringstream expr;
+  expr.precision(17);
+  for (size_t i = 0;i<vScales.size();i++) {
+    std::ostringstream term;
+    term.precision(17);
+    term << "v[" << i << "]*(" << vScales[i] << ")+(" << vBiases[i] << ")";
+    if (i == 0) {
+      expr << term.str();
+    } else if (bUseMaxMode) {
+      const std::string strSoFar = expr.str();
+      expr.str("");
+      expr << "max(" << strSoFar << ", " << term.str() << ")";
+    } else {
+      expr << " + " << term.str();
+    }
+  }
+  return expr.str();
+}
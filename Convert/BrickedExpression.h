@@ -0,0 +1,81 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    BrickedExpression.h
+  \brief   Evaluates a merge expression brick by brick over UVF inputs.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef BRICKEDEXPRESSION_H
+#define BRICKEDEXPRESSION_H
+
+#include <string>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+class Expression;
+class Journal;
+
+namespace tuvok {
+  class IOManager;
+}
+
+/// True if every input is a scalar UVF and all of them share one LOD 0
+/// bricking, which is what EvaluateExpressionBricked needs.
+bool CanEvaluateBricked(const tuvok::IOManager& ioMan,
+                        const std::vector<std::string>& vInputs);
+
+/// Evaluates expr over the LOD 0 bricks of vInputs on iWorkers threads.
+/// Each worker reads one brick of every input at a time and writes the
+/// interior of the result to a staging raw file as soon as it is done, so
+/// memory stays at a few bricks per worker whatever the volume size.  The
+/// result has the voxel type of the first input and is bricked into
+/// strTarget afterwards.  With iQuantizeBits the value range is gathered
+/// while staging and the staged result is quantized before bricking.  A
+/// journal makes the run resumable the same way it does for ReBrickUVF.
+bool EvaluateExpressionBricked(const tuvok::IOManager& ioMan,
+                               const Expression& expr,
+                               const std::vector<std::string>& vInputs,
+                               const std::string& strTarget,
+                               const std::string& strTempDir,
+                               uint64_t iBrickSize, uint64_t iBrickOverlap,
+                               size_t iWorkers, unsigned iQuantizeBits = 0,
+                               Journal* pJournal = NULL);
+
+/// Expression computing what MergeDatasets produces: every input scaled and
+/// biased, then combined by max or by sum, e.g.
+/// "max(v[0]*1+0, v[1]*0.5+10)".
+std::string MergeExpression(const std::vector<double>& vScales,
+                            const std::vector<double>& vBiases,
+                            bool bUseMaxMode);
+
+#endif // BRICKEDEXPRESSION_H
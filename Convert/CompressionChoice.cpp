@@ -0,0 +1,198 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    CompressionChoice.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include "CompressionChoice.h"
+#include "RawStaging.h"
+#include "../Util/ProcessStats.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <IO/IOManager.h>
+#include <IO/uvfDataset.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+namespace {
+  const uint64_t BLOCK_SIZE = 64*1024;
+
+  class Sampler {
+    public:
+      Sampler() : m_iBlocks(0), m_iConstant(0) {
+        for (int i = 0;i<256;i++) m_iHistogram[i] = 0;
+      }
+
+      void Add(const uint8_t* pData, size_t iSize) {
+        if (iSize == 0) return;
+        for (size_t i = 0;i<iSize;i++) m_iHistogram[pData[i]]++;
+        m_iBlocks++;
+        // one value of up to 8 bytes repeated throughout
+        for (size_t iPeriod = 1;iPeriod<=8;iPeriod*=2) {
+          if (iSize > iPeriod &&
+              memcmp(pData, pData+iPeriod, iSize-iPeriod) == 0) {
+            m_iConstant++;
+            break;
+          }
+        }
+      }
+
+      DataSample Result() const {
+        DataSample s;
+        for (int i = 0;i<256;i++) s.iBytes += m_iHistogram[i];
+        for (int i = 0;i<256 && s.iBytes;i++) {
+          if (m_iHistogram[i] == 0) continue;
+          const double p = double(m_iHistogram[i]) / double(s.iBytes);
+          s.fEntropy -= p * std::log(p) / std::log(2.0);
+        }
+        s.iBlocks = m_iBlocks;
+        s.fConstant = m_iBlocks ? double(m_iConstant) / double(m_iBlocks) : 0.0;
+        return s;
+      }
+
+    private:
+      uint64_t m_iHistogram[256];
+      uint64_t m_iBlocks;
+      uint64_t m_iConstant;
+  };
+}
+
+DataSample SampleFiles(const std::vector<std::string>& vFiles, size_t iBlocks)
+{
+  uint64_t iTotal = 0;
+  for (auto f = vFiles.cbegin(); f != vFiles.cend(); ++f) {
+    iTotal += ProcessStats::FileSize(*f);
+  }
+  Sampler sampler;
+  if (iTotal == 0 || iBlocks == 0) return sampler.Result();
+
+  // evenly spaced positions over the concatenation of all files
+  const uint64_t iStride = std::max<uint64_t>(iTotal / iBlocks, BLOCK_SIZE);
+  std::vector<uint8_t> block(static_cast<size_t>(BLOCK_SIZE));
+  uint64_t iFileStart = 0;
+  uint64_t iNext = 0;
+  for (auto f = vFiles.cbegin(); f != vFiles.cend(); ++f) {
+    const uint64_t iSize = ProcessStats::FileSize(*f);
+    if (iNext < iFileStart + iSize) {
+      std::ifstream in(f->c_str(), std::ios::binary);
+      while (in && iNext < iFileStart + iSize) {
+        in.seekg(std::streamoff(iNext - iFileStart));
+        in.read(reinterpret_cast<char*>(&block[0]), std::streamsize(BLOCK_SIZE));
+        sampler.Add(&block[0], size_t(in.gcount()));
+        iNext += iStride;
+      }
+    }
+    iFileStart += iSize;
+  }
+  return sampler.Result();
+}
+
+DataSample SampleRawFile(const std::string& strRawFile, uint64_t iHeaderSkip,
+                         const RawVolumeInfo& info, size_t iBlocks)
+{
+  // the byte order does not change byte statistics, so no swapping
+  Sampler sampler;
+  const uint64_t iTotal = info.Bytes();
+  if (iBlocks != 0) {
+    const uint64_t iStride = std::max<uint64_t>(iTotal / iBlocks, BLOCK_SIZE);
+    std::vector<uint8_t> block(static_cast<size_t>(BLOCK_SIZE));
+    std::ifstream in(strRawFile.c_str(), std::ios::binary);
+    for (uint64_t iPos = 0;in && iPos<iTotal;iPos+=iStride) {
+      in.seekg(std::streamoff(iHeaderSkip + iPos));
+      in.read(reinterpret_cast<char*>(&block[0]),
+              std::streamsize(std::min(BLOCK_SIZE, iTotal - iPos)));
+      sampler.Add(&block[0], size_t(in.gcount()));
+    }
+  }
+  DataSample sample = sampler.Result();
+  sample.bDecoded = true;
+  return sample;
+}
+
+DataSample SampleUVF(const IOManager& ioMan, const std::string& strFile,
+                     size_t iBricks)
+{
+  Sampler sampler;
+  std::unique_ptr<Dataset> ds(ioMan.CreateDataset(strFile, 256, false));
+  if (!ds || iBricks == 0) return sampler.Result();
+
+  const size_t iCount = ds->GetBrickCount(0, 0);
+  const size_t iStride = std::max<size_t>(iCount / iBricks, 1);
+  std::vector<uint8_t> brick;
+  for (size_t i = 0;i<iCount;i+=iStride) {
+    if (ds->GetBrick(BrickKey(0, 0, i), brick) && !brick.empty()) {
+      sampler.Add(&brick[0], brick.size());
+    }
+  }
+  DataSample sample = sampler.Result();
+  sample.bDecoded = true;
+  return sample;
+}
+
+uint32_t ChooseCompression(const DataSample& sample)
+{
+  if (sample.iBytes == 0) return 1;
+  // close to random bytes: compressing voxels like that costs time and
+  // gains nothing, but stored bytes may just be compressed by the format
+  if (sample.fEntropy > 7.5 && sample.fConstant < 0.1) {
+    return sample.bDecoded ? 0 : 1;
+  }
+  // mostly empty background: lz4 squeezes runs nearly as well as zlib at a
+  // fraction of the time to write and to read back
+  if (sample.fConstant > 0.5 || sample.fEntropy < 2.0) return 3;
+  return 1;
+}
+
+const char* CompressionName(uint32_t iCompression)
+{
+  switch (iCompression) {
+    case 0: return "none";
+    case 1: return "zlib";
+    case 2: return "lzma";
+    case 3: return "lz4";
+    case 4: return "bzlib";
+    case 5: return "lzham";
+    default: return "unknown";
+  }
+}
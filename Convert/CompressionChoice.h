@@ -0,0 +1,90 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    CompressionChoice.h
+  \brief   Picks a UVF compression method for a dataset from a sample of
+           its data.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef COMPRESSIONCHOICE_H
+#define COMPRESSIONCHOICE_H
+
+#include <string>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+namespace tuvok {
+  class IOManager;
+}
+struct RawVolumeInfo;
+
+/// Byte statistics of a sample of a dataset.
+struct DataSample {
+  DataSample() : iBytes(0), iBlocks(0), fEntropy(0.0), fConstant(0.0),
+    bDecoded(false) {}
+
+  uint64_t iBytes;
+  uint64_t iBlocks;
+  double   fEntropy;   ///< order 0 entropy in bits per byte, 0..8
+  double   fConstant;  ///< share of sampled blocks that repeat one value
+  bool     bDecoded;   ///< sampled voxels, not bytes as a format stores them
+};
+
+/// Samples iBlocks evenly spaced 64 kB blocks spread over the files.  This
+/// sees the bytes as stored, which for compressed formats such as gzip
+/// NRRD or deflate TIFF look like noise whatever the voxels are.
+DataSample SampleFiles(const std::vector<std::string>& vFiles,
+                       size_t iBlocks = 64);
+
+/// Samples iBlocks evenly spaced 64 kB blocks of the voxels of a raw
+/// volume that starts iHeaderSkip bytes into strRawFile, as StageRawSource
+/// finds or writes it.  Stage a source only if the conversion goes on from
+/// the staged copy; decoding it just for a sample costs a full pass.
+DataSample SampleRawFile(const std::string& strRawFile, uint64_t iHeaderSkip,
+                         const RawVolumeInfo& info, size_t iBlocks = 64);
+
+/// Samples up to iBricks evenly spaced LOD 0 bricks of a UVF; every brick
+/// is one block.
+DataSample SampleUVF(const tuvok::IOManager& ioMan, const std::string& strFile,
+                     size_t iBricks = 16);
+
+/// Compression method for IOManager::SetCompression: none for decoded
+/// voxels that look like noise, lz4 for mostly constant or very low
+/// entropy data, and zlib otherwise, including stored bytes that look like
+/// noise because the format compresses them.
+uint32_t ChooseCompression(const DataSample& sample);
+
+/// Name of a compression method, e.g. "lz4".
+const char* CompressionName(uint32_t iCompression);
+
+#endif // COMPRESSIONCHOICE_H
@@ -0,0 +1,303 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    MeshMerge.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+#include "MeshMerge.h"
+#include "MeshStream.h"
+#include "../DebugOut/ProfileOut.h"
+#include "../Util/WorkerPool.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <Basics/SysTools.h>
+#include <IO/IOManager.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+namespace {
+  /// Bit pattern of a position; -0 is folded onto 0 so both weld.
+  struct PositionKey {
+    uint32_t v[3];
+
+    explicit PositionKey(const float* p) {
+      for (int i = 0;i<3;i++) {
+        const float f = p[i] == 0.0f ? 0.0f : p[i];
+        memcpy(&v[i], &f, sizeof(f));
+      }
+    }
+    bool operator==(const PositionKey& o) const {
+      return v[0] == o.v[0] && v[1] == o.v[1] && v[2] == o.v[2];
+    }
+  };
+
+  struct PositionHash {
+    size_t operator()(const PositionKey& k) const {
+      uint64_t h = (uint64_t(k.v[0]) << 32 | k.v[1]) ^
+                   (uint64_t(k.v[2]) * 0x9E3779B97F4A7C15ULL);
+      // splitmix64 finalizer
+      h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ULL;
+      h ^= h >> 27; h *= 0x94D049BB133111EBULL;
+      h ^= h >> 31;
+      return size_t(h);
+    }
+  };
+
+  /// Assigns one id to every distinct position.  The table is split into
+  /// shards with a lock each, so several inputs can be welded at once.
+  /// Until Finish(), ids carry their shard in the top bits.
+  class VertexWelder {
+    public:
+      static const unsigned SHARD_BITS = 6;
+      static const unsigned LOCAL_BITS = 32 - SHARD_BITS;
+      static const size_t   SHARDS = size_t(1) << SHARD_BITS;
+
+      VertexWelder() : m_Shards(SHARDS) {}
+
+      /// Writes the welded ids of iCount positions to pIds.  Fails once a
+      /// shard holds 2^LOCAL_BITS vertices.
+      bool Weld(const float* pPositions, size_t iCount, uint32_t* pIds) {
+        // lock every shard once per call, not once per vertex
+        std::vector<std::vector<size_t>> buckets(SHARDS);
+        for (size_t i = 0;i<iCount;i++) {
+          const size_t h = PositionHash()(PositionKey(pPositions + 3*i));
+          buckets[h >> (sizeof(size_t)*8 - SHARD_BITS)].push_back(i);
+        }
+        for (size_t s = 0;s<SHARDS;s++) {
+          if (buckets[s].empty()) continue;
+          Shard& shard = m_Shards[s];
+          std::lock_guard<std::mutex> lock(shard.guard);
+          for (auto i = buckets[s].cbegin(); i != buckets[s].cend(); ++i) {
+            const float* p = pPositions + 3*(*i);
+            const uint32_t iNext = uint32_t(shard.positions.size()/3);
+            auto entry = shard.ids.insert(std::make_pair(PositionKey(p), iNext));
+            if (entry.second) {
+              if (iNext >> LOCAL_BITS) {
+                T_ERROR("Too many distinct vertices to weld");
+                return false;
+              }
+              shard.positions.insert(shard.positions.end(), p, p+3);
+            }
+            pIds[*i] = uint32_t(s << LOCAL_BITS) | entry.first->second;
+          }
+        }
+        return true;
+      }
+
+      /// Drops the lookup tables and numbers the vertices shard by shard.
+      void Finish() {
+        uint32_t iOffset = 0;
+        for (size_t s = 0;s<SHARDS;s++) {
+          std::unordered_map<PositionKey, uint32_t, PositionHash>().swap(m_Shards[s].ids);
+          m_Offsets[s] = iOffset;
+          iOffset += uint32_t(m_Shards[s].positions.size()/3);
+        }
+        m_iCount = iOffset;
+      }
+
+      uint32_t GlobalId(uint32_t iId) const {
+        return m_Offsets[iId >> LOCAL_BITS] + (iId & ((1u << LOCAL_BITS) - 1));
+      }
+      uint32_t GetCount() const {return m_iCount;}
+      /// Positions of a shard, in id order after Finish().
+      const std::vector<float>& GetPositions(size_t iShard) const {
+        return m_Shards[iShard].positions;
+      }
+
+    private:
+      struct Shard {
+        std::mutex guard;
+        std::unordered_map<PositionKey, uint32_t, PositionHash> ids;
+        std::vector<float> positions;
+      };
+      std::vector<Shard> m_Shards;
+      uint32_t m_Offsets[SHARDS];
+      uint32_t m_iCount;
+  };
+}
+
+bool StreamMesh(const IOManager& ioMan, const std::string& strSource,
+                const std::string& strTarget, const std::string& strTempDir,
+                bool& bUnsupported)
+{
+  bUnsupported = false;
+  std::unique_ptr<MeshReader> reader = OpenMeshReader(ioMan, strSource, true);
+  if (!reader) return false;
+  std::unique_ptr<MeshWriter> writer = OpenMeshWriter(ioMan, strTarget,
+                                                      strTempDir);
+  if (!writer) return false;
+
+  MeshChunk chunk;
+  while (reader->Next(chunk)) {
+    writer->SetVerticesPerFace(reader->GetVerticesPerFace());
+    if (!writer->AddVertices(chunk.vPositions.data(), chunk.VertexCount()) ||
+        !writer->AddFaces(chunk.vIndices.data(), chunk.vIndices.size())) {
+      return false;
+    }
+  }
+  if (reader->Failed()) {
+    bUnsupported = reader->HasAttributes();
+    return false;
+  }
+  return writer->Close();
+}
+
+bool MergeMeshes(const IOManager& ioMan,
+                 const std::vector<std::string>& vInputs,
+                 const std::string& strTarget,
+                 const std::string& strTempDir,
+                 size_t iWorkers)
+{
+  const std::string strFaces = SysTools::FindNextSequenceName(
+    strTempDir + SysTools::GetFilename(SysTools::RemoveExt(strTarget)) +
+    "-faces.tmp");
+  std::ofstream faces(strFaces.c_str(), std::ios::binary | std::ios::trunc);
+  std::mutex facesGuard;
+  uint64_t iFaceIndices = 0;
+
+  VertexWelder welder;
+  std::vector<size_t> vVerticesPerFace(vInputs.size(), 0);
+  std::atomic<bool> bOk(faces.is_open());
+  std::atomic<bool> bAttributes(false);
+  {
+    ProfileScope stage("WeldMeshes");
+    const WorkerPool pool(iWorkers);
+    pool.Run(vInputs.size(), [&](size_t i, size_t) {
+      std::unique_ptr<MeshReader> reader = OpenMeshReader(ioMan, vInputs[i]);
+      if (!reader) {
+        bOk = false;
+        return;
+      }
+      // welded id of every vertex of this input read so far
+      std::vector<uint32_t> ids;
+      std::vector<uint32_t> welded;
+      MeshChunk chunk;
+      while (bOk && reader->Next(chunk)) {
+        const size_t iFirst = ids.size();
+        ids.resize(iFirst + chunk.VertexCount());
+        if (!welder.Weld(chunk.vPositions.data(), chunk.VertexCount(),
+                         ids.data() + iFirst)) {
+          bOk = false;
+          return;
+        }
+
+        const size_t n = reader->GetVerticesPerFace();
+        welded.clear();
+        for (size_t f = 0;n>0 && f+n<=chunk.vIndices.size();f += n) {
+          bool bDegenerate = false;
+          for (size_t c = 0;c<n;c++) {
+            if (chunk.vIndices[f+c] >= ids.size()) {
+              T_ERROR("'%s' refers to a vertex it has not defined yet",
+                      vInputs[i].c_str());
+              bOk = false;
+              return;
+            }
+            const uint32_t id = ids[chunk.vIndices[f+c]];
+            for (size_t d = 0;d<c;d++) {
+              bDegenerate |= welded[welded.size()-c+d] == id;
+            }
+            welded.push_back(id);
+          }
+          if (bDegenerate) welded.resize(welded.size()-n);
+        }
+
+        std::lock_guard<std::mutex> lock(facesGuard);
+        faces.write(reinterpret_cast<const char*>(welded.data()),
+                    std::streamsize(welded.size()*sizeof(uint32_t)));
+        iFaceIndices += welded.size();
+      }
+      if (reader->Failed()) bOk = false;
+      if (reader->HasAttributes()) bAttributes = true;
+      vVerticesPerFace[i] = reader->GetVerticesPerFace();
+      MESSAGE("Welded '%s'", vInputs[i].c_str());
+    });
+  }
+  faces.close();
+
+  size_t iVerticesPerFace = 0;
+  for (size_t i = 0;bOk && i<vVerticesPerFace.size();i++) {
+    if (vVerticesPerFace[i] == 0) continue;
+    if (iVerticesPerFace != 0 && iVerticesPerFace != vVerticesPerFace[i]) {
+      T_ERROR("Cannot merge line meshes with triangle meshes");
+      bOk = false;
+    }
+    iVerticesPerFace = vVerticesPerFace[i];
+  }
+  if (!bOk || faces.fail()) {
+    std::remove(strFaces.c_str());
+    return false;
+  }
+  if (bAttributes) {
+    WARNING("Normals, texture coordinates and colors are not merged");
+  }
+
+  ProfileScope stage("WriteMergedMesh");
+  welder.Finish();
+  MESSAGE("Merged mesh has %u vertices and %u faces", unsigned(welder.GetCount()),
+          unsigned(iVerticesPerFace ? iFaceIndices / iVerticesPerFace : 0));
+  std::unique_ptr<MeshWriter> writer = OpenMeshWriter(ioMan, strTarget,
+                                                      strTempDir, true);
+  bool bWritten = writer != NULL;
+  if (bWritten) {
+    writer->SetVerticesPerFace(iVerticesPerFace ? iVerticesPerFace : 3);
+    for (size_t s = 0;bWritten && s<VertexWelder::SHARDS;s++) {
+      const std::vector<float>& positions = welder.GetPositions(s);
+      bWritten = writer->AddVertices(positions.data(), positions.size()/3);
+    }
+
+    std::ifstream in(strFaces.c_str(), std::ios::binary);
+    std::vector<uint32_t> buffer(size_t(1) << 20);
+    while (bWritten &&
+           (in.read(reinterpret_cast<char*>(&buffer[0]),
+                    std::streamsize(buffer.size()*sizeof(uint32_t))) ||
+            in.gcount() > 0)) {
+      const size_t n = size_t(in.gcount())/sizeof(uint32_t);
+      for (size_t i = 0;i<n;i++) buffer[i] = welder.GlobalId(buffer[i]);
+      bWritten = writer->AddFaces(&buffer[0], n);
+    }
+    bWritten = bWritten && writer->Close();
+  }
+  std::remove(strFaces.c_str());
+  return bWritten;
+}
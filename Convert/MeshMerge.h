@@ -0,0 +1,70 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    MeshMerge.h
+  \brief   Chunked mesh conversion and N-way mesh merge with vertex
+           welding.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef MESHMERGE_H
+#define MESHMERGE_H
+
+#include <string>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+namespace tuvok {
+  class IOManager;
+}
+
+/// Copies the mesh strSource to strTarget chunk by chunk, see
+/// MeshStream.h.  Fails with bUnsupported set if the source has normals,
+/// texture coordinates or colors, which this path would drop; the caller
+/// should then convert the whole mesh with Tuvok instead.
+bool StreamMesh(const tuvok::IOManager& ioMan,
+                const std::string& strSource,
+                const std::string& strTarget,
+                const std::string& strTempDir,
+                bool& bUnsupported);
+
+/// Merges the meshes in vInputs into strTarget.  Vertices at identical
+/// positions are welded into one, faces that collapse doing so are
+/// dropped.  Up to iWorkers inputs are read and welded at once; memory
+/// grows with the number of distinct vertices, while faces wait in a
+/// temporary file in strTempDir.  Only positions and faces are merged.
+bool MergeMeshes(const tuvok::IOManager& ioMan,
+                 const std::vector<std::string>& vInputs,
+                 const std::string& strTarget,
+                 const std::string& strTempDir,
+                 size_t iWorkers);
+
+#endif // MESHMERGE_H
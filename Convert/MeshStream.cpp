@@ -0,0 +1,414 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    MeshStream.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+#include "MeshStream.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <Basics/SysTools.h>
+#include <IO/AbstrGeoConverter.h>
+#include <IO/IOManager.h>
+#include <IO/Mesh.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+namespace {
+  /// Values per chunk, positions or indices.
+  const size_t CHUNK = size_t(1) << 20;
+
+  bool IsObj(const std::string& strFile) {
+    return SysTools::ToLowerCase(SysTools::GetExt(strFile)) == "obj";
+  }
+
+  const char* SkipBlanks(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+    return p;
+  }
+
+  bool IsBlank(char c) {
+    return isspace(static_cast<unsigned char>(c)) != 0;
+  }
+
+  /// Wavefront OBJ, read line by line.  Faces with more than three
+  /// corners are split into a fan, polylines into segments.
+  class ObjMeshReader : public MeshReader {
+    public:
+      ObjMeshReader(const std::string& strFile, bool bStopAtAttributes) :
+        m_strFile(strFile),
+        m_File(strFile.c_str()),
+        m_bStop(bStopAtAttributes),
+        m_iVertices(0),
+        m_iLine(0)
+      {
+        if (!m_File.is_open()) {
+          T_ERROR("Could not open '%s'", strFile.c_str());
+          m_bFailed = true;
+        }
+      }
+
+      bool Next(MeshChunk& chunk) {
+        chunk.Clear();
+        std::string line;
+        while (!m_bFailed && chunk.vPositions.size() < CHUNK &&
+               chunk.vIndices.size() < CHUNK && std::getline(m_File, line)) {
+          m_iLine++;
+          const char* p = SkipBlanks(line.c_str());
+          bool bAttribute = false;
+          if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            bAttribute = !ParseVertex(p+1, chunk);
+          } else if (p[0] == 'v' && (p[1] == 'n' || p[1] == 't' || p[1] == 'p')) {
+            bAttribute = true;
+          } else if ((p[0] == 'f' || p[0] == 'l') && (p[1] == ' ' || p[1] == '\t')) {
+            ParseFace(p[0] == 'f' ? 3 : 2, p+1, chunk);
+          }
+          if (bAttribute) {
+            m_bAttributes = true;
+            if (m_bStop) m_bFailed = true;
+          }
+        }
+        if (m_File.bad()) {
+          T_ERROR("Could not read '%s'", m_strFile.c_str());
+          m_bFailed = true;
+        }
+        return !m_bFailed &&
+               (!chunk.vPositions.empty() || !chunk.vIndices.empty());
+      }
+
+    private:
+      /// Returns false if the vertex carries a color.
+      bool ParseVertex(const char* p, MeshChunk& chunk) {
+        char* end = NULL;
+        float v[3];
+        for (int i = 0;i<3;i++) {
+          v[i] = strtof(p, &end);
+          if (end == p) {
+            T_ERROR("%s:%u: bad vertex", m_strFile.c_str(), unsigned(m_iLine));
+            m_bFailed = true;
+            return true;
+          }
+          p = end;
+        }
+        chunk.vPositions.insert(chunk.vPositions.end(), v, v+3);
+        m_iVertices++;
+        // a fourth value is the weight, three more are a color
+        size_t iExtra = 0;
+        for (p = SkipBlanks(p);*p && !IsBlank(*p);p = SkipBlanks(end)) {
+          strtof(p, &end);
+          if (end == p) break;
+          iExtra++;
+        }
+        return iExtra < 3;
+      }
+
+      void ParseFace(size_t iCorners, const char* p, MeshChunk& chunk) {
+        if (m_iVerticesPerFace == 0) m_iVerticesPerFace = iCorners;
+        if (m_iVerticesPerFace != iCorners) {
+          T_ERROR("%s:%u: mixing lines and faces is not supported",
+                  m_strFile.c_str(), unsigned(m_iLine));
+          m_bFailed = true;
+          return;
+        }
+
+        m_Corners.clear();
+        for (p = SkipBlanks(p);*p;p = SkipBlanks(p)) {
+          char* end = NULL;
+          const long long i = strtoll(p, &end, 10);
+          // negative indices count back from the last vertex
+          const long long iIndex = i < 0 ? (long long)m_iVertices + i : i - 1;
+          if (end == p || i == 0 || iIndex < 0 || iIndex > 0xFFFFFFFFLL) {
+            T_ERROR("%s:%u: bad index", m_strFile.c_str(), unsigned(m_iLine));
+            m_bFailed = true;
+            return;
+          }
+          m_Corners.push_back(uint32_t(iIndex));
+          // texture and normal indices
+          for (p = end;*p && !IsBlank(*p);p++) {}
+        }
+
+        if (iCorners == 3) {
+          for (size_t i = 2;i<m_Corners.size();i++) {
+            chunk.vIndices.push_back(m_Corners[0]);
+            chunk.vIndices.push_back(m_Corners[i-1]);
+            chunk.vIndices.push_back(m_Corners[i]);
+          }
+        } else {
+          for (size_t i = 1;i<m_Corners.size();i++) {
+            chunk.vIndices.push_back(m_Corners[i-1]);
+            chunk.vIndices.push_back(m_Corners[i]);
+          }
+        }
+      }
+
+      std::string           m_strFile;
+      std::ifstream         m_File;
+      bool                  m_bStop;
+      uint64_t              m_iVertices;
+      uint64_t              m_iLine;
+      std::vector<uint32_t> m_Corners;
+  };
+
+  /// Loads the whole mesh through a Tuvok converter, then hands it out.
+  class TuvokMeshReader : public MeshReader {
+    public:
+      TuvokMeshReader(AbstrGeoConverter& conv, const std::string& strFile) :
+        m_iVertex(0),
+        m_iIndex(0)
+      {
+        try {
+          m_Mesh = conv.ConvertToMesh(strFile);
+        } catch (const std::exception& e) {
+          T_ERROR("Could not load '%s': %s", strFile.c_str(), e.what());
+        }
+        if (!m_Mesh) {
+          m_bFailed = true;
+          return;
+        }
+        m_iVerticesPerFace = m_Mesh->GetMeshType() == Mesh::MT_LINES
+                           ? 2 : m_Mesh->GetVerticesPerPoly();
+        m_bAttributes = !m_Mesh->GetNormals().empty() ||
+                        !m_Mesh->GetTexCoords().empty() ||
+                        !m_Mesh->GetColors().empty();
+      }
+
+      bool Next(MeshChunk& chunk) {
+        chunk.Clear();
+        if (m_bFailed) return false;
+        const VertVec& vertices = m_Mesh->GetVertices();
+        const IndexVec& indices = m_Mesh->GetVertexIndices();
+        for (;m_iVertex<vertices.size() && chunk.vPositions.size()<CHUNK;
+             m_iVertex++) {
+          chunk.vPositions.push_back(vertices[m_iVertex].x);
+          chunk.vPositions.push_back(vertices[m_iVertex].y);
+          chunk.vPositions.push_back(vertices[m_iVertex].z);
+        }
+        if (m_iVertex == vertices.size()) {
+          const size_t iEnd = std::min(indices.size(), m_iIndex + CHUNK);
+          chunk.vIndices.assign(indices.begin() + m_iIndex,
+                                indices.begin() + iEnd);
+          m_iIndex = iEnd;
+        }
+        return !chunk.vPositions.empty() || !chunk.vIndices.empty();
+      }
+
+    private:
+      std::shared_ptr<Mesh> m_Mesh;
+      size_t m_iVertex;
+      size_t m_iIndex;
+  };
+
+  /// Wavefront OBJ.  Vertices go straight to the file, faces too when all
+  /// vertices come first, otherwise through a binary temporary file that
+  /// is appended on Close().
+  class ObjMeshWriter : public MeshWriter {
+    public:
+      ObjMeshWriter(const std::string& strFile, const std::string& strTempDir,
+                    bool bVerticesFirst) :
+        m_strFile(strFile),
+        m_Out(strFile.c_str(), std::ios::trunc),
+        m_bClosed(false)
+      {
+        m_Out << "# written by TuvokDataConverter\n";
+        if (!bVerticesFirst) {
+          m_strFaces = SysTools::FindNextSequenceName(
+            strTempDir + SysTools::GetFilename(SysTools::RemoveExt(strFile)) +
+            "-faces.tmp");
+          m_Faces.open(m_strFaces.c_str(), std::ios::out | std::ios::binary |
+                                           std::ios::trunc);
+        }
+      }
+
+      ~ObjMeshWriter() {
+        if (m_Faces.is_open()) m_Faces.close();
+        if (!m_strFaces.empty()) std::remove(m_strFaces.c_str());
+        // do not leave half a mesh behind
+        if (!m_bClosed) {
+          m_Out.close();
+          std::remove(m_strFile.c_str());
+        }
+      }
+
+      bool AddVertices(const float* p, size_t iCount) {
+        char line[64];
+        for (size_t i = 0;i<iCount;i++, p += 3) {
+          const int n = snprintf(line, sizeof(line), "v %.9g %.9g %.9g\n",
+                                 p[0], p[1], p[2]);
+          m_Out.write(line, n);
+        }
+        return m_Out.good();
+      }
+
+      bool AddFaces(const uint32_t* p, size_t iIndexCount) {
+        if (m_strFaces.empty()) return WriteFaces(p, iIndexCount);
+        m_Faces.write(reinterpret_cast<const char*>(p),
+                      std::streamsize(iIndexCount * sizeof(uint32_t)));
+        return m_Faces.good();
+      }
+
+      bool Close() {
+        if (!m_strFaces.empty()) {
+          m_Faces.close();
+          std::ifstream faces(m_strFaces.c_str(), std::ios::binary);
+          std::vector<uint32_t> buffer(CHUNK - CHUNK % m_iVerticesPerFace);
+          while (faces.read(reinterpret_cast<char*>(&buffer[0]),
+                            std::streamsize(buffer.size()*sizeof(uint32_t))) ||
+                 faces.gcount() > 0) {
+            if (!WriteFaces(&buffer[0], size_t(faces.gcount())/sizeof(uint32_t))) {
+              break;
+            }
+          }
+        }
+        m_Out.close();
+        if (m_Out.fail()) {
+          T_ERROR("Could not write '%s'", m_strFile.c_str());
+          return false;
+        }
+        m_bClosed = true;
+        return true;
+      }
+
+    private:
+      bool WriteFaces(const uint32_t* p, size_t iIndexCount) {
+        const char* prefix = m_iVerticesPerFace == 2 ? "l" : "f";
+        std::string line;
+        char index[16];
+        for (size_t i = 0;i+m_iVerticesPerFace<=iIndexCount;i += m_iVerticesPerFace) {
+          line = prefix;
+          for (size_t c = 0;c<m_iVerticesPerFace;c++) {
+            snprintf(index, sizeof(index), " %u", unsigned(p[i+c]) + 1);
+            line += index;
+          }
+          line += '\n';
+          m_Out << line;
+        }
+        return m_Out.good();
+      }
+
+      std::string   m_strFile;
+      std::ofstream m_Out;
+      std::string   m_strFaces;
+      std::fstream  m_Faces;
+      bool          m_bClosed;
+  };
+
+  /// Collects the mesh and writes it with a Tuvok converter.
+  class TuvokMeshWriter : public MeshWriter {
+    public:
+      TuvokMeshWriter(AbstrGeoConverter& conv, const std::string& strFile) :
+        m_Conv(conv),
+        m_strFile(strFile)
+      {}
+
+      bool AddVertices(const float* p, size_t iCount) {
+        for (size_t i = 0;i<iCount;i++, p += 3) {
+          m_Vertices.push_back(FLOATVECTOR3(p[0], p[1], p[2]));
+        }
+        return true;
+      }
+
+      bool AddFaces(const uint32_t* p, size_t iIndexCount) {
+        m_Indices.insert(m_Indices.end(), p, p + iIndexCount);
+        return true;
+      }
+
+      bool Close() {
+        const Mesh mesh(m_Vertices, NormVec(), TexCoordVec(), ColorVec(),
+                        m_Indices, IndexVec(), IndexVec(), IndexVec(),
+                        false, false, SysTools::GetFilename(m_strFile),
+                        m_iVerticesPerFace == 2 ? Mesh::MT_LINES
+                                                : Mesh::MT_TRIANGLES);
+        if (!m_Conv.ConvertToNative(mesh, m_strFile)) {
+          T_ERROR("Could not write '%s'", m_strFile.c_str());
+          return false;
+        }
+        return true;
+      }
+
+    private:
+      AbstrGeoConverter& m_Conv;
+      std::string        m_strFile;
+      VertVec            m_Vertices;
+      IndexVec           m_Indices;
+  };
+}
+
+bool CanStreamMesh(const std::string& strFile)
+{
+  return IsObj(strFile);
+}
+
+std::unique_ptr<MeshReader> OpenMeshReader(const IOManager& ioMan,
+                                           const std::string& strFile,
+                                           bool bStopAtAttributes)
+{
+  if (IsObj(strFile)) {
+    return std::unique_ptr<MeshReader>(
+      new ObjMeshReader(strFile, bStopAtAttributes));
+  }
+  AbstrGeoConverter* conv = ioMan.GetGeoConverterForExt(
+    SysTools::ToLowerCase(SysTools::GetExt(strFile)), false, true);
+  if (!conv) {
+    T_ERROR("Cannot read meshes like '%s'", strFile.c_str());
+    return std::unique_ptr<MeshReader>();
+  }
+  return std::unique_ptr<MeshReader>(new TuvokMeshReader(*conv, strFile));
+}
+
+std::unique_ptr<MeshWriter> OpenMeshWriter(const IOManager& ioMan,
+                                           const std::string& strFile,
+                                           const std::string& strTempDir,
+                                           bool bVerticesFirst)
+{
+  if (IsObj(strFile)) {
+    return std::unique_ptr<MeshWriter>(
+      new ObjMeshWriter(strFile, strTempDir, bVerticesFirst));
+  }
+  AbstrGeoConverter* conv = ioMan.GetGeoConverterForExt(
+    SysTools::ToLowerCase(SysTools::GetExt(strFile)), true, false);
+  if (!conv) {
+    T_ERROR("Cannot write meshes like '%s'", strFile.c_str());
+    return std::unique_ptr<MeshWriter>();
+  }
+  return std::unique_ptr<MeshWriter>(
+    new TuvokMeshWriter(*conv, strFile));
+}
@@ -0,0 +1,130 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    MeshStream.h
+  \brief   Chunked mesh readers and writers, so large meshes never have to
+           be held in memory as a whole.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef MESHSTREAM_H
+#define MESHSTREAM_H
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+namespace tuvok {
+  class IOManager;
+}
+
+/// A piece of a mesh: the next vertex positions, x,y,z each, and faces.
+/// Face indices count every vertex of the mesh read so far, including
+/// those of earlier chunks.
+struct MeshChunk {
+  std::vector<float>    vPositions;
+  std::vector<uint32_t> vIndices;
+
+  void Clear() {vPositions.clear(); vIndices.clear();}
+  size_t VertexCount() const {return vPositions.size()/3;}
+};
+
+/// Reads a mesh chunk by chunk.  Only positions and faces are read.
+class MeshReader {
+  public:
+    virtual ~MeshReader() {}
+
+    /// Fills chunk with the next vertices and faces.  Returns false at the
+    /// end of the mesh or on errors, see Failed().
+    virtual bool Next(MeshChunk& chunk) = 0;
+
+    /// 3 for triangles, 2 for lines, 0 until the first face was read.
+    size_t GetVerticesPerFace() const {return m_iVerticesPerFace;}
+    /// True if the mesh has normals, texture coordinates or colors that
+    /// were skipped.
+    bool HasAttributes() const {return m_bAttributes;}
+    bool Failed() const {return m_bFailed;}
+
+  protected:
+    MeshReader() : m_iVerticesPerFace(0), m_bAttributes(false),
+                   m_bFailed(false) {}
+
+    size_t m_iVerticesPerFace;
+    bool   m_bAttributes;
+    bool   m_bFailed;
+};
+
+/// Writes a mesh chunk by chunk.
+class MeshWriter {
+  public:
+    virtual ~MeshWriter() {}
+
+    /// 3 for triangles, 2 for lines; needed before the first face.
+    void SetVerticesPerFace(size_t iVerticesPerFace) {
+      m_iVerticesPerFace = iVerticesPerFace;
+    }
+
+    virtual bool AddVertices(const float* pPositions, size_t iCount) = 0;
+    /// Indices are 0 based and count all vertices added so far.
+    virtual bool AddFaces(const uint32_t* pIndices, size_t iIndexCount) = 0;
+    /// Completes the file; nothing is guaranteed to be written before.
+    virtual bool Close() = 0;
+
+  protected:
+    MeshWriter() : m_iVerticesPerFace(3) {}
+
+    size_t m_iVerticesPerFace;
+};
+
+/// True if strFile can be read or written without loading it whole.
+bool CanStreamMesh(const std::string& strFile);
+
+/// Opens a streaming reader for Wavefront OBJ files, otherwise a reader
+/// that loads the mesh through Tuvok's converter and hands it out in
+/// chunks.  With bStopAtAttributes an OBJ reader fails as soon as it meets
+/// data it would drop; HasAttributes() tells that case apart.
+std::unique_ptr<MeshReader> OpenMeshReader(const tuvok::IOManager& ioMan,
+                                           const std::string& strFile,
+                                           bool bStopAtAttributes = false);
+
+/// Opens a streaming writer for OBJ, otherwise a writer that collects the
+/// mesh and hands it to Tuvok's converter on Close().  An OBJ writer keeps
+/// faces in a temporary file in strTempDir until Close(), unless the
+/// caller promises with bVerticesFirst to add every vertex before the
+/// first face.
+std::unique_ptr<MeshWriter> OpenMeshWriter(const tuvok::IOManager& ioMan,
+                                           const std::string& strFile,
+                                           const std::string& strTempDir,
+                                           bool bVerticesFirst = false);
+
+#endif // MESHSTREAM_H
@@ -0,0 +1,307 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    Quantizer.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+
+#include "Quantizer.h"
+#include "../DebugOut/ProfileOut.h"
+#include "../Expr/CompiledExpression.h"
+#include "../Expr/Expression.h"
+#include "../Util/MemoryGovernor.h"
+#include "../Util/WorkerPool.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <IO/IOManager.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+namespace {
+  /// slices are read in blocks of about this size
+  const uint64_t BLOCK_BYTES = 16*1024*1024;
+
+  typedef std::function<bool (size_t iBlock, uint64_t z, uint64_t iSlices,
+                              const uint8_t* pData, size_t worker)> BlockTask;
+
+  /// Reads strRaw in blocks of whole slices on up to iWorkers (> 0) threads,
+  /// each with its own stream, swaps the components to native byte order
+  /// and hands every block to task.  iTaskBytes per voxel are reserved on
+  /// top of the block for task's own buffers.  Stops at the first failure,
+  /// which also aborts pTarget if the task writes to one.
+  bool ForEachBlock(const std::string& strRaw, uint64_t iHeaderSkip,
+                    bool bSwap, const RawVolumeInfo& info, size_t iWorkers,
+                    uint64_t iTaskBytes, RawStagingFile* pTarget,
+                    const BlockTask& task)
+  {
+    const uint64_t iSliceBytes = info.BytesPerSlice();
+    const uint64_t iSlicesPerBlock = std::max<uint64_t>(1, BLOCK_BYTES / iSliceBytes);
+    const size_t iBlocks = size_t((info.iSize[2] + iSlicesPerBlock - 1) /
+                                  iSlicesPerBlock);
+    const uint64_t iPerWorker = iSlicesPerBlock * info.iSize[0] * info.iSize[1] *
+                                (info.BytesPerVoxel() + iTaskBytes);
+    iWorkers = std::max<size_t>(1, std::min(iWorkers, iBlocks));
+    const MemoryReservation memory(iPerWorker * iWorkers, iPerWorker);
+    iWorkers = size_t(std::max<uint64_t>(1, std::min<uint64_t>(
+      iWorkers, memory.GetBytes() / iPerWorker)));
+
+    const WorkerPool pool(iWorkers);
+    std::vector<std::unique_ptr<std::ifstream>> streams(pool.GetWorkerCount());
+    std::vector<std::vector<char>> blocks(pool.GetWorkerCount());
+    const size_t iComponentBytes = info.iBitWidth / 8;
+    std::atomic<bool> bOk(true);
+    pool.Run(iBlocks, [&](size_t iBlock, size_t worker) {
+      if (!bOk) return;
+      const uint64_t z = iBlock * iSlicesPerBlock;
+      const uint64_t iSlices = std::min(iSlicesPerBlock, info.iSize[2] - z);
+      if (!streams[worker]) {
+        streams[worker].reset(new std::ifstream(strRaw.c_str(), std::ios::binary));
+      }
+      std::ifstream& in = *streams[worker];
+      std::vector<char>& block = blocks[worker];
+      block.resize(size_t(iSlices * iSliceBytes));
+      bool bRead = bool(in.seekg(std::streamoff(iHeaderSkip + z*iSliceBytes))) &&
+                   bool(in.read(&block[0], std::streamsize(block.size())));
+      if (bRead && bSwap && iComponentBytes > 1) {
+        for (size_t i = 0;i<block.size();i+=iComponentBytes) {
+          std::reverse(block.begin()+i, block.begin()+i+iComponentBytes);
+        }
+      }
+      if (!bRead || !task(iBlock, z, iSlices,
+                          reinterpret_cast<const uint8_t*>(&block[0]), worker)) {
+        // a staging file would wait for this block forever
+        bOk = false;
+        if (pTarget) pTarget->Abort();
+      }
+    });
+    return bOk;
+  }
+}
+
+static std::unique_ptr<ExprNode> Node(ExprNode::Kind kind,
+                                      std::unique_ptr<ExprNode> a,
+                                      std::unique_ptr<ExprNode> b)
+{
+  std::unique_ptr<ExprNode> n(new ExprNode(kind));
+  n->a = std::move(a);
+  n->b = std::move(b);
+  return n;
+}
+
+static std::unique_ptr<ExprNode> Constant(double f)
+{
+  std::unique_ptr<ExprNode> n(new ExprNode(ExprNode::CONSTANT));
+  n->value = f;
+  return n;
+}
+
+Quantizer::Quantizer(const RawVolumeInfo& source, double fMin, double fMax,
+                     unsigned iBits) :
+  m_Target(source)
+{
+  m_Target.iBitWidth = iBits <= 8 ? 8 : 16;
+  m_Target.iComponentCount = 1;
+  m_Target.bSigned = false;
+  m_Target.bFloat = false;
+
+  // a constant volume maps to 0
+  const double fLevels = double((uint64_t(1) << iBits) - 1);
+  const double fScale = fMax > fMin ? fLevels / (fMax - fMin) : 0.0;
+  // min((v[0] - fMin) * fScale, fLevels), clamped in case the recorded
+  // range does not cover every voxel
+  std::unique_ptr<ExprNode> map = Node(
+    ExprNode::MIN,
+    Node(ExprNode::MUL,
+         Node(ExprNode::SUB, std::unique_ptr<ExprNode>(
+                new ExprNode(ExprNode::VOLUME)), Constant(fMin)),
+         Constant(fScale)),
+    Constant(fLevels));
+  m_pKernel.reset(new CompiledExpression(
+    Expression(std::move(map), 1),
+    std::vector<VoxelType>(1, GetVoxelType(source)), GetVoxelType(m_Target)));
+}
+
+Quantizer::~Quantizer()
+{
+}
+
+void Quantizer::Remap(const uint8_t* pIn, size_t iCount, uint8_t* pOut,
+                      std::vector<uint8_t>& scratch) const
+{
+  m_pKernel->Evaluate(&pIn, iCount, pOut, scratch);
+}
+
+bool Quantizer::IsValidRange(double fMin, double fMax)
+{
+  return std::isfinite(fMin) && std::isfinite(fMax) && fMin <= fMax;
+}
+
+bool Quantizer::IsUseful(const RawVolumeInfo& info, unsigned iBits)
+{
+  if (info.iComponentCount != 1 ||
+      GetVoxelType(info) == VT_UNSUPPORTED) {
+    return false;
+  }
+  return info.bFloat || info.iBitWidth > iBits;
+}
+
+bool ScanRawRange(const std::string& strRaw, uint64_t iHeaderSkip,
+                  bool bSwap, const RawVolumeInfo& info, size_t iWorkers,
+                  double& fMin, double& fMax)
+{
+  ProfileScope stage("ScanRange");
+  const VoxelType eType = GetVoxelType(info);
+  if (iWorkers == 0) iWorkers = WorkerPool::HardwareThreads();
+  const size_t iSlots = iWorkers;
+  // per worker, merged once every block is done
+  std::vector<double> vMin(iSlots, std::numeric_limits<double>::infinity());
+  std::vector<double> vMax(iSlots, -std::numeric_limits<double>::infinity());
+  // blocks finish out of order, so progress counts slices, not positions
+  std::atomic<uint64_t> iScanned(0);
+  const bool bOk = ForEachBlock(strRaw, iHeaderSkip, bSwap, info, iWorkers, 0,
+                                NULL, [&](size_t, uint64_t, uint64_t iSlices,
+                                          const uint8_t* pData, size_t worker) {
+    double fLow = vMin[worker], fHigh = vMax[worker];
+    AccumulateRange(eType, pData, size_t(iSlices * info.iSize[0] * info.iSize[1] *
+                                         info.iComponentCount), fLow, fHigh);
+    vMin[worker] = fLow;
+    vMax[worker] = fHigh;
+    MESSAGE("Scanned %u of %u slices", unsigned(iScanned += iSlices),
+            unsigned(info.iSize[2]));
+    return true;
+  });
+  if (!bOk) {
+    T_ERROR("Could not read '%s'", strRaw.c_str());
+    return false;
+  }
+  fMin = *std::min_element(vMin.begin(), vMin.end());
+  fMax = *std::max_element(vMax.begin(), vMax.end());
+  if (!Quantizer::IsValidRange(fMin, fMax)) {
+    T_ERROR("'%s' holds no finite voxel", strRaw.c_str());
+    return false;
+  }
+  stage.SetBytes(info.Bytes(), 0);
+  return true;
+}
+
+bool QuantizeRaw(const std::string& strRaw, uint64_t iHeaderSkip, bool bSwap,
+                 const RawVolumeInfo& info, const Quantizer& quantizer,
+                 const std::string& strTarget, size_t iWorkers)
+{
+  ProfileScope stage("QuantizeRaw");
+  const RawVolumeInfo& target = quantizer.GetTargetInfo();
+  RawStagingFile raw(strTarget, target);
+  if (!raw.IsOpen()) return false;
+
+  // per worker quantized block and kernel registers
+  if (iWorkers == 0) iWorkers = WorkerPool::HardwareThreads();
+  const size_t iSlots = iWorkers;
+  std::vector<std::vector<uint8_t>> quantized(iSlots);
+  std::vector<std::vector<uint8_t>> registers(iSlots);
+  std::atomic<uint64_t> iQuantized(0);
+  bool bOk = ForEachBlock(strRaw, iHeaderSkip, bSwap, info, iWorkers,
+                          target.BytesPerVoxel(), &raw,
+                          [&](size_t iBlock, uint64_t z, uint64_t iSlices,
+                              const uint8_t* pData, size_t worker) {
+    const size_t iVoxels = size_t(iSlices * info.iSize[0] * info.iSize[1]);
+    quantized[worker].resize(size_t(iVoxels * target.BytesPerVoxel()));
+    quantizer.Remap(pData, iVoxels, &quantized[worker][0], registers[worker]);
+    const uint64_t iOrigin[3] = {0, 0, z};
+    const uint64_t iSize[3] = {info.iSize[0], info.iSize[1], iSlices};
+    MESSAGE("Quantized %u of %u slices", unsigned(iQuantized += iSlices),
+            unsigned(info.iSize[2]));
+    return raw.WriteBox(iBlock, iOrigin, iSize, &quantized[worker][0]);
+  });
+  bOk = raw.Close() && bOk;
+  if (!bOk) {
+    T_ERROR("Could not quantize '%s'", strRaw.c_str());
+    std::remove(strTarget.c_str());
+    return false;
+  }
+  stage.SetBytes(info.Bytes(), target.Bytes());
+  return true;
+}
+
+bool ConvertQuantized(const IOManager& ioMan, const std::string& strSource,
+                      const std::string& strTarget,
+                      const std::string& strTempDir,
+                      uint64_t iBrickSize, uint64_t iBrickOverlap,
+                      size_t iWorkers, unsigned iBits)
+{
+  std::string strRaw;
+  uint64_t iHeaderSkip = 0;
+  bool bSwap = false;
+  bool bDelete = false;
+  RawVolumeInfo info;
+  if (!StageRawSource(ioMan, strSource, strTempDir, strRaw, iHeaderSkip,
+                      bSwap, info, bDelete)) {
+    T_ERROR("Could not read the volume data of '%s'", strSource.c_str());
+    return false;
+  }
+  if (!Quantizer::IsUseful(info, iBits)) {
+    if (bDelete) std::remove(strRaw.c_str());
+    WARNING("'%s' is not a scalar volume wider than %u bits, it is not "
+            "quantized", strSource.c_str(), iBits);
+    return ioMan.ConvertDataset(strSource, strTarget, strTempDir, true,
+                                iBrickSize, iBrickOverlap, false);
+  }
+
+  double fMin = 0.0;
+  double fMax = 0.0;
+  bool bOk = ScanRawRange(strRaw, iHeaderSkip, bSwap, info, iWorkers,
+                          fMin, fMax);
+  const std::string strQuantized = StagingFilename(strTarget, strTempDir);
+  RawVolumeInfo target;
+  if (bOk) {
+    MESSAGE("Quantizing [%g, %g] to %u bits", fMin, fMax, iBits);
+    const Quantizer quantizer(info, fMin, fMax, iBits);
+    target = quantizer.GetTargetInfo();
+    bOk = QuantizeRaw(strRaw, iHeaderSkip, bSwap, info, quantizer,
+                      strQuantized, iWorkers);
+  }
+  if (bDelete) std::remove(strRaw.c_str());
+  return bOk && BuildUVFFromRaw(ioMan, strQuantized, target, strTarget,
+                                strTempDir, iBrickSize, iBrickOverlap);
+}
@@ -0,0 +1,114 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    Quantizer.h
+  \brief   Linear quantization of voxel data to 8 to 16 bit integers.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef QUANTIZER_H
+#define QUANTIZER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RawStaging.h"
+#include "VoxelType.h"
+
+class CompiledExpression;
+
+namespace tuvok {
+  class IOManager;
+}
+
+/// Maps the value range [fMin, fMax] of a volume linearly onto the
+/// integers [0, 2^iBits-1], stored as uint8 for 8 bits and uint16 above.
+/// The remap runs through the compiled expression kernels, so it is
+/// vectorized like every other voxel transform.
+class Quantizer {
+  public:
+    /// The range must pass IsValidRange.
+    Quantizer(const RawVolumeInfo& source, double fMin, double fMax,
+              unsigned iBits);
+    ~Quantizer();
+
+    /// Layout of the quantized volume.
+    const RawVolumeInfo& GetTargetInfo() const {return m_Target;}
+
+    /// Remaps iCount voxels.  Safe to call concurrently as long as every
+    /// thread passes its own scratch.
+    void Remap(const uint8_t* pIn, size_t iCount, uint8_t* pOut,
+               std::vector<uint8_t>& scratch) const;
+
+    /// True if a volume of this layout gains from quantizing to iBits,
+    /// i.e. it is scalar and not already an integer of at most iBits.
+    static bool IsUseful(const RawVolumeInfo& info, unsigned iBits);
+
+    /// True if [fMin, fMax] is a finite, non-empty range a Quantizer can
+    /// map; a volume of NaNs or infinities has none.
+    static bool IsValidRange(double fMin, double fMax);
+
+  private:
+    RawVolumeInfo m_Target;
+    std::unique_ptr<CompiledExpression> m_pKernel;
+};
+
+/// Value range of the raw volume strRaw, whose voxels start iHeaderSkip
+/// bytes into the file and have their components byte swapped if bSwap.
+/// Blocks of slices are read on iWorkers threads, 0 for one per core, and
+/// non-finite voxels are skipped.  Fails if the file is short or holds no
+/// finite voxel.
+bool ScanRawRange(const std::string& strRaw, uint64_t iHeaderSkip,
+                  bool bSwap, const RawVolumeInfo& info, size_t iWorkers,
+                  double& fMin, double& fMax);
+
+/// Reads strRaw the way ScanRawRange does and writes it remapped by
+/// quantizer to the staging file strTarget, which has the layout of
+/// quantizer.GetTargetInfo().
+bool QuantizeRaw(const std::string& strRaw, uint64_t iHeaderSkip, bool bSwap,
+                 const RawVolumeInfo& info, const Quantizer& quantizer,
+                 const std::string& strTarget, size_t iWorkers);
+
+/// Converts the volume file strSource to the UVF strTarget quantized to
+/// iBits.  The raw data the converter works from is read twice, once for
+/// its value range and once to stage it quantized, and bricked once; no
+/// unquantized UVF is written.  A source that already fits iBits is
+/// converted unchanged.
+bool ConvertQuantized(const tuvok::IOManager& ioMan,
+                      const std::string& strSource,
+                      const std::string& strTarget,
+                      const std::string& strTempDir,
+                      uint64_t iBrickSize, uint64_t iBrickOverlap,
+                      size_t iWorkers, unsigned iBits);
+
+#endif // QUANTIZER_H
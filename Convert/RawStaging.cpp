@@ -0,0 +1,418 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    RawStaging.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+
+#include "RawStaging.h"
+#include "VoxelType.h"
+#include "../DebugOut/ProfileOut.h"
+#include "../Util/Journal.h"
+#include "../Util/MemoryGovernor.h"
+#include "../Util/ProcessStats.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <Basics/SysTools.h>
+#include <Basics/SystemInfo.h>
+#include <IO/AbstrConverter.h>
+#include <IO/Dataset.h>
+#include <IO/IOManager.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+RawVolumeInfo::RawVolumeInfo() :
+  iBitWidth(8),
+  iComponentCount(1),
+  bSigned(false),
+  bFloat(false)
+{
+  for (int i = 0;i<3;i++) {
+    iSize[i] = 0;
+    fAspect[i] = 1.0;
+  }
+}
+
+RawVolumeInfo::RawVolumeInfo(const Dataset& ds) :
+  iBitWidth(ds.GetBitWidth()),
+  iComponentCount(ds.GetComponentCount()),
+  bSigned(ds.GetIsSigned()),
+  bFloat(ds.GetIsFloat())
+{
+  UINT64VECTOR3 domain = ds.GetDomainSize(0, 0);
+  iSize[0] = domain.x;
+  iSize[1] = domain.y;
+  iSize[2] = domain.z;
+  fAspect[0] = ds.GetScale().x;
+  fAspect[1] = ds.GetScale().y;
+  fAspect[2] = ds.GetScale().z;
+}
+
+static const char* NRRDType(const RawVolumeInfo& info)
+{
+  if (info.bFloat) {
+    switch (info.iBitWidth) {
+      case 32: return "float";
+      case 64: return "double";
+      default: return NULL;
+    }
+  }
+  switch (info.iBitWidth) {
+    case 8:  return info.bSigned ? "int8"  : "uint8";
+    case 16: return info.bSigned ? "int16" : "uint16";
+    case 32: return info.bSigned ? "int32" : "uint32";
+    case 64: return info.bSigned ? "int64" : "uint64";
+    default: return NULL;
+  }
+}
+
+static bool IsLittleEndian()
+{
+  const uint16_t probe = 1;
+  return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+}
+
+bool WriteNRRDHeader(const std::string& strHeaderFile,
+                     const std::string& strRawFile,
+                     const RawVolumeInfo& info)
+{
+  const char* type = NRRDType(info);
+  if (!type) {
+    T_ERROR("No NRRD type for %u bit %s data", info.iBitWidth,
+            info.bFloat ? "float" : "integer");
+    return false;
+  }
+
+  std::ofstream nhdr(strHeaderFile.c_str());
+  if (!nhdr.is_open()) {
+    T_ERROR("Could not create '%s'", strHeaderFile.c_str());
+    return false;
+  }
+
+  const bool bVector = info.iComponentCount > 1;
+  nhdr << "NRRD0004\n"
+       << "type: " << type << "\n"
+       << "dimension: " << (bVector ? 4 : 3) << "\n"
+       << "sizes:";
+  if (bVector) nhdr << " " << info.iComponentCount;
+  nhdr << " " << info.iSize[0] << " " << info.iSize[1] << " " << info.iSize[2]
+       << "\n"
+       << "spacings:";
+  if (bVector) nhdr << " nan";
+  nhdr << " " << info.fAspect[0] << " " << info.fAspect[1] << " "
+       << info.fAspect[2] << "\n"
+       << "encoding: raw\n";
+  if (info.iBitWidth > 8) {
+    nhdr << "endian: " << (IsLittleEndian() ? "little" : "big") << "\n";
+  }
+  nhdr << "data file: " << SysTools::GetFilename(strRawFile) << "\n";
+
+  return nhdr.good();
+}
+
+RawStagingFile::RawStagingFile(const std::string& strFilename,
+                               const RawVolumeInfo& info,
+                               uint64_t iFirstSequence,
+                               uint64_t iQueueBytes) :
+  m_strFilename(strFilename),
+  m_Info(info),
+  m_File(strFilename, iFirstSequence == 0),
+  m_iQueueBytes(iQueueBytes),
+  m_iNext(iFirstSequence),
+  m_iQueued(0),
+  m_bClosing(false),
+  m_bFailed(false),
+  m_iCheckpointBytes(0),
+  m_bContinued(iFirstSequence > 0),
+  m_bTrackRange(false),
+  m_fMin(std::numeric_limits<double>::infinity()),
+  m_fMax(-std::numeric_limits<double>::infinity())
+{
+  if (m_iQueueBytes == 0) {
+    m_iQueueBytes = std::min<uint64_t>(
+      uint64_t(256) << 20,
+      Controller::Instance().SysInfo()->GetMaxUsableCPUMem() / 4);
+  }
+  m_iQueueBytes = MemoryGovernor::Instance().Reserve(m_iQueueBytes);
+  if (!m_File.IsOpen()) {
+    T_ERROR("Could not create staging file '%s'", strFilename.c_str());
+    return;
+  }
+  m_Writer = std::thread(&RawStagingFile::WriterLoop, this);
+}
+
+RawStagingFile::~RawStagingFile()
+{
+  Close();
+  MemoryGovernor::Instance().Release(m_iQueueBytes);
+}
+
+bool RawStagingFile::WriteBox(uint64_t iSequence, const uint64_t iOrigin[3],
+                              const uint64_t iSize[3], const uint8_t* pData)
+{
+  Box box;
+  for (int i = 0;i<3;i++) {
+    box.iOrigin[i] = iOrigin[i];
+    box.iSize[i] = iSize[i];
+  }
+  box.data.assign(pData, pData + iSize[0]*iSize[1]*iSize[2]*m_Info.BytesPerVoxel());
+  const uint64_t iBytes = box.data.size();
+  // gathered before taking the lock, so producers do it in parallel
+  double fMin = std::numeric_limits<double>::infinity();
+  double fMax = -std::numeric_limits<double>::infinity();
+  if (m_bTrackRange) {
+    AccumulateRange(GetVoxelType(m_Info), pData,
+                    size_t(iSize[0]*iSize[1]*iSize[2]*m_Info.iComponentCount),
+                    fMin, fMax);
+  }
+
+  std::unique_lock<std::mutex> lock(m_Guard);
+  // the box the writer waits for always gets in, otherwise a full queue of
+  // later boxes could never drain
+  m_Changed.wait(lock, [&]() {
+    return m_bFailed || m_bClosing || iSequence == m_iNext ||
+           m_iQueued + iBytes <= m_iQueueBytes;
+  });
+  if (m_bFailed || m_bClosing || !m_Writer.joinable()) return false;
+  m_iQueued += iBytes;
+  m_fMin = std::min(m_fMin, fMin);
+  m_fMax = std::max(m_fMax, fMax);
+  m_Queue[iSequence] = std::move(box);
+  m_Changed.notify_all();
+  return true;
+}
+
+void RawStagingFile::SetCheckpoint(
+  const std::function<void (uint64_t)>& checkpoint, uint64_t iEveryBytes)
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_Checkpoint = checkpoint;
+  m_iCheckpointBytes = iEveryBytes;
+}
+
+void RawStagingFile::TrackRange()
+{
+  m_bTrackRange = true;
+}
+
+bool RawStagingFile::GetRange(double& fMin, double& fMax) const
+{
+  if (m_bContinued || m_fMin > m_fMax) return false;
+  fMin = m_fMin;
+  fMax = m_fMax;
+  return true;
+}
+
+void RawStagingFile::Abort()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Guard);
+    m_bFailed = true;
+  }
+  m_Changed.notify_all();
+}
+
+void RawStagingFile::WriterLoop()
+{
+  uint64_t iSinceCheckpoint = 0;
+  std::unique_lock<std::mutex> lock(m_Guard);
+  for (;;) {
+    m_Changed.wait(lock, [&]() {
+      return m_bFailed || m_bClosing ||
+             (!m_Queue.empty() && m_Queue.begin()->first == m_iNext);
+    });
+    if (m_bFailed) return;
+    if (m_Queue.empty() || m_Queue.begin()->first != m_iNext) {
+      // closing; anything still queued sits behind a box that never came
+      if (!m_Queue.empty()) {
+        T_ERROR("Staging file '%s' is missing box %u", m_strFilename.c_str(),
+                unsigned(m_iNext));
+        m_bFailed = true;
+      }
+      return;
+    }
+
+    Box box = std::move(m_Queue.begin()->second);
+    m_Queue.erase(m_Queue.begin());
+    const uint64_t iWritten = m_iNext + 1;
+    lock.unlock();
+    bool bOk = Write(box);
+    iSinceCheckpoint += box.data.size();
+    if (bOk && m_Checkpoint && iSinceCheckpoint >= m_iCheckpointBytes) {
+      bOk = m_File.Flush();
+      if (bOk) m_Checkpoint(iWritten);
+      iSinceCheckpoint = 0;
+    }
+    lock.lock();
+    m_iNext++;
+    m_iQueued -= box.data.size();
+    if (!bOk) {
+      T_ERROR("Could not write to staging file '%s'", m_strFilename.c_str());
+      m_bFailed = true;
+    }
+    m_Changed.notify_all();
+  }
+}
+
+bool RawStagingFile::Write(const Box& box)
+{
+  const uint64_t bpv = m_Info.BytesPerVoxel();
+  const bool bFullRows = box.iOrigin[0] == 0 && box.iSize[0] == m_Info.iSize[0];
+  // full width boxes are contiguous per slice, others per row
+  const uint64_t iRun = bFullRows ? box.iSize[0]*box.iSize[1]*bpv
+                                  : box.iSize[0]*bpv;
+  const uint64_t iRunsPerSlice = bFullRows ? 1 : box.iSize[1];
+
+  const uint8_t* pData = box.data.empty() ? NULL : &box.data[0];
+  for (uint64_t z = 0;z<box.iSize[2];z++) {
+    for (uint64_t y = 0;y<iRunsPerSlice;y++) {
+      const uint64_t iOffset = (z+box.iOrigin[2])*m_Info.BytesPerSlice() +
+                               ((y+box.iOrigin[1])*m_Info.iSize[0] +
+                                box.iOrigin[0])*bpv;
+      if (!m_File.Write(iOffset, pData, size_t(iRun))) return false;
+      pData += iRun;
+    }
+  }
+  return true;
+}
+
+bool RawStagingFile::Close()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Guard);
+    m_bClosing = true;
+  }
+  m_Changed.notify_all();
+  if (m_Writer.joinable()) m_Writer.join();
+  if (!m_File.IsOpen()) return false;
+  return m_File.Close() && !m_bFailed;
+}
+
+bool StageRawSource(const IOManager& ioMan, const std::string& strSource,
+                    const std::string& strTempDir, std::string& strRawFile,
+                    uint64_t& iHeaderSkip, bool& bSwap, RawVolumeInfo& info,
+                    bool& bDelete)
+{
+  std::shared_ptr<AbstrConverter> converter = ioMan.GetConverterForExt(
+    SysTools::ToLowerCase(SysTools::GetExt(strSource)), false, false);
+  if (!converter) return false;
+
+  iHeaderSkip = 0;
+  bSwap = false;
+  bDelete = false;
+  unsigned iComponentSize = 8;
+  uint64_t iComponentCount = 1;
+  UINT64VECTOR3 vSize;
+  FLOATVECTOR3 vAspect;
+  std::string strTitle;
+  if (!converter->ConvertToRAW(strSource, strTempDir, true, iHeaderSkip,
+                               iComponentSize, iComponentCount, bSwap,
+                               info.bSigned, info.bFloat, vSize, vAspect,
+                               strTitle, strRawFile, bDelete)) {
+    return false;
+  }
+  info.iBitWidth = iComponentSize;
+  info.iComponentCount = iComponentCount;
+  info.iSize[0] = vSize.x;
+  info.iSize[1] = vSize.y;
+  info.iSize[2] = vSize.z;
+  info.fAspect[0] = vAspect.x;
+  info.fAspect[1] = vAspect.y;
+  info.fAspect[2] = vAspect.z;
+  if (info.BytesPerVoxel() == 0 || info.Bytes() == 0) {
+    if (bDelete) std::remove(strRawFile.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::string StagingFilename(const std::string& strTarget,
+                            const std::string& strTempDir, bool bUnique)
+{
+  const std::string strName =
+    strTempDir + SysTools::GetFilename(SysTools::RemoveExt(strTarget)) + ".raw";
+  return bUnique ? SysTools::FindNextSequenceName(strName) : strName;
+}
+
+bool BuildUVFFromRaw(const IOManager& ioMan,
+                     const std::string& strRawFile,
+                     const RawVolumeInfo& info,
+                     const std::string& strTarget,
+                     const std::string& strTempDir,
+                     uint64_t iBrickSize, uint64_t iBrickOverlap,
+                     bool bKeepOnFailure)
+{
+  ProfileScope stage("BuildUVF");
+  const std::string strHeader = SysTools::ChangeExt(strRawFile, "nhdr");
+  bool bOk = WriteNRRDHeader(strHeader, strRawFile, info) &&
+             ioMan.ConvertDataset(strHeader, strTarget, strTempDir, true,
+                                  iBrickSize, iBrickOverlap);
+  if (bOk) stage.SetBytes(info.Bytes(), ProcessStats::FileSize(strTarget));
+  std::remove(strHeader.c_str());
+  if (bOk || !bKeepOnFailure) std::remove(strRawFile.c_str());
+  return bOk;
+}
+
+uint64_t StagedBoxes(const Journal* pJournal, const std::string& strRawFile)
+{
+  if (!pJournal || !SysTools::FileExists(strRawFile)) return 0;
+  const uint64_t iStaged = pJournal->Get("staged");
+  if (iStaged > 0) {
+    MESSAGE("Resuming after %u staged boxes in '%s'", unsigned(iStaged),
+            strRawFile.c_str());
+  }
+  return iStaged;
+}
+
+void JournalStaging(Journal* pJournal, RawStagingFile& raw)
+{
+  if (!pJournal) return;
+  raw.SetCheckpoint([pJournal](uint64_t iBoxes) {
+    pJournal->Set("staged", iBoxes);
+  }, uint64_t(64) << 20);
+}
+
+void JournalStagingDone(Journal* pJournal, uint64_t iBoxes)
+{
+  if (pJournal) pJournal->Set("staged", iBoxes);
+}
@@ -0,0 +1,207 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    RawStaging.h
+  \brief   Helpers for staging a volume as a headerless raw file that the
+           regular converter registry can pick up through a detached
+           NRRD header.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef RAWSTAGING_H
+#define RAWSTAGING_H
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+#include "../Util/AsyncWriter.h"
+
+class Journal;
+
+namespace tuvok {
+  class Dataset;
+  class IOManager;
+}
+
+/// Layout of a headerless, x-fastest raw volume.
+struct RawVolumeInfo {
+  RawVolumeInfo();
+  /// Copies type, size and aspect of LOD 0 from an open dataset.
+  explicit RawVolumeInfo(const tuvok::Dataset& ds);
+
+  uint64_t BytesPerVoxel() const {return iBitWidth/8 * iComponentCount;}
+  uint64_t BytesPerSlice() const {return iSize[0]*iSize[1]*BytesPerVoxel();}
+  uint64_t Bytes() const {return BytesPerSlice()*iSize[2];}
+
+  uint64_t iSize[3];
+  double   fAspect[3];
+  unsigned iBitWidth;
+  uint64_t iComponentCount;
+  bool     bSigned;
+  bool     bFloat;
+};
+
+/// Writes a detached NRRD header describing strRawFile.  The raw file is
+/// referenced by name only, so it should live in the same directory.
+bool WriteNRRDHeader(const std::string& strHeaderFile,
+                     const std::string& strRawFile,
+                     const RawVolumeInfo& info);
+
+/// Finds the raw data the volume converter for strSource works from:
+/// usually the source itself past a header of iHeaderSkip bytes, otherwise
+/// an intermediate file it writes to strTempDir, which bDelete tells the
+/// caller to remove.  bSwap is set if the components are stored in the
+/// other byte order.
+bool StageRawSource(const tuvok::IOManager& ioMan,
+                    const std::string& strSource,
+                    const std::string& strTempDir,
+                    std::string& strRawFile, uint64_t& iHeaderSkip,
+                    bool& bSwap, RawVolumeInfo& info, bool& bDelete);
+
+/// A raw staging file that several threads fill with boxes of voxels.
+/// Boxes go through a queue to a single writer thread, so producers keep
+/// reading and computing while the disk is busy and only block once
+/// iQueueBytes are waiting.  The writer puts boxes on disk strictly in
+/// sequence order, whatever order the producers finish in, and hands them
+/// to an AsyncFileWriter with the backend set by SetDefaults().
+class RawStagingFile {
+  public:
+    /// Creates or truncates strFilename; check IsOpen() afterwards.  With
+    /// iFirstSequence > 0 an existing file is continued instead, boxes
+    /// before iFirstSequence are taken to be on disk already.  iQueueBytes
+    /// 0 picks a share of the usable memory, at most 256 MB.  The queue is
+    /// reserved from the MemoryGovernor and may get less; with nothing
+    /// granted every box goes to disk as soon as it is its turn.
+    RawStagingFile(const std::string& strFilename, const RawVolumeInfo& info,
+                   uint64_t iFirstSequence = 0, uint64_t iQueueBytes = 0);
+    ~RawStagingFile();
+
+    bool IsOpen() const {return m_File.IsOpen();}
+    const std::string& GetFilename() const {return m_strFilename;}
+
+    /// Queues box number iSequence, iSize voxels, x fastest, whose first
+    /// voxel lies at iOrigin; pData may be reused as soon as this returns.
+    /// Every sequence number from 0 up must be written exactly once.  Safe
+    /// to call from several threads.  Returns false once the file failed.
+    bool WriteBox(uint64_t iSequence, const uint64_t iOrigin[3],
+                  const uint64_t iSize[3], const uint8_t* pData);
+
+    /// Calls checkpoint(n) from the writer thread roughly every iEveryBytes
+    /// written, once boxes [0, n) have been flushed to the OS.  Set it
+    /// before the first WriteBox.
+    void SetCheckpoint(const std::function<void (uint64_t)>& checkpoint,
+                       uint64_t iEveryBytes);
+
+    /// Makes WriteBox gather the value range of the boxes, over every
+    /// component.  Set it before the first WriteBox.
+    void TrackRange();
+
+    /// The range gathered since TrackRange, once every box is written.
+    /// False if no voxel was finite,
+    /// or if the file was continued, its earlier boxes were never seen.
+    bool GetRange(double& fMin, double& fMax) const;
+
+    /// Marks the file as failed and wakes every blocked producer.  Call it
+    /// when a box will never be written, the writer would wait for it
+    /// otherwise.
+    void Abort();
+
+    /// Writes everything still queued and closes the file.  Fails if a
+    /// sequence number is missing.
+    bool Close();
+
+  private:
+    struct Box {
+      uint64_t iOrigin[3];
+      uint64_t iSize[3];
+      std::vector<uint8_t> data;
+    };
+
+    void WriterLoop();
+    bool Write(const Box& box);
+
+    std::string             m_strFilename;
+    RawVolumeInfo           m_Info;
+    AsyncFileWriter         m_File;
+    uint64_t                m_iQueueBytes;
+    std::mutex              m_Guard;
+    std::condition_variable m_Changed;
+    std::map<uint64_t, Box> m_Queue;
+    uint64_t                m_iNext;
+    uint64_t                m_iQueued;
+    bool                    m_bClosing;
+    bool                    m_bFailed;
+    std::thread             m_Writer;
+    std::function<void (uint64_t)> m_Checkpoint;
+    uint64_t                m_iCheckpointBytes;
+    bool                    m_bContinued;
+    bool                    m_bTrackRange;
+    double                  m_fMin;
+    double                  m_fMax;
+};
+
+/// Bricks a complete staging file into strTarget using the settings of
+/// ioMan, then deletes the staging file and its header.  With
+/// bKeepOnFailure the staging file survives a failed build, so a resumed
+/// run can skip staging.
+bool BuildUVFFromRaw(const tuvok::IOManager& ioMan,
+                     const std::string& strRawFile,
+                     const RawVolumeInfo& info,
+                     const std::string& strTarget,
+                     const std::string& strTempDir,
+                     uint64_t iBrickSize, uint64_t iBrickOverlap,
+                     bool bKeepOnFailure = false);
+
+/// A staging file name in strTempDir derived from strTarget.  Unless
+/// bUnique is false, a number is appended that makes it a new file; the
+/// plain name lets a resumed run find the staging file again.
+std::string StagingFilename(const std::string& strTarget,
+                            const std::string& strTempDir,
+                            bool bUnique = true);
+
+/// Number of boxes an earlier run recorded as staged in pJournal, 0 if
+/// there is no journal or its staging file strRawFile is gone.
+uint64_t StagedBoxes(const Journal* pJournal, const std::string& strRawFile);
+
+/// Records in pJournal how far raw got, every 64 MB and once it is
+/// complete; the counterpart of StagedBoxes.  Does nothing without a
+/// journal.
+void JournalStaging(Journal* pJournal, RawStagingFile& raw);
+void JournalStagingDone(Journal* pJournal, uint64_t iBoxes);
+
+#endif // RAWSTAGING_H
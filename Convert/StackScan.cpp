@@ -0,0 +1,175 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    StackScan.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "StackScan.h"
+#include "../Util/Journal.h"
+#include "../Util/WorkerPool.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Basics/SysTools.h>
+#include <IO/DirectoryParser.h>
+
+#pragma GCC diagnostic pop
+
+namespace {
+  const char* const HEADER = "TuvokDataConverter scan index 1";
+}
+
+std::vector<std::string> ListDirectory(const std::string& strDir)
+{
+  std::vector<std::string> vFiles = SysTools::GetDirContents(strDir);
+  std::sort(vFiles.begin(), vFiles.end());
+  return vFiles;
+}
+
+uint64_t ListingSignature(const std::vector<std::string>& vFiles)
+{
+  std::string listing;
+  for (auto f = vFiles.cbegin(); f != vFiles.cend(); ++f) {
+    listing += *f + " " + Journal::FileStamp(*f) + "\n";
+  }
+  return Journal::Hash(listing);
+}
+
+void ReadAhead(const std::vector<std::string>& vFiles, size_t iThreads,
+               size_t iBytes)
+{
+  WorkerPool pool(iThreads);
+  std::vector<std::vector<char>> buffers(pool.GetWorkerCount(),
+                                         std::vector<char>(iBytes));
+  pool.Run(vFiles.size(), [&](size_t i, size_t worker) {
+    std::ifstream in(vFiles[i].c_str(), std::ios::binary);
+    in.read(&buffers[worker][0], std::streamsize(iBytes));
+  });
+}
+
+std::vector<StackSummary>
+SummarizeStacks(const std::vector<std::shared_ptr<FileStackInfo>>& stacks)
+{
+  std::vector<StackSummary> summaries(stacks.size());
+  for (size_t i = 0;i<stacks.size();i++) {
+    const FileStackInfo& stack = *stacks[i];
+    StackSummary& s = summaries[i];
+    s.strType = stack.m_strFileType;
+    s.strDesc = stack.m_strDesc;
+    // the index keeps one description per line
+    std::replace(s.strDesc.begin(), s.strDesc.end(), '\n', ' ');
+    s.iSize[0] = stack.m_ivSize.x;
+    s.iSize[1] = stack.m_ivSize.y;
+    s.iSize[2] = stack.m_ivSize.z;
+    s.iComponents = stack.m_iComponentCount;
+    s.iBits = stack.m_iAllocated;
+    for (auto e = stack.m_Elements.cbegin(); e != stack.m_Elements.cend(); ++e) {
+      s.vFiles.push_back((*e)->m_strFileName);
+    }
+  }
+  return summaries;
+}
+
+// Format: a header line, "directory <dir>", "listing <hash>" and
+// "stacks <n>", then per stack one line each for type, description,
+// "x y z components bits files" and the file names.  Names and
+// descriptions take whole lines so they may contain blanks.
+bool LoadScanIndex(const std::string& strIndex, const std::string& strDir,
+                   uint64_t iListing, std::vector<StackSummary>& stacks)
+{
+  std::ifstream in(strIndex.c_str());
+  std::string line;
+  if (!std::getline(in, line) || line != HEADER) return false;
+  if (!std::getline(in, line) || line != "directory " + strDir) return false;
+
+  std::string key;
+  uint64_t iIndexed = 0;
+  size_t iStacks = 0;
+  if (!(in >> key >> iIndexed) || key != "listing" || iIndexed != iListing) {
+    return false;
+  }
+  if (!(in >> key >> iStacks) || key != "stacks") return false;
+  in.ignore(1);
+
+  std::vector<StackSummary> loaded(iStacks);
+  for (size_t i = 0;i<iStacks;i++) {
+    StackSummary& s = loaded[i];
+    size_t iFiles = 0;
+    if (!std::getline(in, s.strType) || !std::getline(in, s.strDesc) ||
+        !std::getline(in, line)) {
+      return false;
+    }
+    std::istringstream dims(line);
+    if (!(dims >> s.iSize[0] >> s.iSize[1] >> s.iSize[2] >> s.iComponents
+               >> s.iBits >> iFiles)) {
+      return false;
+    }
+    s.vFiles.resize(iFiles);
+    for (size_t f = 0;f<iFiles;f++) {
+      if (!std::getline(in, s.vFiles[f])) return false;
+    }
+  }
+  stacks.swap(loaded);
+  return true;
+}
+
+bool SaveScanIndex(const std::string& strIndex, const std::string& strDir,
+                   uint64_t iListing, const std::vector<StackSummary>& stacks)
+{
+  const std::string strTemp = strIndex + ".tmp";
+  {
+    std::ofstream out(strTemp.c_str(), std::ios::trunc);
+    out << HEADER << "\n" << "directory " << strDir << "\n"
+        << "listing " << iListing << "\n" << "stacks " << stacks.size() << "\n";
+    for (auto s = stacks.cbegin(); s != stacks.cend(); ++s) {
+      out << s->strType << "\n" << s->strDesc << "\n"
+          << s->iSize[0] << " " << s->iSize[1] << " " << s->iSize[2] << " "
+          << s->iComponents << " " << s->iBits << " " << s->vFiles.size() << "\n";
+      for (auto f = s->vFiles.cbegin(); f != s->vFiles.cend(); ++f) {
+        out << *f << "\n";
+      }
+    }
+    out.close();
+    if (out.fail()) return false;
+  }
+#ifdef _WIN32
+  // rename() does not replace an existing file on Windows
+  std::remove(strIndex.c_str());
+#endif
+  return std::rename(strTemp.c_str(), strIndex.c_str()) == 0;
+}
@@ -0,0 +1,88 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    StackScan.h
+  \brief   Helpers that make directory scans of large image stacks cheaper:
+           parallel header readahead and an on-disk scan index.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef STACKSCAN_H
+#define STACKSCAN_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+class FileStackInfo;
+
+/// What a directory scan found out about one stack, enough to list it and
+/// to recognize its files again.
+struct StackSummary {
+  StackSummary() : iComponents(0), iBits(0) {
+    iSize[0] = iSize[1] = iSize[2] = 0;
+  }
+
+  std::string strType;
+  std::string strDesc;
+  uint32_t    iSize[3];
+  uint32_t    iComponents;
+  uint32_t    iBits;
+  std::vector<std::string> vFiles;
+};
+
+/// Files directly in strDir, sorted.
+std::vector<std::string> ListDirectory(const std::string& strDir);
+
+/// Hash over the names, sizes and modification times of vFiles; changes
+/// whenever a file is added, removed or rewritten.
+uint64_t ListingSignature(const std::vector<std::string>& vFiles);
+
+/// Reads the first iBytes of every file on iThreads threads so the headers
+/// are in the page cache when the single threaded directory parser gets to
+/// them.  On network storage this hides most of the per-file latency.
+void ReadAhead(const std::vector<std::string>& vFiles, size_t iThreads,
+               size_t iBytes = 64*1024);
+
+std::vector<StackSummary>
+SummarizeStacks(const std::vector<std::shared_ptr<FileStackInfo>>& stacks);
+
+/// Loads the stacks recorded in a scan index for strDir.  Fails if the
+/// index is missing or was written for another directory or listing.
+bool LoadScanIndex(const std::string& strIndex, const std::string& strDir,
+                   uint64_t iListing, std::vector<StackSummary>& stacks);
+
+/// Writes a scan index, replacing any existing one atomically.
+bool SaveScanIndex(const std::string& strIndex, const std::string& strDir,
+                   uint64_t iListing, const std::vector<StackSummary>& stacks);
+
+#endif // STACKSCAN_H
@@ -0,0 +1,162 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    UVFBricks.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "UVFBricks.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <IO/IOManager.h>
+#include <IO/uvfDataset.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+bool OpenUVFPerWorker(const IOManager& ioMan, const std::string& strFilename,
+                      size_t iCount,
+                      std::vector<std::unique_ptr<Dataset>>& datasets)
+{
+  datasets.resize(iCount);
+  for (size_t w = 0;w<iCount;w++) {
+    datasets[w].reset(ioMan.CreateDataset(strFilename, 256, false));
+    if (!dynamic_cast<UVFDataset*>(datasets[w].get())) {
+      T_ERROR("'%s' is not a UVF file", strFilename.c_str());
+      datasets.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+BrickInterior GetBrickInterior(const UVFDataset& ds, size_t iLOD,
+                               size_t iBrick)
+{
+  const UINTVECTOR3 layout  = ds.GetBrickLayout(iLOD, 0);
+  const UINTVECTOR3 overlap = ds.GetBrickOverlapSize();
+  const UINTVECTOR3 maxSize = ds.GetMaxBrickSize();
+  const UINTVECTOR3 voxels  = ds.GetBrickVoxelCounts(BrickKey(0, iLOD, iBrick));
+
+  const uint64_t b[3] = { iBrick % layout.x,
+                          (iBrick / layout.x) % layout.y,
+                          iBrick / (uint64_t(layout.x)*layout.y) };
+  const uint64_t step[3] = { maxSize.x - 2*overlap.x,
+                             maxSize.y - 2*overlap.y,
+                             maxSize.z - 2*overlap.z };
+  const uint64_t vc[3] = {voxels.x, voxels.y, voxels.z};
+  const uint64_t ov[3] = {overlap.x, overlap.y, overlap.z};
+
+  BrickInterior bi;
+  for (int i = 0;i<3;i++) {
+    bi.iOrigin[i]  = b[i] * step[i];
+    bi.iVoxels[i]  = vc[i];
+    bi.iOverlap[i] = ov[i];
+    bi.iSize[i]    = vc[i] - 2*ov[i];
+  }
+  return bi;
+}
+
+BrickRow::BrickRow(const UVFDataset& ds, size_t iLOD, uint64_t iBytesPerVoxel,
+                   const uint64_t iMin[3], const uint64_t iMax[3]) :
+  m_DS(ds),
+  m_iLOD(iLOD),
+  m_iBytesPerVoxel(iBytesPerVoxel)
+{
+  const UINTVECTOR3 layout  = ds.GetBrickLayout(iLOD, 0);
+  const UINTVECTOR3 overlap = ds.GetBrickOverlapSize();
+  const UINTVECTOR3 maxSize = ds.GetMaxBrickSize();
+  const uint64_t l[3] = {layout.x, layout.y, layout.z};
+  const uint64_t step[3] = { maxSize.x - 2*overlap.x,
+                             maxSize.y - 2*overlap.y,
+                             maxSize.z - 2*overlap.z };
+  for (int i = 0;i<3;i++) {
+    m_iMin[i] = iMin[i];
+    m_iMax[i] = iMax[i];
+    m_iLayout[i] = l[i];
+    m_iFirst[i] = iMin[i] / step[i];
+    m_iRows[i] = iMax[i] > iMin[i] ? (iMax[i]-1) / step[i] + 1 - m_iFirst[i] : 0;
+  }
+}
+
+bool BrickRow::Read(size_t iRow, uint64_t iOrigin[3], uint64_t iSize[3])
+{
+  const uint64_t by = m_iFirst[1] + iRow % m_iRows[1];
+  const uint64_t bz = m_iFirst[2] + iRow / m_iRows[1];
+  const size_t iFirst = size_t((bz*m_iLayout[1] + by)*m_iLayout[0] + m_iFirst[0]);
+  const uint64_t bpv = m_iBytesPerVoxel;
+
+  // y and z extent are shared by the whole row
+  const BrickInterior first = GetBrickInterior(m_DS, m_iLOD, iFirst);
+  uint64_t lo[3], hi[3];
+  for (int i = 1;i<3;i++) {
+    lo[i] = std::max(first.iOrigin[i], m_iMin[i]);
+    hi[i] = std::min(first.iOrigin[i] + first.iSize[i], m_iMax[i]);
+  }
+  iOrigin[0] = 0;
+  iOrigin[1] = lo[1] - m_iMin[1];
+  iOrigin[2] = lo[2] - m_iMin[2];
+  iSize[0] = m_iMax[0] - m_iMin[0];
+  iSize[1] = hi[1] - lo[1];
+  iSize[2] = hi[2] - lo[2];
+  m_Row.resize(size_t(iSize[0] * iSize[1] * iSize[2] * bpv));
+
+  for (size_t iBrick = iFirst;iBrick<iFirst+m_iRows[0];iBrick++) {
+    if (!m_DS.GetBrick(BrickKey(0, m_iLOD, iBrick), m_Brick)) {
+      T_ERROR("Could not read brick %u of LOD %u", unsigned(iBrick),
+              unsigned(m_iLOD));
+      return false;
+    }
+
+    const BrickInterior bi = GetBrickInterior(m_DS, m_iLOD, iBrick);
+    lo[0] = std::max(bi.iOrigin[0], m_iMin[0]);
+    hi[0] = std::min(bi.iOrigin[0] + bi.iSize[0], m_iMax[0]);
+    for (uint64_t z = lo[2];z<hi[2];z++) {
+      for (uint64_t y = lo[1];y<hi[1];y++) {
+        const uint64_t dst = ((z-lo[2])*iSize[1] + y-lo[1])*iSize[0] +
+                             lo[0]-m_iMin[0];
+        const uint64_t src = bi.BrickIndex(lo[0]-bi.iOrigin[0],
+                                           y-bi.iOrigin[1], z-bi.iOrigin[2]);
+        memcpy(&m_Row[size_t(dst*bpv)], &m_Brick[size_t(src*bpv)],
+               size_t((hi[0]-lo[0])*bpv));
+      }
+    }
+  }
+  return true;
+}
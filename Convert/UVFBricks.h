@@ -0,0 +1,111 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    UVFBricks.h
+  \brief   Brick access helpers shared by the streaming UVF readers.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef UVFBRICKS_H
+#define UVFBRICKS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+namespace tuvok {
+  class Dataset;
+  class IOManager;
+  class UVFDataset;
+}
+
+/// Opens strFilename iCount times.  The UVF reader seeks and reads on one
+/// file handle per dataset, so concurrent workers each need their own.
+/// Fails if the file is not a UVF.
+bool OpenUVFPerWorker(const tuvok::IOManager& ioMan,
+                      const std::string& strFilename, size_t iCount,
+                      std::vector<std::unique_ptr<tuvok::Dataset>>& datasets);
+
+/// Where the interior of a brick, i.e. the brick without its overlap,
+/// lies in the volume of its LOD.
+struct BrickInterior {
+  uint64_t iOrigin[3];
+  uint64_t iSize[3];
+  uint64_t iVoxels[3];   // brick size including overlap
+  uint64_t iOverlap[3];  // per side
+
+  uint64_t InteriorCount() const {return iSize[0]*iSize[1]*iSize[2];}
+  /// Index into the brick data of interior voxel (x,y,z).
+  uint64_t BrickIndex(uint64_t x, uint64_t y, uint64_t z) const {
+    return ((z+iOverlap[2])*iVoxels[1] + y+iOverlap[1])*iVoxels[0] +
+           x+iOverlap[0];
+  }
+};
+
+/// Geometry of brick iBrick of the given LOD, timestep 0.  Bricks are
+/// numbered x fastest over the LOD's brick layout.
+BrickInterior GetBrickInterior(const tuvok::UVFDataset& ds, size_t iLOD,
+                               size_t iBrick);
+
+/// Gathers the bricks of a LOD that intersect a voxel region [iMin, iMax),
+/// one row of bricks (fixed y and z brick index) at a time, into a buffer
+/// holding the matching part of the region, x fastest.  Whole rows keep
+/// the writes that follow long and sequential.
+class BrickRow {
+  public:
+    BrickRow(const tuvok::UVFDataset& ds, size_t iLOD, uint64_t iBytesPerVoxel,
+             const uint64_t iMin[3], const uint64_t iMax[3]);
+
+    /// Rows of bricks intersecting the region.
+    size_t RowCount() const {return size_t(m_iRows[1]*m_iRows[2]);}
+
+    /// Reads a row; iOrigin, relative to the region, and iSize receive the
+    /// box it covers.
+    bool Read(size_t iRow, uint64_t iOrigin[3], uint64_t iSize[3]);
+
+    const std::vector<uint8_t>& Data() const {return m_Row;}
+
+  private:
+    const tuvok::UVFDataset& m_DS;
+    size_t               m_iLOD;
+    uint64_t             m_iBytesPerVoxel;
+    uint64_t             m_iMin[3];
+    uint64_t             m_iMax[3];
+    uint64_t             m_iLayout[3];
+    uint64_t             m_iFirst[3];  // first brick index in the region
+    uint64_t             m_iRows[3];   // bricks in the region per axis
+    std::vector<uint8_t> m_Brick;
+    std::vector<uint8_t> m_Row;
+};
+
+#endif // UVFBRICKS_H
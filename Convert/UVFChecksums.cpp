@@ -0,0 +1,315 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    UVFChecksums.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "UVFChecksums.h"
+#include "UVFBricks.h"
+#include "../DebugOut/ProfileOut.h"
+#include "../Util/MemoryGovernor.h"
+#include "../Util/ProcessStats.h"
+#include "../Util/WorkerPool.h"
+#include "../Util/XXHash.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <IO/IOManager.h>
+#include <IO/uvfDataset.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+namespace {
+  const char* const MAGIC = "uvf-checksums xxh64 1";
+
+  struct BrickSum {
+    uint32_t iLOD;
+    uint32_t iBrick[3];
+    uint64_t iIndex;   // x fastest within the LOD
+    uint64_t iHash;
+  };
+
+  struct Checksums {
+    Checksums() : iFileBytes(0), iChunkBytes(0) {}
+
+    uint64_t              iFileBytes;
+    uint64_t              iChunkBytes;
+    std::vector<uint64_t> vChunks;
+    std::vector<BrickSum> vBricks;  // finest LOD first, then by index
+  };
+
+  std::string Hex(uint64_t i) {
+    std::ostringstream s;
+    s << std::hex << std::setw(16) << std::setfill('0') << i;
+    return s.str();
+  }
+
+  bool Load(const std::string& strFilename, Checksums& sums)
+  {
+    std::ifstream in(strFilename.c_str());
+    std::string line;
+    if (!std::getline(in, line) || line != MAGIC) return false;
+    std::string strKey;
+    if (!(in >> strKey >> sums.iFileBytes) || strKey != "size") return false;
+    if (!(in >> strKey >> sums.iChunkBytes) || strKey != "chunk" ||
+        sums.iChunkBytes == 0) {
+      return false;
+    }
+    while (in >> strKey) {
+      if (strKey == "c") {
+        uint64_t iHash;
+        if (!(in >> std::hex >> iHash >> std::dec)) return false;
+        sums.vChunks.push_back(iHash);
+      } else if (strKey == "b") {
+        BrickSum b;
+        if (!(in >> b.iLOD >> b.iBrick[0] >> b.iBrick[1] >> b.iBrick[2] >>
+              b.iIndex >> std::hex >> b.iHash >> std::dec)) {
+          return false;
+        }
+        sums.vBricks.push_back(b);
+      } else {
+        return false;
+      }
+    }
+    return sums.vChunks.size() ==
+           (sums.iFileBytes + sums.iChunkBytes - 1) / sums.iChunkBytes;
+  }
+
+  /// Every brick of every LOD of ds, finest first, hashes not filled in.
+  std::vector<BrickSum> ListBricks(const UVFDataset& ds)
+  {
+    std::vector<BrickSum> vBricks;
+    for (size_t iLOD = 0;iLOD<ds.GetLODLevelCount();iLOD++) {
+      const UINTVECTOR3 layout = ds.GetBrickLayout(iLOD, 0);
+      const uint64_t iCount = uint64_t(layout.x) * layout.y * layout.z;
+      for (uint64_t i = 0;i<iCount;i++) {
+        BrickSum b;
+        b.iLOD = uint32_t(iLOD);
+        b.iBrick[0] = uint32_t(i % layout.x);
+        b.iBrick[1] = uint32_t(i / layout.x % layout.y);
+        b.iBrick[2] = uint32_t(i / layout.x / layout.y);
+        b.iIndex = i;
+        b.iHash = 0;
+        vBricks.push_back(b);
+      }
+    }
+    return vBricks;
+  }
+
+  /// Decodes and hashes the given bricks on iWorkers threads; returns
+  /// false if a brick cannot be read, whose hash then stays 0.
+  bool HashBricks(const IOManager& ioMan, const std::string& strUVF,
+                  size_t iWorkers, std::vector<BrickSum>& vBricks)
+  {
+    WorkerPool pool(iWorkers);
+    std::vector<std::unique_ptr<Dataset>> datasets;
+    if (!OpenUVFPerWorker(ioMan, strUVF, pool.GetWorkerCount(), datasets)) {
+      return false;
+    }
+    std::vector<std::vector<uint8_t>> scratch(pool.GetWorkerCount());
+    std::atomic<bool> bOk(true);
+    pool.Run(vBricks.size(), [&](size_t i, size_t iWorker) {
+      BrickSum& b = vBricks[i];
+      std::vector<uint8_t>& brick = scratch[iWorker];
+      brick.clear();
+      if (!datasets[iWorker]->GetBrick(BrickKey(0, b.iLOD, size_t(b.iIndex)),
+                                       brick)) {
+        bOk = false;
+        return;
+      }
+      b.iHash = XXHash64(brick.empty() ? NULL : &brick[0], brick.size());
+    });
+    return bOk;
+  }
+
+  /// Hashes strUVF in chunks of iChunkBytes with large sequential reads on
+  /// up to iWorkers threads, as many as the memory governor grants a
+  /// chunk buffer to.
+  bool HashChunks(const std::string& strUVF, uint64_t iFileBytes,
+                  uint64_t iChunkBytes, size_t iWorkers,
+                  std::vector<uint64_t>& vChunks)
+  {
+    const size_t iChunks = size_t((iFileBytes + iChunkBytes - 1) / iChunkBytes);
+    vChunks.assign(iChunks, 0);
+    const MemoryReservation memory(iChunkBytes * iWorkers, iChunkBytes);
+    WorkerPool pool(std::max<size_t>(1, std::min<size_t>(iWorkers,
+                    size_t(memory.GetBytes() / iChunkBytes))));
+    std::vector<std::vector<char>> buffers(pool.GetWorkerCount());
+    std::atomic<bool> bOk(true);
+    pool.Run(iChunks, [&](size_t i, size_t iWorker) {
+      std::vector<char>& buffer = buffers[iWorker];
+      const uint64_t iOffset = uint64_t(i) * iChunkBytes;
+      buffer.resize(size_t(std::min(iChunkBytes, iFileBytes - iOffset)));
+      std::ifstream in(strUVF.c_str(), std::ios::binary);
+      in.seekg(std::streamoff(iOffset));
+      if (!in.read(&buffer[0], std::streamsize(buffer.size()))) {
+        bOk = false;
+        return;
+      }
+      vChunks[i] = XXHash64(&buffer[0], buffer.size());
+    });
+    return bOk;
+  }
+}
+
+std::string ChecksumFilename(const std::string& strUVF)
+{
+  return strUVF + ".xxh";
+}
+
+bool WriteUVFChecksums(const IOManager& ioMan, const std::string& strUVF,
+                       size_t iWorkers, uint64_t iChunkBytes)
+{
+  ProfileScope stage("Checksums");
+  Checksums sums;
+  sums.iFileBytes = ProcessStats::FileSize(strUVF);
+  sums.iChunkBytes = iChunkBytes;
+  {
+    std::unique_ptr<Dataset> ds(ioMan.CreateDataset(strUVF, 256, false));
+    const UVFDataset* uvf = dynamic_cast<const UVFDataset*>(ds.get());
+    if (!uvf) {
+      T_ERROR("'%s' is not a UVF file", strUVF.c_str());
+      return false;
+    }
+    sums.vBricks = ListBricks(*uvf);
+  }
+  if (!HashChunks(strUVF, sums.iFileBytes, iChunkBytes, iWorkers, sums.vChunks) ||
+      !HashBricks(ioMan, strUVF, iWorkers, sums.vBricks)) {
+    T_ERROR("Could not read '%s' to checksum it", strUVF.c_str());
+    return false;
+  }
+
+  // written aside and renamed, so a checksum file is always complete
+  const std::string strFilename = ChecksumFilename(strUVF);
+  const std::string strTemp = strFilename + ".tmp";
+  {
+    std::ofstream out(strTemp.c_str(), std::ios::trunc);
+    out << MAGIC << "\nsize " << sums.iFileBytes << "\nchunk "
+        << sums.iChunkBytes << "\n";
+    for (size_t i = 0;i<sums.vChunks.size();i++) {
+      out << "c " << Hex(sums.vChunks[i]) << "\n";
+    }
+    for (auto b = sums.vBricks.cbegin(); b != sums.vBricks.cend(); ++b) {
+      out << "b " << b->iLOD << " " << b->iBrick[0] << " " << b->iBrick[1]
+          << " " << b->iBrick[2] << " " << b->iIndex << " " << Hex(b->iHash)
+          << "\n";
+    }
+    if (!out.flush()) {
+      out.close();
+      std::remove(strTemp.c_str());
+      T_ERROR("Could not write '%s'", strFilename.c_str());
+      return false;
+    }
+  }
+  std::remove(strFilename.c_str());
+  if (std::rename(strTemp.c_str(), strFilename.c_str()) != 0) {
+    std::remove(strTemp.c_str());
+    T_ERROR("Could not write '%s'", strFilename.c_str());
+    return false;
+  }
+  stage.SetBytes(sums.iFileBytes, ProcessStats::FileSize(strFilename));
+  return true;
+}
+
+VerifyReport VerifyUVF(const IOManager& ioMan, const std::string& strUVF,
+                       size_t iWorkers)
+{
+  ProfileScope stage("Verify");
+  const std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  VerifyReport report;
+  Checksums sums;
+  if (!Load(ChecksumFilename(strUVF), sums)) {
+    report.strError = "no valid checksum file '" + ChecksumFilename(strUVF) + "'";
+    return report;
+  }
+  report.bChecked = true;
+
+  const uint64_t iFileBytes = ProcessStats::FileSize(strUVF);
+  std::vector<uint64_t> vChunks;
+  if (iFileBytes != sums.iFileBytes) {
+    std::ostringstream s;
+    s << "the file has " << iFileBytes << " bytes, " << sums.iFileBytes
+      << " were checksummed";
+    report.strError = s.str();
+    report.iBadOffset = std::min(iFileBytes, sums.iFileBytes);
+  } else if (!HashChunks(strUVF, iFileBytes, sums.iChunkBytes, iWorkers,
+                         vChunks)) {
+    report.strError = "the file cannot be read";
+  } else {
+    report.iBytes = iFileBytes;
+    size_t i = 0;
+    while (i<vChunks.size() && vChunks[i] == sums.vChunks[i]) i++;
+    if (i == vChunks.size()) {
+      report.bOk = true;
+    } else {
+      report.iBadOffset = uint64_t(i) * sums.iChunkBytes;
+      std::ostringstream s;
+      s << "the data at byte " << report.iBadOffset << " differs";
+      report.strError = s.str();
+    }
+  }
+
+  if (!report.bOk && !sums.vBricks.empty()) {
+    // locate the damage: decode the bricks, a failed read counts as corrupt
+    std::vector<BrickSum> vBricks = sums.vBricks;
+    for (size_t i = 0;i<vBricks.size();i++) vBricks[i].iHash = 0;
+    HashBricks(ioMan, strUVF, iWorkers, vBricks);
+    report.iBricks = vBricks.size();
+    for (size_t i = 0;i<vBricks.size();i++) {
+      if (vBricks[i].iHash != sums.vBricks[i].iHash) {
+        report.bBrickFound = true;
+        report.iLOD = vBricks[i].iLOD;
+        for (int a = 0;a<3;a++) report.iBrick[a] = vBricks[i].iBrick[a];
+        break;
+      }
+    }
+  }
+  report.fSeconds = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+  stage.SetBytes(report.iBytes, 0);
+  return report;
+}
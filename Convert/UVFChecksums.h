@@ -0,0 +1,86 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    UVFChecksums.h
+  \brief   Per-brick checksums of a UVF, kept in a file next to it, and
+           their parallel verification.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef UVFCHECKSUMS_H
+#define UVFCHECKSUMS_H
+
+#include <string>
+#include <StdTuvokDefines.h>
+
+namespace tuvok {
+  class IOManager;
+}
+
+/// Checksum file of a UVF: "<file>.xxh" next to it.
+std::string ChecksumFilename(const std::string& strUVF);
+
+/// Writes the checksum file of strUVF.  It holds the xxHash64 of every
+/// brick of every LOD as decoded, and of the file itself in chunks of
+/// iChunkBytes.  Bricks are hashed on iWorkers threads, each with its own
+/// handle on the file.
+bool WriteUVFChecksums(const tuvok::IOManager& ioMan,
+                       const std::string& strUVF, size_t iWorkers,
+                       uint64_t iChunkBytes = 16*1024*1024);
+
+struct VerifyReport {
+  VerifyReport() : bOk(false), bChecked(false), iBytes(0), iBricks(0),
+    bBrickFound(false), iLOD(0), iBadOffset(0), fSeconds(0.0) {
+    iBrick[0] = iBrick[1] = iBrick[2] = 0;
+  }
+
+  bool        bOk;
+  bool        bChecked;     ///< false if there was nothing to compare to
+  std::string strError;
+  uint64_t    iBytes;       ///< read in the chunk pass
+  uint64_t    iBricks;      ///< decoded in the brick pass, 0 if not needed
+  bool        bBrickFound;  ///< a corrupt brick was located
+  uint32_t    iLOD;         ///< of the first corrupt brick
+  uint32_t    iBrick[3];    ///< its position within the LOD's bricks
+  uint64_t    iBadOffset;   ///< start of the first chunk that differs
+  double      fSeconds;
+};
+
+/// Checks strUVF against its checksum file.  The file is first read in
+/// large sequential chunks on iWorkers threads and compared chunk by
+/// chunk, which runs at about disk bandwidth.  Only if a chunk differs
+/// are the bricks decoded and compared, to find the first corrupt one,
+/// finest LOD first.  Corruption outside the bricks, e.g. in the header,
+/// is reported by its offset alone.
+VerifyReport VerifyUVF(const tuvok::IOManager& ioMan,
+                       const std::string& strUVF, size_t iWorkers);
+
+#endif // UVFCHECKSUMS_H
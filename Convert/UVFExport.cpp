@@ -0,0 +1,173 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    UVFExport.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+
+#include "UVFExport.h"
+#include "RawStaging.h"
+#include "UVFBricks.h"
+#include "../DebugOut/ProfileOut.h"
+#include "../Util/MemoryGovernor.h"
+#include "../Util/WorkerPool.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <Basics/SysTools.h>
+#include <IO/IOManager.h>
+#include <IO/uvfDataset.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+bool ExportUVF(const IOManager& ioMan,
+               const std::string& strSource,
+               const std::string& strTarget,
+               const std::string& strTempDir,
+               size_t iLOD, const std::vector<uint64_t>& vRegion,
+               uint64_t iBrickSize, uint64_t iBrickOverlap,
+               size_t iWorkers)
+{
+  WorkerPool pool(iWorkers);
+  std::vector<std::unique_ptr<Dataset>> sources;
+  if (!OpenUVFPerWorker(ioMan, strSource, pool.GetWorkerCount(), sources)) {
+    return false;
+  }
+  const UVFDataset& first = dynamic_cast<const UVFDataset&>(*sources[0]);
+  if (iLOD >= first.GetLODLevelCount()) {
+    T_ERROR("'%s' has %u LODs, there is no LOD %u", strSource.c_str(),
+            unsigned(first.GetLODLevelCount()), unsigned(iLOD));
+    return false;
+  }
+
+  // the region in voxels of the LOD, rounded outwards
+  RawVolumeInfo info(first);
+  const UINT64VECTOR3 full = first.GetDomainSize(0, 0);
+  const UINT64VECTOR3 domain = first.GetDomainSize(iLOD, 0);
+  const uint64_t iFull[3] = {full.x, full.y, full.z};
+  const uint64_t iDomain[3] = {domain.x, domain.y, domain.z};
+  uint64_t iMin[3], iMax[3];
+  for (int i = 0;i<3;i++) {
+    iMin[i] = 0;
+    iMax[i] = iDomain[i];
+    if (!vRegion.empty()) {
+      iMin[i] = std::min(iDomain[i], vRegion[i] * iDomain[i] / iFull[i]);
+      iMax[i] = std::min(iDomain[i], (vRegion[i+3] * iDomain[i] + iFull[i]-1) /
+                                     iFull[i]);
+    }
+    if (iMax[i] <= iMin[i]) {
+      T_ERROR("The export region does not intersect the volume");
+      return false;
+    }
+    info.iSize[i] = iMax[i] - iMin[i];
+    info.fAspect[i] *= double(iFull[i]) / double(iDomain[i]);
+  }
+  MESSAGE("Exporting %ux%ux%u voxels of LOD %u",
+          unsigned(info.iSize[0]), unsigned(info.iSize[1]),
+          unsigned(info.iSize[2]), unsigned(iLOD));
+
+  const std::string strExt = SysTools::ToLowerCase(SysTools::GetExt(strTarget));
+  const bool bNative = strExt == "raw" || strExt == "nhdr";
+  const std::string strRaw =
+    strExt == "raw"  ? strTarget :
+    strExt == "nhdr" ? SysTools::ChangeExt(strTarget, "raw") :
+                       StagingFilename(strTarget, strTempDir);
+  const std::string strHeader =
+    strExt == "nhdr" ? strTarget : SysTools::ChangeExt(strRaw, "nhdr");
+
+  // every worker holds a brick and a row of bricks cropped to the region;
+  // when the memory budget is tight fewer of them run
+  const UINTVECTOR3 maxBrick = first.GetMaxBrickSize();
+  const uint64_t iPerWorker =
+    (uint64_t(maxBrick.x) + info.iSize[0]) * maxBrick.y * maxBrick.z *
+    info.BytesPerVoxel();
+  const MemoryReservation memory(iPerWorker * sources.size(), iPerWorker);
+  if (memory.GetBytes() / iPerWorker < sources.size()) {
+    MESSAGE("Memory budget limits the export to %u of %u workers",
+            unsigned(memory.GetBytes() / iPerWorker), unsigned(sources.size()));
+    sources.resize(size_t(memory.GetBytes() / iPerWorker));
+  }
+  {
+    ProfileScope stage("ExportBricks");
+    RawStagingFile raw(strRaw, info);
+    if (!raw.IsOpen()) return false;
+
+    std::vector<std::unique_ptr<BrickRow>> rows(sources.size());
+    for (size_t w = 0;w<rows.size();w++) {
+      rows[w].reset(new BrickRow(dynamic_cast<const UVFDataset&>(*sources[w]),
+                                 iLOD, info.BytesPerVoxel(), iMin, iMax));
+    }
+
+    std::atomic<bool> bOk(true);
+    const size_t iRows = rows[0]->RowCount();
+    const WorkerPool workers(sources.size());
+    workers.Run(iRows, [&](size_t iRow, size_t worker) {
+      if (!bOk) return;
+      uint64_t iOrigin[3], iSize[3];
+      if (!rows[worker]->Read(iRow, iOrigin, iSize)) {
+        bOk = false;
+        raw.Abort();
+        return;
+      }
+      if (!raw.WriteBox(iRow, iOrigin, iSize, &rows[worker]->Data()[0])) {
+        bOk = false;
+        return;
+      }
+      MESSAGE("Exported row %u of %u", unsigned(iRow+1), unsigned(iRows));
+    });
+
+    if (!raw.Close() || !bOk) {
+      std::remove(strRaw.c_str());
+      return false;
+    }
+    stage.SetBytes(info.Bytes(), info.Bytes());
+  }
+  sources.clear();
+
+  if (!WriteNRRDHeader(strHeader, strRaw, info)) return false;
+  if (bNative) return true;
+
+  ProfileScope stage("ConvertExport");
+  const bool bOk = ioMan.ConvertDataset(strHeader, strTarget, strTempDir, true,
+                                        iBrickSize, iBrickOverlap);
+  std::remove(strHeader.c_str());
+  std::remove(strRaw.c_str());
+  return bOk;
+}
@@ -0,0 +1,70 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    UVFExport.h
+  \brief   Streams one LOD of a UVF, or a region of it, into another
+           volume format.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef UVFEXPORT_H
+#define UVFEXPORT_H
+
+#include <string>
+#include <vector>
+#include <StdTuvokDefines.h>
+
+namespace tuvok {
+  class IOManager;
+}
+
+/// Exports LOD iLOD of strSource to strTarget.  Only the bricks that
+/// intersect vRegion are read; iWorkers threads read and decompress them,
+/// and the staging writer puts them on disk in output order, a row of
+/// bricks at a time.
+///
+/// vRegion is empty for the whole volume or holds x0,y0,z0,x1,y1,z1 in
+/// LOD 0 voxels, upper bounds exclusive.  It is scaled to the LOD, so the
+/// same region can be previewed at any resolution.
+///
+/// .nhdr targets get their raw data next to them and .raw targets a .nhdr
+/// next to them.  Other formats are staged as raw in strTempDir and
+/// converted by ioMan, using iBrickSize and iBrickOverlap for the
+/// intermediate UVF it may need.
+bool ExportUVF(const tuvok::IOManager& ioMan,
+               const std::string& strSource,
+               const std::string& strTarget,
+               const std::string& strTempDir,
+               size_t iLOD, const std::vector<uint64_t>& vRegion,
+               uint64_t iBrickSize, uint64_t iBrickOverlap,
+               size_t iWorkers);
+
+#endif // UVFEXPORT_H
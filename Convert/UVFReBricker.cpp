@@ -0,0 +1,179 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    UVFReBricker.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "UVFReBricker.h"
+#include "Quantizer.h"
+#include "RawStaging.h"
+#include "UVFBricks.h"
+#include "../DebugOut/ProfileOut.h"
+#include "../Util/Journal.h"
+#include "../Util/MemoryGovernor.h"
+#include "../Util/WorkerPool.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+
+#include <Controller/Controller.h>
+#include <Basics/SysTools.h>
+#include <IO/IOManager.h>
+#include <IO/uvfDataset.h>
+
+#pragma GCC diagnostic pop
+
+using namespace tuvok;
+
+bool ReBrickUVF(const IOManager& ioMan,
+                const std::string& strSource,
+                const std::string& strTarget,
+                const std::string& strTempDir,
+                uint64_t iBrickSize, uint64_t iBrickOverlap,
+                size_t iWorkers, unsigned iQuantizeBits,
+                Journal* pJournal)
+{
+  WorkerPool pool(iWorkers);
+  std::vector<std::unique_ptr<Dataset>> sources;
+  if (!OpenUVFPerWorker(ioMan, strSource, pool.GetWorkerCount(), sources)) {
+    return false;
+  }
+  const UVFDataset& first = dynamic_cast<const UVFDataset&>(*sources[0]);
+  if (first.GetNumberOfTimesteps() > 1) {
+    WARNING("Source has %u timesteps, only the first one is re-bricked",
+            unsigned(first.GetNumberOfTimesteps()));
+  }
+
+  const RawVolumeInfo source(first);
+  std::unique_ptr<Quantizer> quantizer;
+  if (iQuantizeBits != 0) {
+    if (Quantizer::IsUseful(source, iQuantizeBits)) {
+      const std::pair<double, double> range = first.GetRange();
+      if (!Quantizer::IsValidRange(range.first, range.second)) {
+        T_ERROR("Cannot quantize '%s', its value range [%g, %g] is not finite",
+                strSource.c_str(), range.first, range.second);
+        return false;
+      }
+      MESSAGE("Quantizing [%g, %g] to %u bits", range.first, range.second,
+              iQuantizeBits);
+      quantizer.reset(new Quantizer(source, range.first, range.second,
+                                    iQuantizeBits));
+    } else {
+      WARNING("Source already fits %u bits, it is not quantized",
+              iQuantizeBits);
+    }
+  }
+  const RawVolumeInfo info = quantizer ? quantizer->GetTargetInfo() : source;
+
+  // every worker holds a brick, a row of bricks and its quantized copy;
+  // when the memory budget is tight fewer of them run
+  const UINTVECTOR3 maxBrick = first.GetMaxBrickSize();
+  const uint64_t iRowVoxels = source.iSize[0] * maxBrick.y * maxBrick.z;
+  const uint64_t iPerWorker =
+    uint64_t(maxBrick.x) * maxBrick.y * maxBrick.z * source.BytesPerVoxel() +
+    iRowVoxels * (source.BytesPerVoxel() + (quantizer ? info.BytesPerVoxel() : 0));
+  const MemoryReservation memory(iPerWorker * sources.size(), iPerWorker);
+  if (memory.GetBytes() / iPerWorker < sources.size()) {
+    MESSAGE("Memory budget limits re-bricking to %u of %u workers",
+            unsigned(memory.GetBytes() / iPerWorker), unsigned(sources.size()));
+    sources.resize(size_t(memory.GetBytes() / iPerWorker));
+  }
+
+  const std::string strRaw = StagingFilename(strTarget, strTempDir, !pJournal);
+  const uint64_t iStaged = StagedBoxes(pJournal, strRaw);
+  {
+    ProfileScope stage("StageBricks");
+    RawStagingFile raw(strRaw, info, iStaged);
+    if (!raw.IsOpen()) return false;
+    JournalStaging(pJournal, raw);
+
+    const uint64_t iMin[3] = {0, 0, 0};
+    std::vector<std::unique_ptr<BrickRow>> rows(sources.size());
+    for (size_t w = 0;w<rows.size();w++) {
+      rows[w].reset(new BrickRow(dynamic_cast<const UVFDataset&>(*sources[w]),
+                                 0, source.BytesPerVoxel(), iMin, source.iSize));
+    }
+    // per worker quantized row and kernel registers
+    std::vector<std::vector<uint8_t>> quantized(rows.size());
+    std::vector<std::vector<uint8_t>> registers(rows.size());
+
+    std::atomic<bool> bOk(true);
+    const size_t iRows = rows[0]->RowCount();
+    const WorkerPool workers(sources.size());
+    workers.Run(iRows - std::min<size_t>(iRows, size_t(iStaged)),
+             [&](size_t i, size_t worker) {
+      const size_t iRow = size_t(iStaged) + i;
+      uint64_t iOrigin[3], iSize[3];
+      if (!rows[worker]->Read(iRow, iOrigin, iSize)) {
+        bOk = false;
+        raw.Abort();
+        return;
+      }
+      const uint8_t* pRow = &rows[worker]->Data()[0];
+      if (quantizer) {
+        const size_t iVoxels = size_t(iSize[0]*iSize[1]*iSize[2]);
+        quantized[worker].resize(size_t(iVoxels * info.BytesPerVoxel()));
+        quantizer->Remap(pRow, iVoxels, &quantized[worker][0],
+                         registers[worker]);
+        pRow = &quantized[worker][0];
+      }
+      if (!raw.WriteBox(iRow, iOrigin, iSize, pRow)) {
+        bOk = false;
+        return;
+      }
+      MESSAGE("Re-bricking row %u of %u", unsigned(iRow+1), unsigned(iRows));
+    });
+
+    if (!raw.Close() || !bOk) {
+      // a journaled staging file is kept for the next attempt
+      if (!pJournal) std::remove(strRaw.c_str());
+      return false;
+    }
+    JournalStagingDone(pJournal, iRows);
+    stage.SetBytes(source.Bytes(), info.Bytes());
+  }
+  sources.clear();
+
+  if (!BuildUVFFromRaw(ioMan, strRaw, info, strTarget, strTempDir,
+                       iBrickSize, iBrickOverlap, pJournal != NULL)) {
+    return false;
+  }
+  if (pJournal) pJournal->Remove();
+  return true;
+}
@@ -0,0 +1,72 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    UVFReBricker.h
+  \brief   Re-bricks an existing UVF without exporting it through another
+           volume format first.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef UVFREBRICKER_H
+#define UVFREBRICKER_H
+
+#include <string>
+#include <StdTuvokDefines.h>
+
+class Journal;
+
+namespace tuvok {
+  class IOManager;
+}
+
+/// Streams the LOD 0 bricks of strSource, strips their overlap and writes
+/// the result row of bricks by row of bricks into a single raw file in
+/// strTempDir.  That file is then bricked into strTarget using the brick
+/// size, overlap, compression and layout configured on ioMan.  At most
+/// iWorkers rows of bricks are held in memory at any time.
+///
+/// With iQuantizeBits set, the value range recorded in the source is
+/// mapped onto [0, 2^iQuantizeBits-1] while the rows are staged, so the
+/// quantized volume costs no extra pass over the data.
+///
+/// With a journal, staging progress is recorded in it and a run with the
+/// same journal continues from the last recorded row; the journal is
+/// removed once strTarget is complete.
+bool ReBrickUVF(const tuvok::IOManager& ioMan,
+                const std::string& strSource,
+                const std::string& strTarget,
+                const std::string& strTempDir,
+                uint64_t iBrickSize, uint64_t iBrickOverlap,
+                size_t iWorkers, unsigned iQuantizeBits = 0,
+                Journal* pJournal = NULL);
+
+#endif // UVFREBRICKER_H
@@ -0,0 +1,163 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    VoxelType.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "VoxelType.h"
+#include "RawStaging.h"
+
+VoxelType GetVoxelType(const RawVolumeInfo& info)
+{
+  if (info.bFloat) {
+    switch (info.iBitWidth) {
+      case 32: return VT_FLOAT;
+      case 64: return VT_DOUBLE;
+      default: return VT_UNSUPPORTED;
+    }
+  }
+  switch (info.iBitWidth) {
+    case 8:  return info.bSigned ? VT_INT8  : VT_UINT8;
+    case 16: return info.bSigned ? VT_INT16 : VT_UINT16;
+    case 32: return info.bSigned ? VT_INT32 : VT_UINT32;
+    default: return VT_UNSUPPORTED;
+  }
+}
+
+size_t GetVoxelTypeSize(VoxelType t)
+{
+  switch (t) {
+    case VT_UINT8:  case VT_INT8:  return 1;
+    case VT_UINT16: case VT_INT16: return 2;
+    case VT_UINT32: case VT_INT32: case VT_FLOAT: return 4;
+    case VT_DOUBLE: return 8;
+    default: return 0;
+  }
+}
+
+namespace {
+  template<typename T> void Load(const uint8_t* src, double* dst, size_t n) {
+    // memcpy per voxel keeps this legal for unaligned brick buffers
+    for (size_t i = 0;i<n;i++) {
+      T t;
+      memcpy(&t, src + i*sizeof(T), sizeof(T));
+      dst[i] = double(t);
+    }
+  }
+
+  template<typename T> void Store(const double* src, uint8_t* dst, size_t n) {
+    const double lo = double(std::numeric_limits<T>::lowest());
+    const double hi = double(std::numeric_limits<T>::max());
+    for (size_t i = 0;i<n;i++) {
+      T t;
+      if (std::numeric_limits<T>::is_integer) {
+        // NaN compares false everywhere and ends up as the lower bound
+        const double v = std::floor(src[i] + 0.5);
+        t = T(v >= lo ? std::min(v, hi) : lo);
+      } else {
+        t = T(src[i]);
+      }
+      memcpy(dst + i*sizeof(T), &t, sizeof(T));
+    }
+  }
+
+  template<typename T> void Range(const uint8_t* src, size_t n,
+                                  double& fMin, double& fMax) {
+    T lo = std::numeric_limits<T>::max();
+    T hi = std::numeric_limits<T>::lowest();
+    bool bAny = false;
+    for (size_t i = 0;i<n;i++) {
+      T t;
+      memcpy(&t, src + i*sizeof(T), sizeof(T));
+      if (!std::numeric_limits<T>::is_integer && !std::isfinite(double(t))) {
+        continue;
+      }
+      lo = std::min(lo, t);
+      hi = std::max(hi, t);
+      bAny = true;
+    }
+    if (!bAny) return;
+    fMin = std::min(fMin, double(lo));
+    fMax = std::max(fMax, double(hi));
+  }
+}
+
+void LoadAsDouble(VoxelType t, const uint8_t* src, double* dst, size_t iCount)
+{
+  switch (t) {
+    case VT_UINT8:  Load<uint8_t>(src, dst, iCount);  break;
+    case VT_INT8:   Load<int8_t>(src, dst, iCount);   break;
+    case VT_UINT16: Load<uint16_t>(src, dst, iCount); break;
+    case VT_INT16:  Load<int16_t>(src, dst, iCount);  break;
+    case VT_UINT32: Load<uint32_t>(src, dst, iCount); break;
+    case VT_INT32:  Load<int32_t>(src, dst, iCount);  break;
+    case VT_FLOAT:  Load<float>(src, dst, iCount);    break;
+    case VT_DOUBLE: Load<double>(src, dst, iCount);   break;
+    default: std::fill(dst, dst+iCount, 0.0);         break;
+  }
+}
+
+void StoreFromDouble(VoxelType t, const double* src, uint8_t* dst,
+                     size_t iCount)
+{
+  switch (t) {
+    case VT_UINT8:  Store<uint8_t>(src, dst, iCount);  break;
+    case VT_INT8:   Store<int8_t>(src, dst, iCount);   break;
+    case VT_UINT16: Store<uint16_t>(src, dst, iCount); break;
+    case VT_INT16:  Store<int16_t>(src, dst, iCount);  break;
+    case VT_UINT32: Store<uint32_t>(src, dst, iCount); break;
+    case VT_INT32:  Store<int32_t>(src, dst, iCount);  break;
+    case VT_FLOAT:  Store<float>(src, dst, iCount);    break;
+    case VT_DOUBLE: Store<double>(src, dst, iCount);   break;
+    default: break;
+  }
+}
+
+void AccumulateRange(VoxelType t, const uint8_t* src, size_t iCount,
+                     double& fMin, double& fMax)
+{
+  switch (t) {
+    case VT_UINT8:  Range<uint8_t>(src, iCount, fMin, fMax);  break;
+    case VT_INT8:   Range<int8_t>(src, iCount, fMin, fMax);   break;
+    case VT_UINT16: Range<uint16_t>(src, iCount, fMin, fMax); break;
+    case VT_INT16:  Range<int16_t>(src, iCount, fMin, fMax);  break;
+    case VT_UINT32: Range<uint32_t>(src, iCount, fMin, fMax); break;
+    case VT_INT32:  Range<int32_t>(src, iCount, fMin, fMax);  break;
+    case VT_FLOAT:  Range<float>(src, iCount, fMin, fMax);    break;
+    case VT_DOUBLE: Range<double>(src, iCount, fMin, fMax);   break;
+    default: break;
+  }
+}
@@ -0,0 +1,70 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    VoxelType.h
+  \brief   Conversion of raw voxel data from and to double.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef VOXELTYPE_H
+#define VOXELTYPE_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct RawVolumeInfo;
+
+enum VoxelType {
+  VT_UINT8, VT_INT8, VT_UINT16, VT_INT16, VT_UINT32, VT_INT32,
+  VT_FLOAT, VT_DOUBLE,
+  VT_UNSUPPORTED
+};
+
+/// Scalar type of a volume; VT_UNSUPPORTED for 64 bit integers.
+VoxelType GetVoxelType(const RawVolumeInfo& info);
+size_t GetVoxelTypeSize(VoxelType t);
+
+/// Converts iCount voxels at src to double.
+void LoadAsDouble(VoxelType t, const uint8_t* src, double* dst, size_t iCount);
+
+/// Converts iCount doubles to voxels at dst.  Integer types are rounded to
+/// the nearest value and clamped to their range.
+void StoreFromDouble(VoxelType t, const double* src, uint8_t* dst,
+                     size_t iCount);
+
+/// Widens [fMin, fMax] to cover the finite values among iCount voxels at
+/// src; NaNs and infinities are skipped.  Start from fMin = +inf and
+/// fMax = -inf, which is left as it is if no voxel is finite.
+void AccumulateRange(VoxelType t, const uint8_t* src, size_t iCount,
+                     double& fMin, double& fMax);
+
+#endif // VOXELTYPE_H
@@ -0,0 +1,219 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    AsyncConsoleOut.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "AsyncConsoleOut.h"
+
+// CHANNEL_NONE marks lines from the unstructured printf overload
+static const int CHANNEL_LINE = CHANNEL_NONE;
+
+AsyncConsoleOut::AsyncConsoleOut(float fRefreshRate) :
+  m_Ring(RING_SIZE),
+  m_iEnqueue(0),
+  m_iDropped(0),
+  m_iDequeue(0),
+  m_iPrinted(0),
+  m_iFlushing(0),
+  m_bStop(false),
+  m_bClearOldMessage(false),
+  m_fPeriod(fRefreshRate > 0.0f ? 1.0 / fRefreshRate : 0.0)
+{
+  for (size_t i = 0;i<m_Ring.size();i++) {
+    m_Ring[i].iSequence.store(i, std::memory_order_relaxed);
+    m_Ring[i].pLong = NULL;
+  }
+  m_Drain = std::thread(&AsyncConsoleOut::Drain, this);
+}
+
+AsyncConsoleOut::~AsyncConsoleOut()
+{
+  m_bStop = true;
+  m_Drain.join();
+  // releases long messages pushed after the drain thread stopped
+  int channel;
+  std::string msg;
+  while (Pop(channel, msg)) {}
+  // coalesced progress is dropped by design, so only mention drops when
+  // every message was supposed to be shown
+  if (m_iDropped != 0 && !(m_bClearOldMessage && m_fPeriod > 0.0)) {
+    std::cout << m_iDropped << " console messages were dropped\n";
+  }
+}
+
+void AsyncConsoleOut::printf(enum DebugChannel channel, const char*,
+                             const char* msg)
+{
+  if (Push(channel, msg)) return;
+  if (channel == CHANNEL_MESSAGE) {
+    m_iDropped++;
+    return;
+  }
+  // Warnings and errors are rare but matter, so they wait for a free slot
+  // rather than vanish; the drain thread frees slots without blocking.
+  while (!Push(channel, msg)) {
+    std::this_thread::yield();
+  }
+}
+
+void AsyncConsoleOut::printf(const char *s) const
+{
+  while (!Push(CHANNEL_LINE, s)) {
+    std::this_thread::yield();
+  }
+}
+
+// Bounded multi-producer ring after Dmitry Vyukov: each slot carries a
+// sequence number that tells producers and the consumer whose turn it is.
+bool AsyncConsoleOut::Push(int channel, const char* msg) const
+{
+  size_t pos = m_iEnqueue.load(std::memory_order_relaxed);
+  Slot* slot;
+  for (;;) {
+    slot = &m_Ring[pos % RING_SIZE];
+    const size_t seq = slot->iSequence.load(std::memory_order_acquire);
+    const ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos);
+    if (diff == 0) {
+      if (m_iEnqueue.compare_exchange_weak(pos, pos+1,
+                                           std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = m_iEnqueue.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->channel = channel;
+  const size_t iLength = strlen(msg);
+  if (iLength < SLOT_SIZE) {
+    memcpy(slot->msg, msg, iLength+1);
+    slot->pLong = NULL;
+  } else {
+    slot->pLong = new char[iLength+1];
+    memcpy(slot->pLong, msg, iLength+1);
+  }
+  slot->iSequence.store(pos+1, std::memory_order_release);
+  return true;
+}
+
+bool AsyncConsoleOut::Pop(int& channel, std::string& msg)
+{
+  Slot& slot = m_Ring[m_iDequeue % RING_SIZE];
+  if (slot.iSequence.load(std::memory_order_acquire) != m_iDequeue+1) {
+    return false;
+  }
+  channel = slot.channel;
+  if (slot.pLong) {
+    msg = slot.pLong;
+    delete[] slot.pLong;
+    slot.pLong = NULL;
+  } else {
+    msg = slot.msg;
+  }
+  slot.iSequence.store(m_iDequeue + RING_SIZE, std::memory_order_release);
+  m_iDequeue++;
+  return true;
+}
+
+void AsyncConsoleOut::Drain()
+{
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point lastProgress = Clock::now();
+  // coalesced progress waiting for its turn; it only counts as printed
+  // once it is shown or replaced by newer progress
+  std::string strPending;
+  bool bPending = false;
+  std::string msg;
+  int channel;
+  auto showPending = [&]() {
+    if (!bPending) return;
+    m_Console.SetClearOldMessage(m_bClearOldMessage);
+    m_Console.printf(CHANNEL_MESSAGE, "", strPending.c_str());
+    bPending = false;
+    m_iPrinted++;
+  };
+
+  for (;;) {
+    // read the stop flag first so nothing pushed before it is lost
+    const bool bStop = m_bStop;
+    bool bIdle = true;
+    while (Pop(channel, msg)) {
+      bIdle = false;
+      if (channel == CHANNEL_MESSAGE && m_bClearOldMessage && m_fPeriod > 0.0) {
+        if (bPending) m_iPrinted++;
+        strPending.swap(msg);
+        bPending = true;
+        continue;
+      }
+      showPending();
+      if (channel == CHANNEL_LINE) {
+        m_Console.printf(msg.c_str());
+      } else {
+        m_Console.SetClearOldMessage(m_bClearOldMessage);
+        m_Console.printf(DebugChannel(channel), "", msg.c_str());
+      }
+      m_iPrinted++;
+    }
+
+    const Clock::time_point now = Clock::now();
+    if (bPending && (bStop || m_iFlushing != 0 ||
+                     std::chrono::duration<double>(now - lastProgress).count()
+                     >= m_fPeriod)) {
+      showPending();
+      lastProgress = now;
+    }
+
+    if (bStop) break;
+    if (bIdle) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::cout.flush();
+}
+
+void AsyncConsoleOut::Flush()
+{
+  // wait until the drain thread has shown everything queued so far; held
+  // back progress goes out right away while anyone is flushing
+  m_iFlushing++;
+  const size_t iTarget = m_iEnqueue.load();
+  while (m_iPrinted.load() < iTarget) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  m_iFlushing--;
+}
@@ -0,0 +1,103 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    AsyncConsoleOut.h
+  \brief   Console debug out that keeps formatting and terminal I/O off the
+           threads reporting progress.
+  \version 1.0
+  \date    October 2026
+*/
+
+
+#pragma once
+
+#ifndef ASYNCCONSOLEOUT_H
+#define ASYNCCONSOLEOUT_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "HRConsoleOut.h"
+
+/// Messages are copied into a fixed size lock-free ring buffer and printed
+/// by a background thread through an HRConsoleOut.  Progress messages are
+/// coalesced: with SetClearOldMessage(true) only the newest one is shown,
+/// at most fRefreshRate times per second.  Warnings and errors are printed
+/// in order with the progress shown before them.  Reporting never waits
+/// for the console; if the ring is full a progress message is dropped.
+/// Messages longer than a slot are carried on the heap.
+class AsyncConsoleOut : public AbstrDebugOut {
+  public:
+    /// \param fRefreshRate progress updates per second, 0 shows them all.
+    explicit AsyncConsoleOut(float fRefreshRate = 10.0f);
+    ~AsyncConsoleOut();
+
+    void SetClearOldMessage(bool bClearOldMessage) {
+      m_bClearOldMessage = bClearOldMessage;
+    }
+    bool GetClearOldMessage() {return m_bClearOldMessage;}
+
+    virtual void printf(enum DebugChannel, const char* source,
+                        const char* msg);
+    virtual void printf(const char *s) const;
+
+    /// Prints everything queued so far before returning, including
+    /// progress held back for the refresh rate.
+    void Flush();
+
+  private:
+    enum { RING_SIZE = 4096, SLOT_SIZE = 512 };
+    struct Slot {
+      std::atomic<size_t> iSequence;
+      int   channel;
+      char  msg[SLOT_SIZE];
+      char* pLong;    ///< owned copy of a message that does not fit msg
+    };
+
+    bool Push(int channel, const char* msg) const;
+    bool Pop(int& channel, std::string& msg);
+    void Drain();
+
+    // the ring is logically const for the const printf() overload
+    mutable std::vector<Slot> m_Ring;
+    mutable std::atomic<size_t> m_iEnqueue;
+    mutable std::atomic<size_t> m_iDropped;
+    size_t m_iDequeue;
+    std::atomic<size_t> m_iPrinted;
+    std::atomic<int> m_iFlushing;
+    std::atomic<bool> m_bStop;
+    std::atomic<bool> m_bClearOldMessage;
+    double m_fPeriod;
+    HRConsoleOut m_Console;
+    std::thread m_Drain;
+};
+
+#endif // ASYNCCONSOLEOUT_H
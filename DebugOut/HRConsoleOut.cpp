@@ -39,6 +39,7 @@
 #include <cstdarg>
 #include <cstring>
 #include <iostream>
+#include <string>
 
 #include "HRConsoleOut.h"
 #include "../../Tuvok/Basics/Console.h"
@@ -55,32 +56,22 @@ HRConsoleOut::~HRConsoleOut() {
 void HRConsoleOut::printf(enum DebugChannel channel, const char*,
                           const char* msg)
 {
-  char buff[16384];
-#ifdef WIN32
-  strncpy_s(buff, 16384, msg, 16384);
-#else
-  strncpy(buff, msg, 16384);
-#endif
+  std::string buff(msg);
 
   if (m_bClearOldMessage) {
     // Remove any newlines from the string.
-    for (size_t i=0;i<strlen(buff);i++) {
-      if (buff[i] == '\n') {
-        buff[i] = ' ';
-      }
-    }
+    std::replace(buff.begin(), buff.end(), '\n', ' ');
   }
 
   std::cout << "\r" << buff;
 
   if (m_bClearOldMessage && channel == CHANNEL_MESSAGE) {
-    size_t len = strlen(buff);
     // Clear the rest of the line, in case this message is shorter than the
     // last one was.
-    for (size_t i=len;i<m_iLengthLastMessage;i++) {
-      std::cout << " ";
+    if (buff.size() < m_iLengthLastMessage) {
+      std::cout << std::string(m_iLengthLastMessage - buff.size(), ' ');
     }
-    m_iLengthLastMessage = len;
+    m_iLengthLastMessage = buff.size();
   } else {
     std::cout << std::endl;
     m_iLengthLastMessage = 0;
@@ -0,0 +1,69 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    JobOut.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include "JobOut.h"
+#include "../Util/WorkerPool.h"
+
+void JobOut::Register(const void* pTag, const Receiver& receiver)
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_Receivers[pTag] = receiver;
+}
+
+void JobOut::Unregister(const void* pTag)
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_Receivers.erase(pTag);
+}
+
+JobOut::Receiver JobOut::Find() const
+{
+  const void* pTag = WorkerPool::GetJobTag();
+  if (!pTag) return Receiver();
+  std::lock_guard<std::mutex> lock(m_Guard);
+  auto r = m_Receivers.find(pTag);
+  return r == m_Receivers.end() ? Receiver() : r->second;
+}
+
+void JobOut::printf(enum DebugChannel channel, const char*, const char* msg)
+{
+  // called outside the lock, a slow receiver only holds up its own job
+  const Receiver receiver = Find();
+  if (receiver) receiver(channel, msg ? msg : "");
+}
+
+void JobOut::printf(const char *s) const
+{
+  const Receiver receiver = Find();
+  if (receiver) receiver(CHANNEL_OTHER, s ? s : "");
+}
@@ -0,0 +1,71 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    JobOut.h
+  \brief   Debug out that routes the messages of each job to its own
+           receiver, such as the client that submitted it.
+  \version 1.0
+  \date    October 2026
+*/
+
+
+#pragma once
+
+#ifndef JOBOUT_H
+#define JOBOUT_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "../../Tuvok/DebugOut/AbstrDebugOut.h"
+
+/// Jobs are told apart by WorkerPool's job tag, so messages from the
+/// threads a job spreads its work over reach the job's receiver too.
+/// Messages of threads without a registered tag are dropped here.
+class JobOut : public AbstrDebugOut {
+  public:
+    typedef std::function<void (DebugChannel, const char*)> Receiver;
+
+    /// Routes messages of threads tagged pTag to receiver, which may be
+    /// called from several threads at once.
+    void Register(const void* pTag, const Receiver& receiver);
+    void Unregister(const void* pTag);
+
+    virtual void printf(enum DebugChannel, const char* source,
+                        const char* msg);
+    virtual void printf(const char *s) const;
+
+  private:
+    Receiver Find() const;
+
+    mutable std::mutex m_Guard;
+    std::map<const void*, Receiver> m_Receivers;
+};
+
+#endif // JOBOUT_H
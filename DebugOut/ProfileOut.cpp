@@ -0,0 +1,213 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    ProfileOut.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+#include "ProfileOut.h"
+#include "../Util/ProcessStats.h"
+
+ProfileOut* ProfileOut::s_pActive = NULL;
+
+ProfileOut::ProfileOut() :
+  m_Epoch(std::chrono::steady_clock::now())
+{
+}
+
+ProfileOut::~ProfileOut() {
+  if (s_pActive == this) s_pActive = NULL;
+}
+
+double ProfileOut::Now() const
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       m_Epoch).count();
+}
+
+ProfileOut::ThreadState& ProfileOut::State()
+{
+  auto t = m_Threads.find(std::this_thread::get_id());
+  if (t == m_Threads.end()) {
+    ThreadState state;
+    state.iIndex = m_Threads.size();
+    state.bInTuvokSpan = false;
+    t = m_Threads.insert(std::make_pair(std::this_thread::get_id(),
+                                        state)).first;
+  }
+  return t->second;
+}
+
+void ProfileOut::CloseTuvokSpan(ThreadState& t, double fNow)
+{
+  if (!t.bInTuvokSpan) return;
+  Span span;
+  span.strName   = t.tuvok.strName;
+  span.strDetail = t.tuvok.strDetail;
+  span.bStage    = false;
+  span.iThread   = t.iIndex;
+  span.fStart    = t.tuvok.fStart;
+  span.fDuration = fNow - t.tuvok.fStart;
+  span.fCPU      = ProcessStats::ThreadCPUSeconds() - t.tuvok.fCPUStart;
+  span.iBytesIn  = 0;
+  span.iBytesOut = 0;
+  span.iRSS      = 0;
+  m_Spans.push_back(span);
+  t.bInTuvokSpan = false;
+}
+
+void ProfileOut::printf(enum DebugChannel, const char* source,
+                        const char* msg)
+{
+  const double fNow = Now();
+  std::lock_guard<std::mutex> lock(m_Guard);
+  ThreadState& t = State();
+  const std::string strSource = source ? source : "";
+  if (t.bInTuvokSpan && t.tuvok.strName == strSource) return;
+
+  CloseTuvokSpan(t, fNow);
+  t.tuvok.strName   = strSource;
+  t.tuvok.strDetail = msg ? msg : "";
+  t.tuvok.fStart    = fNow;
+  t.tuvok.fCPUStart = ProcessStats::ThreadCPUSeconds();
+  t.bInTuvokSpan = true;
+}
+
+void ProfileOut::printf(const char *) const
+{
+  // unstructured output carries no stage information
+}
+
+void ProfileOut::BeginStage(const std::string& strName)
+{
+  const double fNow = Now();
+  std::lock_guard<std::mutex> lock(m_Guard);
+  ThreadState& t = State();
+  CloseTuvokSpan(t, fNow);
+
+  Open stage;
+  stage.strName = strName;
+  stage.fStart = fNow;
+  stage.fCPUStart = ProcessStats::CPUSeconds();
+  t.stages.push_back(stage);
+}
+
+void ProfileOut::EndStage(uint64_t iBytesIn, uint64_t iBytesOut)
+{
+  const double fNow = Now();
+  const uint64_t iRSS = ProcessStats::CurrentRSS();
+  std::lock_guard<std::mutex> lock(m_Guard);
+  ThreadState& t = State();
+  if (t.stages.empty()) return;
+  CloseTuvokSpan(t, fNow);
+
+  const Open& stage = t.stages.back();
+  Span span;
+  span.strName   = stage.strName;
+  span.bStage    = true;
+  span.iThread   = t.iIndex;
+  span.fStart    = stage.fStart;
+  span.fDuration = fNow - stage.fStart;
+  span.fCPU      = ProcessStats::CPUSeconds() - stage.fCPUStart;
+  span.iBytesIn  = iBytesIn;
+  span.iBytesOut = iBytesOut;
+  span.iRSS      = iRSS;
+  m_Spans.push_back(span);
+  t.stages.pop_back();
+}
+
+static std::string JSONString(const std::string& s)
+{
+  std::string out = "\"";
+  for (size_t i = 0;i<s.size();i++) {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += char(c);
+    } else if (c < 0x20) {
+      char buff[8];
+      snprintf(buff, sizeof(buff), "\\u%04x", c);
+      out += buff;
+    } else {
+      out += char(c);
+    }
+  }
+  return out + "\"";
+}
+
+bool ProfileOut::Write(const std::string& strFilename) const
+{
+  std::ofstream out(strFilename.c_str());
+  if (!out.is_open()) return false;
+
+  std::lock_guard<std::mutex> lock(m_Guard);
+  // microseconds with ns resolution, not 6 significant digits that lose
+  // short spans once the run is a few seconds old
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\": \"ms\",\n"
+      << " \"otherData\": {\"peak_rss_bytes\": " << ProcessStats::PeakRSS()
+      << "},\n"
+      << " \"traceEvents\": [\n";
+  for (auto t = m_Threads.cbegin(); t != m_Threads.cend(); ++t) {
+    out << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+        << "\"tid\": " << t->second.iIndex << ", \"args\": {\"name\": "
+        << JSONString(t->second.iIndex == 0 ? "main" : "worker") << "}},\n";
+  }
+  for (auto s = m_Spans.cbegin(); s != m_Spans.cend(); ++s) {
+    const double fStartUs = s->fStart * 1e6;
+    out << "  {\"name\": " << JSONString(s->strName)
+        << ", \"cat\": \"" << (s->bStage ? "stage" : "tuvok") << "\""
+        << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << s->iThread
+        << ", \"ts\": " << fStartUs << ", \"dur\": " << s->fDuration * 1e6
+        << ", \"args\": {\"cpu_ms\": " << s->fCPU * 1e3;
+    if (s->bStage) {
+      out << ", \"bytes_in\": " << s->iBytesIn
+          << ", \"bytes_out\": " << s->iBytesOut
+          << ", \"rss_mb\": " << s->iRSS / 1048576.0;
+    } else {
+      out << ", \"first_message\": " << JSONString(s->strDetail);
+    }
+    out << "}},\n";
+    if (s->bStage) {
+      out << "  {\"name\": \"RSS\", \"ph\": \"C\", \"pid\": 1, \"ts\": "
+          << fStartUs + s->fDuration * 1e6 << ", \"args\": {\"MB\": "
+          << s->iRSS / 1048576.0 << "}},\n";
+    }
+  }
+  // closing event keeps the list free of a trailing comma
+  out << "  {\"name\": \"end\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 1, "
+      << "\"tid\": 0, \"ts\": " << Now() * 1e6 << "}\n"
+      << " ]\n}\n";
+  return out.good();
+}
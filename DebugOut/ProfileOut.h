@@ -0,0 +1,144 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    ProfileOut.h
+  \brief   Debug out that records a per-stage timeline of a conversion and
+           writes it in the Chrome trace event format, which loads in
+           chrome://tracing and Perfetto.
+  \version 1.0
+  \date    October 2026
+*/
+
+
+#pragma once
+
+#ifndef PROFILEOUT_H
+#define PROFILEOUT_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../Tuvok/DebugOut/AbstrDebugOut.h"
+
+/// Two kinds of spans end up in the trace:
+///  - stages, opened and closed explicitly through ProfileScope by the
+///    converter itself.  They carry wall time, process CPU time, bytes in
+///    and out and the resident set size at their end.
+///  - Tuvok spans, derived from the messages Tuvok emits: a span runs from
+///    the first message of a function until the same thread reports from a
+///    different function or the enclosing stage ends.  They carry wall and
+///    thread CPU time.
+/// Recording takes a short lock per message and a few clock reads; files
+/// are only touched in Write().
+class ProfileOut : public AbstrDebugOut {
+  public:
+    ProfileOut();
+    ~ProfileOut();
+
+    virtual void printf(enum DebugChannel, const char* source,
+                        const char* msg);
+    virtual void printf(const char *s) const;
+
+    void BeginStage(const std::string& strName);
+    void EndStage(uint64_t iBytesIn, uint64_t iBytesOut);
+
+    /// Writes the trace recorded so far.
+    bool Write(const std::string& strFilename) const;
+
+    /// The profiler stages report to; NULL when profiling is off.
+    static ProfileOut* Active() {return s_pActive;}
+    static void SetActive(ProfileOut* p) {s_pActive = p;}
+
+  private:
+    struct Open {
+      std::string strName;
+      std::string strDetail;
+      double fStart;     // seconds since construction
+      double fCPUStart;
+    };
+    struct Span {
+      std::string strName;
+      std::string strDetail;
+      bool     bStage;
+      size_t   iThread;
+      double   fStart;
+      double   fDuration;
+      double   fCPU;
+      uint64_t iBytesIn;
+      uint64_t iBytesOut;
+      uint64_t iRSS;
+    };
+    struct ThreadState {
+      size_t iIndex;
+      std::vector<Open> stages;
+      Open tuvok;
+      bool bInTuvokSpan;
+    };
+
+    double Now() const;
+    ThreadState& State();
+    void CloseTuvokSpan(ThreadState& t, double fNow);
+
+    static ProfileOut* s_pActive;
+
+    mutable std::mutex m_Guard;
+    std::chrono::steady_clock::time_point m_Epoch;
+    std::map<std::thread::id, ThreadState> m_Threads;
+    std::vector<Span> m_Spans;
+};
+
+/// Marks a converter stage for the active profiler, if any.
+class ProfileScope {
+  public:
+    explicit ProfileScope(const std::string& strName) :
+      m_iBytesIn(0), m_iBytesOut(0)
+    {
+      if (ProfileOut::Active()) ProfileOut::Active()->BeginStage(strName);
+    }
+    ~ProfileScope() {
+      if (ProfileOut::Active()) {
+        ProfileOut::Active()->EndStage(m_iBytesIn, m_iBytesOut);
+      }
+    }
+
+    void SetBytes(uint64_t iIn, uint64_t iOut) {
+      m_iBytesIn = iIn;
+      m_iBytesOut = iOut;
+    }
+
+  private:
+    uint64_t m_iBytesIn;
+    uint64_t m_iBytesOut;
+};
+
+#endif // PROFILEOUT_H
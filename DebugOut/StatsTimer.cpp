@@ -0,0 +1,144 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    StatsTimer.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cctype>
+
+#include "StatsTimer.h"
+
+namespace {
+  double Since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count();
+  }
+
+  bool Contains(const std::string& strText, const char* word) {
+    return strText.find(word) != std::string::npos;
+  }
+}
+
+StatsTimer::StatsTimer()
+{
+  Reset();
+}
+
+StatsTimer::Pass StatsTimer::Classify(const char* source, const char* msg)
+{
+  std::string strText = std::string(source ? source : "") + " " +
+                        (msg ? msg : "");
+  std::transform(strText.begin(), strText.end(), strText.begin(),
+                 [](char c) { return char(std::tolower((unsigned char)c)); });
+  if (Contains(strText, "2d histogram") || Contains(strText, "histogram2d")) {
+    return PASS_HISTOGRAM_2D;
+  }
+  if (Contains(strText, "histogram")) return PASS_HISTOGRAM_1D;
+  if (Contains(strText, "maxmin") || Contains(strText, "max-min") ||
+      Contains(strText, "min-max") || Contains(strText, "minmax") ||
+      Contains(strText, "value range")) {
+    return PASS_RANGE;
+  }
+  return PASS_COUNT;
+}
+
+void StatsTimer::printf(enum DebugChannel, const char* source,
+                        const char* msg)
+{
+  const Pass ePass = Classify(source, msg);
+  const std::string strSource = source ? source : "";
+  std::lock_guard<std::mutex> lock(m_Guard);
+  auto i = m_Threads.find(std::this_thread::get_id());
+  if (i == m_Threads.end()) {
+    if (ePass == PASS_COUNT) return;
+    i = m_Threads.insert(std::make_pair(std::this_thread::get_id(),
+                                        ThreadState())).first;
+  }
+  ThreadState& t = i->second;
+  if (t.ePass != PASS_COUNT) {
+    // progress of the same pass, or of the function running it
+    if (ePass == t.ePass) return;
+    if (ePass == PASS_COUNT && strSource == t.strSource) return;
+    m_fSeconds[t.ePass] += Since(t.start);
+  }
+  t.ePass = ePass;
+  t.strSource = strSource;
+  t.start = std::chrono::steady_clock::now();
+}
+
+void StatsTimer::printf(const char *) const
+{
+  // unstructured output names no function
+}
+
+double StatsTimer::Seconds(Pass ePass) const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  double fSeconds = m_fSeconds[ePass];
+  for (auto t = m_Threads.cbegin(); t != m_Threads.cend(); ++t) {
+    if (t->second.ePass == ePass) fSeconds += Since(t->second.start);
+  }
+  return fSeconds;
+}
+
+double StatsTimer::TotalSeconds() const
+{
+  double fSeconds = 0.0;
+  for (int i = 0;i<PASS_COUNT;i++) fSeconds += Seconds(Pass(i));
+  return fSeconds;
+}
+
+void StatsTimer::Stop()
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  for (auto t = m_Threads.begin(); t != m_Threads.end(); ++t) {
+    if (t->second.ePass == PASS_COUNT) continue;
+    m_fSeconds[t->second.ePass] += Since(t->second.start);
+    t->second.ePass = PASS_COUNT;
+  }
+}
+
+void StatsTimer::Reset()
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_Threads.clear();
+  for (int i = 0;i<PASS_COUNT;i++) m_fSeconds[i] = 0.0;
+}
+
+const char* StatsTimer::PassName(Pass ePass)
+{
+  switch (ePass) {
+    case PASS_RANGE:        return "value range";
+    case PASS_HISTOGRAM_1D: return "1D histogram";
+    case PASS_HISTOGRAM_2D: return "2D histogram";
+    default:                return "unknown";
+  }
+}
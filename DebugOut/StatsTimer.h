@@ -0,0 +1,97 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    StatsTimer.h
+  \brief   Debug out that adds up the time Tuvok spends computing the
+           statistics of a UVF.
+  \version 1.0
+  \date    October 2026
+*/
+
+
+#pragma once
+
+#ifndef STATSTIMER_H
+#define STATSTIMER_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../../Tuvok/DebugOut/AbstrDebugOut.h"
+
+/// Tuvok computes the value range and the 1D and 2D histograms of a UVF
+/// in passes of their own over the bricks it wrote.  They are recognized
+/// from Tuvok's progress messages: a pass runs from a message naming it
+/// until the same thread reports on something else from another function,
+/// or until Stop().  The times are estimates: they depend on the wording
+/// of Tuvok's messages, not on the passes themselves.
+class StatsTimer : public AbstrDebugOut {
+  public:
+    enum Pass {
+      PASS_RANGE,
+      PASS_HISTOGRAM_1D,
+      PASS_HISTOGRAM_2D,
+      PASS_COUNT
+    };
+
+    StatsTimer();
+
+    virtual void printf(enum DebugChannel, const char* source,
+                        const char* msg);
+    virtual void printf(const char *s) const;
+
+    /// Wall time spent in pass so far, a pass still running counted up to
+    /// now.  Passes on several threads at once add up.
+    double Seconds(Pass ePass) const;
+    double TotalSeconds() const;
+    /// Closes the passes still open.  A pass whose last message was the
+    /// last one of its thread would otherwise keep counting wall time.
+    void Stop();
+    void Reset();
+
+    static const char* PassName(Pass ePass);
+
+  private:
+    struct ThreadState {
+      ThreadState() : ePass(PASS_COUNT) {}
+      Pass        ePass;   // PASS_COUNT outside of a statistics pass
+      std::string strSource;
+      std::chrono::steady_clock::time_point start;
+    };
+
+    static Pass Classify(const char* source, const char* msg);
+
+    mutable std::mutex m_Guard;
+    std::map<std::thread::id, ThreadState> m_Threads;
+    double m_fSeconds[PASS_COUNT];
+};
+
+#endif // STATSTIMER_H
@@ -0,0 +1,463 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    CompiledExpression.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "CompiledExpression.h"
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+# define TDC_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+      (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define TDC_SIMD_SSE2
+#endif
+
+namespace {
+  /// Voxels per register; a multiple of every SIMD width used below.
+  enum { BLOCK = 256 };
+
+  struct Instr {
+    ExprNode::Kind op;
+    uint32_t dst, a, b, c;
+  };
+
+  /// Plain C++ kernels: the fallback and the reference for constant
+  /// folding.  The semantics match Expression::Evaluate.
+  template<typename T> struct ScalarOps {
+    typedef T V;
+    enum { W = 1 };
+    static V Load(const T* p) {return *p;}
+    static void Store(T* p, V v) {*p = v;}
+    static V Add(V a, V b) {return a + b;}
+    static V Sub(V a, V b) {return a - b;}
+    static V Mul(V a, V b) {return a * b;}
+    static V Div(V a, V b) {return a / b;}
+    static V Min(V a, V b) {return std::min(a, b);}
+    static V Max(V a, V b) {return std::max(a, b);}
+    static V Lt(V a, V b) {return a <  b ? T(1) : T(0);}
+    static V Gt(V a, V b) {return a >  b ? T(1) : T(0);}
+    static V Le(V a, V b) {return a <= b ? T(1) : T(0);}
+    static V Ge(V a, V b) {return a >= b ? T(1) : T(0);}
+    static V Eq(V a, V b) {return a == b ? T(1) : T(0);}
+    static V Ne(V a, V b) {return a != b ? T(1) : T(0);}
+    static V And(V a, V b) {return (a != T(0) && b != T(0)) ? T(1) : T(0);}
+    static V Or(V a, V b) {return (a != T(0) || b != T(0)) ? T(1) : T(0);}
+    static V Not(V a) {return a == T(0) ? T(1) : T(0);}
+    static V Neg(V a) {return -a;}
+    static V Abs(V a) {return std::fabs(a);}
+    static V Select(V c, V a, V b) {return c != T(0) ? a : b;}
+  };
+
+#if defined(TDC_SIMD_SSE2)
+  struct SSE2Ops {
+    typedef __m128 V;
+    enum { W = 4 };
+    static V One() {return _mm_set1_ps(1.0f);}
+    static V Zero() {return _mm_setzero_ps();}
+    static V SignBit() {return _mm_set1_ps(-0.0f);}
+    static V Truth(V a) {return _mm_cmpneq_ps(a, Zero());}
+
+    static V Load(const float* p) {return _mm_loadu_ps(p);}
+    static void Store(float* p, V v) {_mm_storeu_ps(p, v);}
+    static V Add(V a, V b) {return _mm_add_ps(a, b);}
+    static V Sub(V a, V b) {return _mm_sub_ps(a, b);}
+    static V Mul(V a, V b) {return _mm_mul_ps(a, b);}
+    static V Div(V a, V b) {return _mm_div_ps(a, b);}
+    // operand order reproduces std::min/std::max for equal values
+    static V Min(V a, V b) {return _mm_min_ps(b, a);}
+    static V Max(V a, V b) {return _mm_max_ps(b, a);}
+    static V Lt(V a, V b) {return _mm_and_ps(_mm_cmplt_ps(a, b), One());}
+    static V Gt(V a, V b) {return _mm_and_ps(_mm_cmpgt_ps(a, b), One());}
+    static V Le(V a, V b) {return _mm_and_ps(_mm_cmple_ps(a, b), One());}
+    static V Ge(V a, V b) {return _mm_and_ps(_mm_cmpge_ps(a, b), One());}
+    static V Eq(V a, V b) {return _mm_and_ps(_mm_cmpeq_ps(a, b), One());}
+    static V Ne(V a, V b) {return _mm_and_ps(_mm_cmpneq_ps(a, b), One());}
+    static V And(V a, V b) {
+      return _mm_and_ps(_mm_and_ps(Truth(a), Truth(b)), One());
+    }
+    static V Or(V a, V b) {
+      return _mm_and_ps(_mm_or_ps(Truth(a), Truth(b)), One());
+    }
+    static V Not(V a) {return _mm_and_ps(_mm_cmpeq_ps(a, Zero()), One());}
+    static V Neg(V a) {return _mm_xor_ps(a, SignBit());}
+    static V Abs(V a) {return _mm_andnot_ps(SignBit(), a);}
+    static V Select(V c, V a, V b) {
+      const V m = Truth(c);
+      return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+  };
+  typedef SSE2Ops FloatOps;
+#elif defined(TDC_SIMD_AVX2)
+  struct AVX2Ops {
+    typedef __m256 V;
+    enum { W = 8 };
+    static V One() {return _mm256_set1_ps(1.0f);}
+    static V Zero() {return _mm256_setzero_ps();}
+    static V SignBit() {return _mm256_set1_ps(-0.0f);}
+    static V Truth(V a) {return _mm256_cmp_ps(a, Zero(), _CMP_NEQ_UQ);}
+    static V Mask(V m) {return _mm256_and_ps(m, One());}
+
+    static V Load(const float* p) {return _mm256_loadu_ps(p);}
+    static void Store(float* p, V v) {_mm256_storeu_ps(p, v);}
+    static V Add(V a, V b) {return _mm256_add_ps(a, b);}
+    static V Sub(V a, V b) {return _mm256_sub_ps(a, b);}
+    static V Mul(V a, V b) {return _mm256_mul_ps(a, b);}
+    static V Div(V a, V b) {return _mm256_div_ps(a, b);}
+    static V Min(V a, V b) {return _mm256_min_ps(b, a);}
+    static V Max(V a, V b) {return _mm256_max_ps(b, a);}
+    static V Lt(V a, V b) {return Mask(_mm256_cmp_ps(a, b, _CMP_LT_OQ));}
+    static V Gt(V a, V b) {return Mask(_mm256_cmp_ps(a, b, _CMP_GT_OQ));}
+    static V Le(V a, V b) {return Mask(_mm256_cmp_ps(a, b, _CMP_LE_OQ));}
+    static V Ge(V a, V b) {return Mask(_mm256_cmp_ps(a, b, _CMP_GE_OQ));}
+    static V Eq(V a, V b) {return Mask(_mm256_cmp_ps(a, b, _CMP_EQ_OQ));}
+    static V Ne(V a, V b) {return Mask(_mm256_cmp_ps(a, b, _CMP_NEQ_UQ));}
+    static V And(V a, V b) {return Mask(_mm256_and_ps(Truth(a), Truth(b)));}
+    static V Or(V a, V b) {return Mask(_mm256_or_ps(Truth(a), Truth(b)));}
+    static V Not(V a) {return Mask(_mm256_cmp_ps(a, Zero(), _CMP_EQ_OQ));}
+    static V Neg(V a) {return _mm256_xor_ps(a, SignBit());}
+    static V Abs(V a) {return _mm256_andnot_ps(SignBit(), a);}
+    static V Select(V c, V a, V b) {return _mm256_blendv_ps(b, a, Truth(c));}
+  };
+  typedef AVX2Ops FloatOps;
+#else
+  typedef ScalarOps<float> FloatOps;
+#endif
+
+  template<class S, typename T>
+  void Unary(T* d, const T* a, typename S::V (*f)(typename S::V)) {
+    for (size_t i = 0;i<BLOCK;i+=S::W) S::Store(d+i, f(S::Load(a+i)));
+  }
+  template<class S, typename T>
+  void Binary(T* d, const T* a, const T* b,
+              typename S::V (*f)(typename S::V, typename S::V)) {
+    for (size_t i = 0;i<BLOCK;i+=S::W) {
+      S::Store(d+i, f(S::Load(a+i), S::Load(b+i)));
+    }
+  }
+
+  template<class S, typename T>
+  void Run(const std::vector<Instr>& program, T* regs) {
+    for (auto in = program.cbegin(); in != program.cend(); ++in) {
+      T* d = regs + size_t(in->dst)*BLOCK;
+      const T* a = regs + size_t(in->a)*BLOCK;
+      const T* b = regs + size_t(in->b)*BLOCK;
+      const T* c = regs + size_t(in->c)*BLOCK;
+      switch (in->op) {
+        case ExprNode::NEG: Unary<S>(d, a, &S::Neg); break;
+        case ExprNode::NOT: Unary<S>(d, a, &S::Not); break;
+        case ExprNode::ABS: Unary<S>(d, a, &S::Abs); break;
+        case ExprNode::ADD: Binary<S>(d, a, b, &S::Add); break;
+        case ExprNode::SUB: Binary<S>(d, a, b, &S::Sub); break;
+        case ExprNode::MUL: Binary<S>(d, a, b, &S::Mul); break;
+        case ExprNode::DIV: Binary<S>(d, a, b, &S::Div); break;
+        case ExprNode::LT:  Binary<S>(d, a, b, &S::Lt);  break;
+        case ExprNode::GT:  Binary<S>(d, a, b, &S::Gt);  break;
+        case ExprNode::LE:  Binary<S>(d, a, b, &S::Le);  break;
+        case ExprNode::GE:  Binary<S>(d, a, b, &S::Ge);  break;
+        case ExprNode::EQ:  Binary<S>(d, a, b, &S::Eq);  break;
+        case ExprNode::NE:  Binary<S>(d, a, b, &S::Ne);  break;
+        case ExprNode::AND: Binary<S>(d, a, b, &S::And); break;
+        case ExprNode::OR:  Binary<S>(d, a, b, &S::Or);  break;
+        case ExprNode::MIN: Binary<S>(d, a, b, &S::Min); break;
+        case ExprNode::MAX: Binary<S>(d, a, b, &S::Max); break;
+        case ExprNode::COND:
+          for (size_t i = 0;i<BLOCK;i+=S::W) {
+            S::Store(d+i, S::Select(S::Load(a+i), S::Load(b+i), S::Load(c+i)));
+          }
+          break;
+        default: break;
+      }
+    }
+  }
+
+  template<typename T>
+  T Fold(ExprNode::Kind op, T a, T b, T c) {
+    typedef ScalarOps<T> S;
+    switch (op) {
+      case ExprNode::NEG: return S::Neg(a);
+      case ExprNode::NOT: return S::Not(a);
+      case ExprNode::ABS: return S::Abs(a);
+      case ExprNode::ADD: return S::Add(a, b);
+      case ExprNode::SUB: return S::Sub(a, b);
+      case ExprNode::MUL: return S::Mul(a, b);
+      case ExprNode::DIV: return S::Div(a, b);
+      case ExprNode::LT:  return S::Lt(a, b);
+      case ExprNode::GT:  return S::Gt(a, b);
+      case ExprNode::LE:  return S::Le(a, b);
+      case ExprNode::GE:  return S::Ge(a, b);
+      case ExprNode::EQ:  return S::Eq(a, b);
+      case ExprNode::NE:  return S::Ne(a, b);
+      case ExprNode::AND: return S::And(a, b);
+      case ExprNode::OR:  return S::Or(a, b);
+      case ExprNode::MIN: return S::Min(a, b);
+      case ExprNode::MAX: return S::Max(a, b);
+      case ExprNode::COND: return S::Select(a, b, c);
+      default: return T(0);
+    }
+  }
+
+  template<typename Src, typename T>
+  void LoadBlock(const uint8_t* src, T* dst, size_t n) {
+    for (size_t i = 0;i<n;i++) {
+      Src s;
+      memcpy(&s, src + i*sizeof(Src), sizeof(Src));
+      dst[i] = T(s);
+    }
+  }
+
+  template<typename T, typename Dst>
+  void StoreBlock(const T* src, uint8_t* dst, size_t n) {
+    const T lo = T(std::numeric_limits<Dst>::lowest());
+    const T hi = T(std::numeric_limits<Dst>::max());
+    for (size_t i = 0;i<n;i++) {
+      Dst d;
+      if (std::numeric_limits<Dst>::is_integer) {
+        // NaN compares false everywhere and ends up as the lower bound
+        const T v = std::floor(src[i] + T(0.5));
+        d = Dst(v >= lo ? std::min(v, hi) : lo);
+      } else {
+        d = Dst(src[i]);
+      }
+      memcpy(dst + i*sizeof(Dst), &d, sizeof(Dst));
+    }
+  }
+
+  template<typename T>
+  void (*Loader(VoxelType t))(const uint8_t*, T*, size_t) {
+    switch (t) {
+      case VT_UINT8:  return &LoadBlock<uint8_t, T>;
+      case VT_INT8:   return &LoadBlock<int8_t, T>;
+      case VT_UINT16: return &LoadBlock<uint16_t, T>;
+      case VT_INT16:  return &LoadBlock<int16_t, T>;
+      case VT_UINT32: return &LoadBlock<uint32_t, T>;
+      case VT_INT32:  return &LoadBlock<int32_t, T>;
+      case VT_FLOAT:  return &LoadBlock<float, T>;
+      case VT_DOUBLE: return &LoadBlock<double, T>;
+      default:        return NULL;
+    }
+  }
+
+  template<typename T>
+  void (*Storer(VoxelType t))(const T*, uint8_t*, size_t) {
+    switch (t) {
+      case VT_UINT8:  return &StoreBlock<T, uint8_t>;
+      case VT_INT8:   return &StoreBlock<T, int8_t>;
+      case VT_UINT16: return &StoreBlock<T, uint16_t>;
+      case VT_INT16:  return &StoreBlock<T, int16_t>;
+      case VT_UINT32: return &StoreBlock<T, uint32_t>;
+      case VT_INT32:  return &StoreBlock<T, int32_t>;
+      case VT_FLOAT:  return &StoreBlock<T, float>;
+      case VT_DOUBLE: return &StoreBlock<T, double>;
+      default:        return NULL;
+    }
+  }
+
+  bool FitsFloat(VoxelType t) {
+    return t == VT_UINT8 || t == VT_INT8 || t == VT_UINT16 ||
+           t == VT_INT16 || t == VT_FLOAT;
+  }
+}
+
+class CompiledExpression::Program {
+  public:
+    virtual ~Program() {}
+    virtual void Evaluate(const uint8_t* const* pInputs, size_t iCount,
+                          uint8_t* pOut, std::vector<uint8_t>& scratch) const = 0;
+    virtual bool IsSinglePrecision() const = 0;
+};
+
+namespace {
+  /// Register file layout: inputs first, then one register per constant
+  /// and per instruction.
+  template<typename T, class S>
+  class Kernel : public CompiledExpression::Program {
+    public:
+      Kernel(const Expression& expr, const std::vector<VoxelType>& inputs,
+             VoxelType output) :
+        m_iRegisters(uint32_t(inputs.size())),
+        m_InputSizes(inputs.size()),
+        m_Used(inputs.size(), false),
+        m_Store(Storer<T>(output)),
+        m_iOutputSize(GetVoxelTypeSize(output))
+      {
+        for (size_t i = 0;i<inputs.size();i++) {
+          m_Loaders.push_back(Loader<T>(inputs[i]));
+          m_InputSizes[i] = GetVoxelTypeSize(inputs[i]);
+        }
+        m_iResult = Compile(expr.GetRoot());
+      }
+
+      virtual bool IsSinglePrecision() const {
+        return sizeof(T) == sizeof(float);
+      }
+
+      virtual void Evaluate(const uint8_t* const* pInputs, size_t iCount,
+                            uint8_t* pOut, std::vector<uint8_t>& scratch) const {
+        T* regs = Registers(scratch);
+        for (size_t iStart = 0;iStart<iCount;iStart+=BLOCK) {
+          const size_t n = std::min<size_t>(BLOCK, iCount-iStart);
+          for (size_t i = 0;i<m_Loaders.size();i++) {
+            if (!m_Used[i]) continue;
+            T* r = regs + i*BLOCK;
+            m_Loaders[i](pInputs[i] + iStart*m_InputSizes[i], r, n);
+            // keep the unused tail finite so it costs nothing to compute
+            std::fill(r+n, r+BLOCK, T(0));
+          }
+          Run<S>(m_Program, regs);
+          m_Store(regs + size_t(m_iResult)*BLOCK, pOut + iStart*m_iOutputSize, n);
+        }
+      }
+
+    private:
+      uint32_t Constant(T value) {
+        m_Constants.push_back(std::make_pair(m_iRegisters, value));
+        return m_iRegisters++;
+      }
+
+      bool IsConstant(uint32_t reg, T& value) const {
+        for (auto c = m_Constants.cbegin(); c != m_Constants.cend(); ++c) {
+          if (c->first == reg) {
+            value = c->second;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      uint32_t Compile(const ExprNode& n) {
+        if (n.kind == ExprNode::VOLUME) {
+          m_Used[n.volume] = true;
+          return uint32_t(n.volume);
+        }
+        if (n.kind == ExprNode::CONSTANT) return Constant(T(n.value));
+
+        Instr in;
+        in.op = n.kind;
+        in.a = Compile(*n.a);
+        in.b = n.b ? Compile(*n.b) : in.a;
+        in.c = n.c ? Compile(*n.c) : in.a;
+
+        T a, b, c;
+        if (IsConstant(in.a, a) && IsConstant(in.b, b) && IsConstant(in.c, c)) {
+          return Constant(Fold(n.kind, a, b, c));
+        }
+        in.dst = m_iRegisters++;
+        m_Program.push_back(in);
+        return in.dst;
+      }
+
+      /// The scratch buffer remembers which kernel set up its constants, so
+      /// they are only written on first use.
+      T* Registers(std::vector<uint8_t>& scratch) const {
+        const size_t iHeader = 64;  // keeps the registers 64 byte aligned
+        const size_t iBytes = iHeader + size_t(m_iRegisters)*BLOCK*sizeof(T);
+        const Program* owner = NULL;
+        if (scratch.size() >= iBytes) memcpy(&owner, &scratch[0], sizeof(owner));
+        if (owner != this || scratch.size() < iBytes) {
+          scratch.assign(iBytes + 64, 0);
+          owner = this;
+          memcpy(&scratch[0], &owner, sizeof(owner));
+        }
+        uint8_t* base = &scratch[0] + iHeader;
+        base += (64 - reinterpret_cast<uintptr_t>(base) % 64) % 64;
+        T* regs = reinterpret_cast<T*>(base);
+        if (scratch[sizeof(owner)] == 0) {
+          for (auto c = m_Constants.cbegin(); c != m_Constants.cend(); ++c) {
+            std::fill(regs + size_t(c->first)*BLOCK,
+                      regs + size_t(c->first+1)*BLOCK, c->second);
+          }
+          scratch[sizeof(owner)] = 1;
+        }
+        return regs;
+      }
+
+      uint32_t m_iRegisters;
+      uint32_t m_iResult;
+      std::vector<Instr> m_Program;
+      std::vector<std::pair<uint32_t, T>> m_Constants;
+      std::vector<void (*)(const uint8_t*, T*, size_t)> m_Loaders;
+      std::vector<size_t> m_InputSizes;
+      std::vector<bool> m_Used;
+      void (*m_Store)(const T*, uint8_t*, size_t);
+      size_t m_iOutputSize;
+  };
+}
+
+CompiledExpression::CompiledExpression(const Expression& expr,
+                                       const std::vector<VoxelType>& inputTypes,
+                                       VoxelType outputType)
+{
+  bool bSingle = FitsFloat(outputType);
+  for (auto t = inputTypes.cbegin(); t != inputTypes.cend(); ++t) {
+    bSingle = bSingle && FitsFloat(*t);
+  }
+  if (bSingle) {
+    m_pProgram.reset(new Kernel<float, FloatOps>(expr, inputTypes, outputType));
+  } else {
+    m_pProgram.reset(new Kernel<double, ScalarOps<double>>(expr, inputTypes,
+                                                          outputType));
+  }
+}
+
+CompiledExpression::~CompiledExpression()
+{
+}
+
+void CompiledExpression::Evaluate(const uint8_t* const* pInputs, size_t iCount,
+                                  uint8_t* pOut,
+                                  std::vector<uint8_t>& scratch) const
+{
+  m_pProgram->Evaluate(pInputs, iCount, pOut, scratch);
+}
+
+bool CompiledExpression::IsSinglePrecision() const
+{
+  return m_pProgram->IsSinglePrecision();
+}
+
+const char* CompiledExpression::GetInstructionSet()
+{
+#if defined(TDC_SIMD_AVX2)
+  return "AVX2";
+#elif defined(TDC_SIMD_SSE2)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,83 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    CompiledExpression.h
+  \brief   Lowers a parsed Expression to a register program that runs a
+           block of voxels at a time with SIMD kernels.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef COMPILEDEXPRESSION_H
+#define COMPILEDEXPRESSION_H
+
+#include <memory>
+#include <vector>
+
+#include "Expression.h"
+#include "../Convert/VoxelType.h"
+
+/// Every AST node becomes one instruction over a register holding a block
+/// of voxels; constant subtrees are folded at compile time.  Inputs are
+/// converted into registers by loaders instantiated per voxel type, and
+/// the result is rounded and clamped into the output type the same way
+/// StoreFromDouble does.
+///
+/// Arithmetic runs in single precision when every input and the output fit
+/// a float exactly (8 and 16 bit integers, float), otherwise in double.
+/// The float kernels use AVX2 when the compiler targets it (see the
+/// TUVOKDATACONVERTER_AVX2 CMake option), SSE2 on any other x86-64 build
+/// and plain loops elsewhere.
+class CompiledExpression {
+  public:
+    CompiledExpression(const Expression& expr,
+                       const std::vector<VoxelType>& inputTypes,
+                       VoxelType outputType);
+    ~CompiledExpression();
+
+    /// Evaluates iCount voxels.  pInputs[i] points to iCount voxels of
+    /// input i, pOut receives iCount voxels of the output type.  Safe to
+    /// call concurrently as long as every thread passes its own scratch.
+    void Evaluate(const uint8_t* const* pInputs, size_t iCount,
+                  uint8_t* pOut, std::vector<uint8_t>& scratch) const;
+
+    bool IsSinglePrecision() const;
+
+    /// Instruction set of the single precision kernels.
+    static const char* GetInstructionSet();
+
+    class Program;
+
+  private:
+    std::unique_ptr<Program> m_pProgram;
+};
+
+#endif // COMPILEDEXPRESSION_H
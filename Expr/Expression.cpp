@@ -0,0 +1,238 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    Expression.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include "Expression.h"
+
+namespace {
+  typedef std::unique_ptr<ExprNode> NodePtr;
+
+  class Parser {
+    public:
+      explicit Parser(const std::string& s) : m_s(s), m_i(0), m_iVolumes(0) {}
+
+      NodePtr Parse() {
+        NodePtr n = Cond();
+        Skip();
+        if (m_i != m_s.size()) Fail("unexpected input");
+        return n;
+      }
+      size_t Volumes() const {return m_iVolumes;}
+
+    private:
+      void Fail(const std::string& what) const {
+        std::ostringstream err;
+        err << "expression error at character " << m_i+1 << ": " << what;
+        throw std::runtime_error(err.str());
+      }
+      void Skip() {
+        while (m_i < m_s.size() && isspace(static_cast<unsigned char>(m_s[m_i]))) {
+          m_i++;
+        }
+      }
+      bool Accept(const char* token) {
+        Skip();
+        const size_t len = strlen(token);
+        if (m_s.compare(m_i, len, token) != 0) return false;
+        m_i += len;
+        return true;
+      }
+      void Expect(const char* token) {
+        if (!Accept(token)) Fail(std::string("expected '") + token + "'");
+      }
+      static NodePtr Make(ExprNode::Kind k, NodePtr a, NodePtr b = NodePtr(),
+                          NodePtr c = NodePtr()) {
+        NodePtr n(new ExprNode(k));
+        n->a = std::move(a);
+        n->b = std::move(b);
+        n->c = std::move(c);
+        return n;
+      }
+
+      NodePtr Cond() {
+        NodePtr n = Or();
+        if (Accept("?")) {
+          NodePtr t = Cond();
+          Expect(":");
+          n = Make(ExprNode::COND, std::move(n), std::move(t), Cond());
+        }
+        return n;
+      }
+      NodePtr Or() {
+        NodePtr n = And();
+        while (Accept("||")) n = Make(ExprNode::OR, std::move(n), And());
+        return n;
+      }
+      NodePtr And() {
+        NodePtr n = Cmp();
+        while (Accept("&&")) n = Make(ExprNode::AND, std::move(n), Cmp());
+        return n;
+      }
+      NodePtr Cmp() {
+        NodePtr n = Sum();
+        // two character operators first so "<=" is not read as "<"
+        if (Accept("<="))      return Make(ExprNode::LE, std::move(n), Sum());
+        else if (Accept(">=")) return Make(ExprNode::GE, std::move(n), Sum());
+        else if (Accept("==")) return Make(ExprNode::EQ, std::move(n), Sum());
+        else if (Accept("!=")) return Make(ExprNode::NE, std::move(n), Sum());
+        else if (Accept("<"))  return Make(ExprNode::LT, std::move(n), Sum());
+        else if (Accept(">"))  return Make(ExprNode::GT, std::move(n), Sum());
+        return n;
+      }
+      NodePtr Sum() {
+        NodePtr n = Product();
+        for (;;) {
+          if (Accept("+"))      n = Make(ExprNode::ADD, std::move(n), Product());
+          else if (Accept("-")) n = Make(ExprNode::SUB, std::move(n), Product());
+          else return n;
+        }
+      }
+      NodePtr Product() {
+        NodePtr n = Unary();
+        for (;;) {
+          if (Accept("*"))      n = Make(ExprNode::MUL, std::move(n), Unary());
+          else if (Accept("/")) n = Make(ExprNode::DIV, std::move(n), Unary());
+          else return n;
+        }
+      }
+      NodePtr Unary() {
+        if (Accept("-")) return Make(ExprNode::NEG, Unary());
+        // "!=" never starts an operand, so a lone '!' is negation
+        if (Accept("!")) return Make(ExprNode::NOT, Unary());
+        return Primary();
+      }
+      NodePtr Primary() {
+        Skip();
+        if (m_i < m_s.size() && (isdigit(static_cast<unsigned char>(m_s[m_i])) ||
+                                 m_s[m_i] == '.')) {
+          const char* start = m_s.c_str() + m_i;
+          char* end = NULL;
+          NodePtr n(new ExprNode(ExprNode::CONSTANT));
+          n->value = strtod(start, &end);
+          m_i += end - start;
+          return n;
+        }
+        if (Accept("(")) {
+          NodePtr n = Cond();
+          Expect(")");
+          return n;
+        }
+        const bool bMin = Accept("min(");
+        if (bMin || Accept("max(")) {
+          NodePtr a = Cond();
+          Expect(",");
+          NodePtr b = Cond();
+          Expect(")");
+          return Make(bMin ? ExprNode::MIN : ExprNode::MAX, std::move(a),
+                      std::move(b));
+        }
+        if (Accept("abs(")) {
+          NodePtr a = Cond();
+          Expect(")");
+          return Make(ExprNode::ABS, std::move(a));
+        }
+        if (Accept("v")) {
+          Expect("[");
+          Skip();
+          size_t iStart = m_i;
+          while (m_i < m_s.size() && isdigit(static_cast<unsigned char>(m_s[m_i]))) {
+            m_i++;
+          }
+          if (iStart == m_i) Fail("expected a volume index");
+          NodePtr n(new ExprNode(ExprNode::VOLUME));
+          n->volume = size_t(strtoul(m_s.c_str() + iStart, NULL, 10));
+          m_iVolumes = std::max(m_iVolumes, n->volume+1);
+          Expect("]");
+          return n;
+        }
+        Fail("expected a number, volume or '('");
+        return NodePtr();
+      }
+
+      const std::string& m_s;
+      size_t m_i;
+      size_t m_iVolumes;
+  };
+
+  double Eval(const ExprNode& n, const double* v) {
+    switch (n.kind) {
+      case ExprNode::CONSTANT: return n.value;
+      case ExprNode::VOLUME:   return v[n.volume];
+      case ExprNode::NEG:      return -Eval(*n.a, v);
+      case ExprNode::NOT:      return Eval(*n.a, v) == 0.0 ? 1.0 : 0.0;
+      case ExprNode::ABS:      return std::fabs(Eval(*n.a, v));
+      case ExprNode::ADD:      return Eval(*n.a, v) + Eval(*n.b, v);
+      case ExprNode::SUB:      return Eval(*n.a, v) - Eval(*n.b, v);
+      case ExprNode::MUL:      return Eval(*n.a, v) * Eval(*n.b, v);
+      case ExprNode::DIV:      return Eval(*n.a, v) / Eval(*n.b, v);
+      case ExprNode::LT:       return Eval(*n.a, v) <  Eval(*n.b, v) ? 1.0 : 0.0;
+      case ExprNode::GT:       return Eval(*n.a, v) >  Eval(*n.b, v) ? 1.0 : 0.0;
+      case ExprNode::LE:       return Eval(*n.a, v) <= Eval(*n.b, v) ? 1.0 : 0.0;
+      case ExprNode::GE:       return Eval(*n.a, v) >= Eval(*n.b, v) ? 1.0 : 0.0;
+      case ExprNode::EQ:       return Eval(*n.a, v) == Eval(*n.b, v) ? 1.0 : 0.0;
+      case ExprNode::NE:       return Eval(*n.a, v) != Eval(*n.b, v) ? 1.0 : 0.0;
+      case ExprNode::AND:      return (Eval(*n.a, v) != 0.0 && Eval(*n.b, v) != 0.0) ? 1.0 : 0.0;
+      case ExprNode::OR:       return (Eval(*n.a, v) != 0.0 || Eval(*n.b, v) != 0.0) ? 1.0 : 0.0;
+      case ExprNode::MIN:      return std::min(Eval(*n.a, v), Eval(*n.b, v));
+      case ExprNode::MAX:      return std::max(Eval(*n.a, v), Eval(*n.b, v));
+      case ExprNode::COND:     return Eval(*n.a, v) != 0.0 ? Eval(*n.b, v) : Eval(*n.c, v);
+    }
+    return 0.0;
+  }
+}
+
+Expression::Expression(const std::string& strExpression)
+{
+  Parser parser(strExpression);
+  m_Root = parser.Parse();
+  m_iVolumes = parser.Volumes();
+}
+
+Expression::Expression(std::unique_ptr<ExprNode> root, size_t iVolumes) :
+  m_Root(std::move(root)),
+  m_iVolumes(iVolumes)
+{
+}
+
+double Expression::Evaluate(const double* v) const
+{
+  return Eval(*m_Root, v);
+}
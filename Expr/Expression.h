@@ -0,0 +1,93 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    Expression.h
+  \brief   Parser and reference interpreter for volume merge expressions
+           such as "v[0] > 100 ? v[1] : 0".
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <memory>
+#include <string>
+
+/// One node of a parsed expression.
+struct ExprNode {
+  enum Kind {
+    CONSTANT, VOLUME,                 // leaves
+    NEG, NOT, ABS,                    // unary
+    ADD, SUB, MUL, DIV,               // arithmetic
+    LT, GT, LE, GE, EQ, NE, AND, OR,  // logic, yield 0 or 1
+    MIN, MAX,
+    COND                              // a ? b : c
+  };
+
+  explicit ExprNode(Kind k) : kind(k), value(0.0), volume(0) {}
+
+  Kind   kind;
+  double value;   // CONSTANT
+  size_t volume;  // VOLUME: index into the input list
+  std::unique_ptr<ExprNode> a, b, c;
+};
+
+/// Grammar, loosest binding first:
+///   cond    := or [ '?' cond ':' cond ]
+///   or      := and { '||' and }
+///   and     := cmp { '&&' cmp }
+///   cmp     := sum [ ('<'|'>'|'<='|'>='|'=='|'!=') sum ]
+///   sum     := product { ('+'|'-') product }
+///   product := unary { ('*'|'/') unary }
+///   unary   := ('-'|'!') unary | primary
+///   primary := number | 'v[' index ']' | '(' cond ')'
+///            | ('min'|'max') '(' cond ',' cond ')' | 'abs(' cond ')'
+class Expression {
+  public:
+    /// Throws std::runtime_error describing the first syntax error.
+    explicit Expression(const std::string& strExpression);
+    /// Wraps a tree built in code, so constants need not go through text.
+    Expression(std::unique_ptr<ExprNode> root, size_t iVolumes);
+
+    /// Value for one voxel; v[i] is the voxel of input i.
+    double Evaluate(const double* v) const;
+
+    /// Number of inputs referenced, i.e. the largest v index plus one.
+    size_t GetVolumeCount() const {return m_iVolumes;}
+    const ExprNode& GetRoot() const {return *m_Root;}
+
+  private:
+    std::unique_ptr<ExprNode> m_Root;
+    size_t m_iVolumes;
+};
+
+#endif // EXPRESSION_H
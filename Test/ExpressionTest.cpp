@@ -0,0 +1,278 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    ExpressionTest.cpp
+  \brief   Checks the expression parser and compares the compiled kernels
+           with the interpreter for every voxel type.
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Convert/VoxelType.h"
+#include "../Expr/CompiledExpression.h"
+#include "../Expr/Expression.h"
+
+using namespace std;
+
+namespace {
+  int iFailures = 0;
+
+  const char* TypeName(VoxelType t) {
+    const char* names[] = {"uint8", "int8", "uint16", "int16",
+                           "uint32", "int32", "float", "double"};
+    return t < VT_UNSUPPORTED ? names[t] : "unsupported";
+  }
+
+  void Fail(const string& what) {
+    cerr << "FAILED: " << what << "\n";
+    iFailures++;
+  }
+
+  /// Parses and interprets strExpression for v = {3, -2, 10}.
+  void CheckValue(const string& strExpression, double fExpected) {
+    const double v[] = {3.0, -2.0, 10.0};
+    try {
+      const double f = Expression(strExpression).Evaluate(v);
+      if (f != fExpected) {
+        Fail("'" + strExpression + "' gave " + to_string(f) + ", expected " +
+             to_string(fExpected));
+      }
+    } catch (const std::runtime_error& e) {
+      Fail("'" + strExpression + "' threw " + e.what());
+    }
+  }
+
+  void CheckSyntaxError(const string& strExpression) {
+    try {
+      Expression expr(strExpression);
+      Fail("'" + strExpression + "' parsed");
+    } catch (const std::runtime_error&) {
+    }
+  }
+
+  void CheckGrammar() {
+    CheckValue("1+2*3", 7.0);
+    CheckValue("2-3-4", -5.0);
+    CheckValue("8/2/2", 2.0);
+    CheckValue("-v[0]", -3.0);
+    CheckValue("--v[0]", 3.0);
+    CheckValue("- - v[0]", 3.0);
+    CheckValue("-2*3", -6.0);
+    CheckValue("2*-3", -6.0);
+    CheckValue("-(v[0]+1)", -4.0);
+    CheckValue("v[0]--v[1]", 1.0);
+    CheckValue("1e3", 1000.0);
+    CheckValue("2.5e-1", 0.25);
+    CheckValue("1E+2", 100.0);
+    CheckValue(".5", 0.5);
+    CheckValue("v[2]*1e-1", 1.0);
+    CheckValue("v[0] > 2 ? 1 : 0", 1.0);
+    CheckValue("v[1] > 0 ? 1 : v[0] > 2 ? 2 : 3", 2.0);
+    CheckValue("v[0] > 2 ? v[1] > 0 ? 1 : 2 : 3", 2.0);
+    CheckValue("(v[0] > 2 ? 4 : 5) * 2", 8.0);
+    CheckValue("max(max(v[0], v[1]), max(v[2], 4))", 10.0);
+    CheckValue("max(min(v[0], v[1]), -max(v[2], -v[2]))", -2.0);
+    CheckValue("min(v[0], -v[2])", -10.0);
+    CheckValue("abs(v[1])", 2.0);
+    CheckValue("abs(-abs(v[1]))", 2.0);
+    CheckValue("!v[0]", 0.0);
+    CheckValue("!!v[0]", 1.0);
+    CheckValue("!0", 1.0);
+    CheckValue("v[0] != 3", 0.0);
+    CheckValue("v[0] <= 3 && v[1] >= -2", 1.0);
+    CheckValue("0 && 1 || 1", 1.0);
+    CheckValue("(v[1] < 0) == 0", 0.0);
+    CheckValue("  v[ 2 ]  ", 10.0);
+
+    CheckSyntaxError("");
+    CheckSyntaxError("1 +");
+    CheckSyntaxError("1 2");
+    CheckSyntaxError("(1");
+    CheckSyntaxError("1)");
+    CheckSyntaxError("v[");
+    CheckSyntaxError("v[-1]");
+    CheckSyntaxError("v[0");
+    CheckSyntaxError("max(1)");
+    CheckSyntaxError("max(1,2");
+    CheckSyntaxError("1 ? 2");
+    CheckSyntaxError("1 < 2 < 3");
+    CheckSyntaxError("foo");
+    CheckSyntaxError("inf");
+    CheckSyntaxError("nan");
+
+    const Expression counted("v[3] + v[1]");
+    if (counted.GetVolumeCount() != 4) Fail("v[3] + v[1] counts 4 inputs");
+  }
+
+  /// Random voxels of type t, as values every type and a float kernel
+  /// represent exactly: integers in a range a bit wider than the type's,
+  /// so stores clamp, and quarters for floating point types.
+  void FillRandom(VoxelType t, vector<uint8_t>& data, size_t iCount,
+                  std::mt19937& rng) {
+    double fMin = 0.0, fMax = 0.0;
+    switch (t) {
+      case VT_UINT8:  fMin = 0.0;      fMax = 255.0;   break;
+      case VT_INT8:   fMin = -128.0;   fMax = 127.0;   break;
+      case VT_UINT16: fMin = 0.0;      fMax = 65535.0; break;
+      case VT_INT16:  fMin = -32768.0; fMax = 32767.0; break;
+      case VT_UINT32: fMin = 0.0;      fMax = 4294967295.0; break;
+      case VT_INT32:  fMin = -2147483648.0; fMax = 2147483647.0; break;
+      default:        fMin = -1000.0;  fMax = 1000.0;  break;
+    }
+    std::uniform_int_distribution<int64_t> dist(static_cast<int64_t>(fMin),
+                                                static_cast<int64_t>(fMax));
+    vector<double> values(iCount);
+    for (size_t i = 0;i<iCount;i++) {
+      // the type's extremes and zero turn up in every run
+      if (i < 3) {
+        values[i] = i == 0 ? fMin : i == 1 ? fMax : 0.0;
+      } else {
+        values[i] = double(dist(rng));
+      }
+      if (t == VT_FLOAT || t == VT_DOUBLE) values[i] *= 0.25;
+    }
+    data.resize(iCount * GetVoxelTypeSize(t));
+    StoreFromDouble(t, &values[0], &data[0], iCount);
+  }
+
+  /// Runs strExpression on two inputs of types a and b into type out, once
+  /// compiled and once through the interpreter and StoreFromDouble.  With
+  /// bExact the results must match bit for bit, otherwise within float
+  /// precision.
+  void CheckKernel(const string& strExpression, VoxelType a, VoxelType b,
+                   VoxelType out, bool bExact, std::mt19937& rng) {
+    // not a multiple of the block or any SIMD width, so tails are covered
+    const size_t iCount = 1000 + 3;
+    const Expression expr(strExpression);
+    vector<VoxelType> types;
+    types.push_back(a);
+    types.push_back(b);
+    vector<vector<uint8_t>> inputs(2);
+    FillRandom(a, inputs[0], iCount, rng);
+    FillRandom(b, inputs[1], iCount, rng);
+    const uint8_t* pInputs[] = {&inputs[0][0], &inputs[1][0]};
+
+    vector<double> va(iCount), vb(iCount), reference(iCount);
+    LoadAsDouble(a, pInputs[0], &va[0], iCount);
+    LoadAsDouble(b, pInputs[1], &vb[0], iCount);
+    for (size_t i = 0;i<iCount;i++) {
+      const double v[] = {va[i], vb[i]};
+      reference[i] = expr.Evaluate(v);
+    }
+    vector<uint8_t> expected(iCount * GetVoxelTypeSize(out));
+    StoreFromDouble(out, &reference[0], &expected[0], iCount);
+
+    const CompiledExpression kernel(expr, types, out);
+    vector<uint8_t> compiled(expected.size());
+    vector<uint8_t> scratch;
+    kernel.Evaluate(pInputs, iCount, &compiled[0], scratch);
+
+    vector<double> e(iCount), c(iCount);
+    LoadAsDouble(out, &expected[0], &e[0], iCount);
+    LoadAsDouble(out, &compiled[0], &c[0], iCount);
+    const bool bFloatOut = out == VT_FLOAT || out == VT_DOUBLE;
+    for (size_t i = 0;i<iCount;i++) {
+      if (std::isnan(e[i]) && std::isnan(c[i])) continue;
+      const double fDiff = std::fabs(e[i] - c[i]);
+      const double fTolerance = bExact ? 0.0 :
+        bFloatOut ? 1e-5 * std::max(1.0, std::fabs(e[i])) : 1.0;
+      if (!(fDiff <= fTolerance)) {
+        Fail("'" + strExpression + "' " + TypeName(a) + "," + TypeName(b) +
+             " -> " + TypeName(out) + " (" +
+             (kernel.IsSinglePrecision() ? "single" : "double") +
+             ") voxel " + to_string(i) + ": " + to_string(c[i]) +
+             ", expected " + to_string(e[i]));
+        return;
+      }
+    }
+  }
+
+  void CheckKernels() {
+    // exact in float for the values FillRandom makes: sums and halves of
+    // integers below 2^17, comparisons, selections and stores that round
+    // and clamp; constant subtrees fold
+    const char* exact[] = {
+      "v[0]",
+      "v[0] + v[1]",
+      "(v[0] + v[1]) * 0.5",
+      "-v[0] - 3",
+      "v[0] * 0.5 + 0.25",
+      "v[0] * 300 - 1000",
+      "abs(v[0] - v[1])",
+      "max(min(v[0], v[1]), -(2 + 3) * 4)",
+      "v[0] > v[1] ? v[0] : v[1] * 0.5",
+      "v[0] >= 0 && v[1] < 0 || !v[0]",
+      "(v[0] == v[1]) + (v[0] != 0) + (v[1] <= 7)",
+      "(1 + 2) * 4 > 11 ? v[0] : v[1]",
+    };
+    // rounded differently by float kernels
+    const char* inexact[] = {
+      "v[0] / (abs(v[1]) + 1) * 3.3",
+      "v[0] * v[1] * 0.001",
+    };
+
+    std::mt19937 rng(42);
+    for (int a = 0;a<VT_UNSUPPORTED;a++) {
+      for (int out = 0;out<VT_UNSUPPORTED;out++) {
+        // same input types, and a second input of the next type
+        const VoxelType b[] = {VoxelType(a), VoxelType((a+1) % VT_UNSUPPORTED)};
+        for (int i = 0;i<2;i++) {
+          for (size_t e = 0;e<sizeof(exact)/sizeof(exact[0]);e++) {
+            // 32 bit sums need more than a float's mantissa; those
+            // types run in double precision, where everything is exact
+            CheckKernel(exact[e], VoxelType(a), b[i], VoxelType(out), true, rng);
+          }
+          for (size_t e = 0;e<sizeof(inexact)/sizeof(inexact[0]);e++) {
+            CheckKernel(inexact[e], VoxelType(a), b[i], VoxelType(out), false, rng);
+          }
+        }
+      }
+    }
+  }
+}
+
+int main()
+{
+  CheckGrammar();
+  CheckKernels();
+  cout << "Kernels: " << CompiledExpression::GetInstructionSet() << "\n";
+  if (iFailures != 0) {
+    cout << iFailures << " checks failed\n";
+    return EXIT_FAILURE;
+  }
+  cout << "All checks passed\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,577 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    AsyncWriter.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "AsyncWriter.h"
+
+#ifdef _WIN32
+# include <fcntl.h>
+# include <io.h>
+# include <malloc.h>
+# include <sys/stat.h>
+#else
+# include <fcntl.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+# if __has_include(<linux/io_uring.h>)
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <sys/uio.h>
+#  if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#   define HAVE_IO_URING
+#  endif
+# endif
+#endif
+
+namespace {
+  /// Direct I/O needs offsets, sizes and buffers aligned to the logical
+  /// block size; a page covers every common device and keeps the page
+  /// cache and direct writes off each other's pages.
+  const uint64_t ALIGN = 4096;
+  const size_t NONE = size_t(-1);
+
+  AsyncFileWriter::Backend s_eDefaultBackend = AsyncFileWriter::BACKEND_AUTO;
+  bool s_bDefaultDirect = false;
+
+  uint64_t AlignDown(uint64_t i) {return i - i % ALIGN;}
+  uint64_t AlignUp(uint64_t i) {return AlignDown(i + ALIGN - 1);}
+
+  uint8_t* AllocAligned(size_t iBytes) {
+#ifdef _WIN32
+    return static_cast<uint8_t*>(_aligned_malloc(iBytes, size_t(ALIGN)));
+#else
+    void* p = NULL;
+    return posix_memalign(&p, size_t(ALIGN), iBytes) == 0
+      ? static_cast<uint8_t*>(p) : NULL;
+#endif
+  }
+
+  void FreeAligned(uint8_t* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+  }
+
+  bool PWriteAll(int iFile, const uint8_t* p, size_t iBytes, uint64_t iOffset) {
+#ifdef _WIN32
+    if (_lseeki64(iFile, __int64(iOffset), SEEK_SET) < 0) return false;
+    while (iBytes > 0) {
+      const int n = _write(iFile, p, unsigned(std::min<size_t>(iBytes, 1<<30)));
+      if (n <= 0) return false;
+      p += n;
+      iBytes -= size_t(n);
+    }
+#else
+    while (iBytes > 0) {
+      const ssize_t n = pwrite(iFile, p, iBytes, off_t(iOffset));
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      p += n;
+      iBytes -= size_t(n);
+      iOffset += uint64_t(n);
+    }
+#endif
+    return true;
+  }
+}
+
+#ifdef HAVE_IO_URING
+struct AsyncFileWriter::Ring {
+  int           iFd;
+  void*         pSq;
+  size_t        iSqBytes;
+  void*         pCq;
+  size_t        iCqBytes;
+  io_uring_sqe* pSqes;
+  size_t        iSqesBytes;
+  unsigned*     pSqTail;
+  unsigned*     pSqMask;
+  unsigned*     pSqArray;
+  unsigned*     pCqHead;
+  unsigned*     pCqTail;
+  unsigned*     pCqMask;
+  io_uring_cqe* pCqes;
+  std::vector<iovec> iov;
+  /// Set once io_uring_enter failed; a request may then be stuck in the
+  /// ring, so it is not entered again.
+  bool          bBroken;
+};
+#else
+struct AsyncFileWriter::Ring {};
+#endif
+
+bool AsyncFileWriter::ParseBackend(const std::string& strName, Backend& eBackend)
+{
+  for (int i = BACKEND_AUTO;i<=BACKEND_SYNC;i++) {
+    if (strName == BackendName(Backend(i))) {
+      eBackend = Backend(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* AsyncFileWriter::BackendName(Backend eBackend)
+{
+  switch (eBackend) {
+    case BACKEND_AUTO:    return "auto";
+    case BACKEND_URING:   return "uring";
+    case BACKEND_THREADS: return "threads";
+    case BACKEND_SYNC:    return "sync";
+  }
+  return "";
+}
+
+void AsyncFileWriter::SetDefaults(Backend eBackend, bool bDirect)
+{
+  s_eDefaultBackend = eBackend;
+  s_bDefaultDirect = bDirect;
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::string& strFilename, bool bTruncate) :
+  AsyncFileWriter(strFilename, bTruncate, s_eDefaultBackend, s_bDefaultDirect)
+{
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::string& strFilename, bool bTruncate,
+                                 Backend eBackend, bool bDirect,
+                                 size_t iBlockBytes, size_t iDepth) :
+  m_eBackend(eBackend),
+  m_iFile(-1),
+  m_iDirectFile(-1),
+  m_iBlockBytes(size_t(AlignUp(std::max<uint64_t>(iBlockBytes, ALIGN)))),
+  m_iInFlight(0),
+  m_bFailed(false),
+  m_iRun(NONE),
+  m_iRunBase(0),
+  m_iRunStart(0),
+  m_iRunEnd(0),
+  m_bStopping(false),
+  m_pRing(NULL)
+{
+  Open(strFilename, bTruncate, bDirect);
+  if (!IsOpen()) return;
+
+  // one block gathers while the others are on their way to the disk
+  m_Blocks.resize(std::max<size_t>(iDepth, 1) + 1);
+  for (size_t i = 0;i<m_Blocks.size();i++) {
+    m_Blocks[i].pData = AllocAligned(m_iBlockBytes + size_t(ALIGN));
+    if (!m_Blocks[i].pData) m_bFailed = true;
+    m_Free.push_back(i);
+  }
+
+#ifdef _WIN32
+  m_eBackend = BACKEND_SYNC;
+#endif
+  if (m_eBackend == BACKEND_AUTO || m_eBackend == BACKEND_URING) {
+    m_eBackend = OpenRing() ? BACKEND_URING : BACKEND_THREADS;
+  }
+  if (m_eBackend == BACKEND_THREADS) {
+    const size_t iThreads = std::min<size_t>(m_Blocks.size() - 1, 4);
+    for (size_t i = 0;i<iThreads;i++) {
+      m_Threads.push_back(std::thread(&AsyncFileWriter::ThreadLoop, this));
+    }
+  }
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+  Close();
+}
+
+void AsyncFileWriter::Open(const std::string& strFilename, bool bTruncate,
+                           bool bDirect)
+{
+#ifdef _WIN32
+  m_iFile = _open(strFilename.c_str(),
+                  _O_WRONLY | _O_CREAT | _O_BINARY | (bTruncate ? _O_TRUNC : 0),
+                  _S_IREAD | _S_IWRITE);
+  (void)bDirect;
+#else
+  m_iFile = open(strFilename.c_str(),
+                 O_WRONLY | O_CREAT | (bTruncate ? O_TRUNC : 0), 0644);
+# ifdef O_DIRECT
+  // file systems without direct I/O, tmpfs for one, refuse the open
+  if (m_iFile >= 0 && bDirect) {
+    m_iDirectFile = open(strFilename.c_str(), O_WRONLY | O_DIRECT);
+  }
+# else
+  (void)bDirect;
+# endif
+#endif
+}
+
+bool AsyncFileWriter::Write(uint64_t iOffset, const void* pData, size_t iBytes)
+{
+  const uint8_t* p = static_cast<const uint8_t*>(pData);
+  const size_t iCapacity = m_iBlockBytes + size_t(ALIGN);
+  while (iBytes > 0 && !m_bFailed) {
+    if (m_iRun == NONE || iOffset != m_iRunEnd) {
+      if (m_iRun != NONE) SubmitRun(false);
+      m_iRun = AcquireBlock();
+      if (m_iRun == NONE) break;
+      // a direct run starts at a page so its aligned middle stays aligned
+      // in memory too
+      m_iRunBase = IsDirect() ? AlignDown(iOffset) : iOffset;
+      m_iRunStart = m_iRunEnd = iOffset;
+    }
+    const size_t n = std::min(iBytes, iCapacity - size_t(m_iRunEnd - m_iRunBase));
+    memcpy(m_Blocks[m_iRun].pData + (m_iRunEnd - m_iRunBase), p, n);
+    m_iRunEnd += n;
+    iOffset += n;
+    p += n;
+    iBytes -= n;
+    if (m_iRunEnd - m_iRunBase == iCapacity) SubmitRun(true);
+  }
+  return !m_bFailed;
+}
+
+void AsyncFileWriter::SubmitRun(bool bKeepTail)
+{
+  const size_t iRun = m_iRun;
+  Block& block = m_Blocks[iRun];
+  const uint64_t iBase = m_iRunBase;
+  const uint64_t iStart = m_iRunStart;
+  const uint64_t iEnd = m_iRunEnd;
+  m_iRun = NONE;
+
+  uint64_t iFirst = iStart;
+  uint64_t iLast = iEnd;
+  if (IsDirect()) {
+    iFirst = std::min(AlignUp(iStart), iEnd);
+    iLast = std::max(AlignDown(iEnd), iFirst);
+    if (iFirst > iStart &&
+        !PWriteAll(m_iFile, block.pData + (iStart - iBase),
+                   size_t(iFirst - iStart), iStart)) {
+      m_bFailed = true;
+    }
+  }
+
+  if (iLast > iFirst) {
+    block.iSkip = size_t(iFirst - iBase);
+    block.iOffset = iFirst;
+    block.iBytes = size_t(iLast - iFirst);
+    block.iFile = IsDirect() ? m_iDirectFile : m_iFile;
+    Submit(iRun);
+  }
+
+  if (iEnd > iLast) {
+    if (bKeepTail) {
+      // the kernel only reads [iFirst, iLast) of the submitted block
+      const size_t iNext = AcquireBlock();
+      if (iNext != NONE) {
+        memcpy(m_Blocks[iNext].pData, block.pData + (iLast - iBase),
+               size_t(iEnd - iLast));
+        m_iRun = iNext;
+        m_iRunBase = m_iRunStart = iLast;
+        m_iRunEnd = iEnd;
+      }
+    } else if (!PWriteAll(m_iFile, block.pData + (iLast - iBase),
+                          size_t(iEnd - iLast), iLast)) {
+      m_bFailed = true;
+    }
+  }
+
+  if (iLast == iFirst) {
+    std::lock_guard<std::mutex> lock(m_Guard);
+    m_Free.push_back(iRun);
+  }
+}
+
+bool AsyncFileWriter::WriteBlock(const Block& block, size_t iDone)
+{
+  const uint8_t* p = block.pData + block.iSkip + iDone;
+  const size_t iBytes = block.iBytes - iDone;
+  const uint64_t iOffset = block.iOffset + iDone;
+  if (PWriteAll(block.iFile, p, iBytes, iOffset)) return true;
+  // some file systems accept O_DIRECT but not the writes
+  return block.iFile != m_iFile && PWriteAll(m_iFile, p, iBytes, iOffset);
+}
+
+void AsyncFileWriter::Submit(size_t iBlock)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Guard);
+    m_iInFlight++;
+    if (m_eBackend == BACKEND_THREADS) {
+      m_Pending.push_back(iBlock);
+      m_Changed.notify_one();
+      return;
+    }
+  }
+
+  if (m_eBackend == BACKEND_SYNC) {
+    Completed(iBlock, WriteBlock(m_Blocks[iBlock]));
+    return;
+  }
+
+#ifdef HAVE_IO_URING
+  Ring& ring = *m_pRing;
+  if (ring.bBroken) {
+    Completed(iBlock, false);
+    return;
+  }
+  const Block& block = m_Blocks[iBlock];
+  // at most one request per block is in flight, the ring has room for all
+  const unsigned iTail = *ring.pSqTail;
+  const unsigned iIndex = iTail & *ring.pSqMask;
+  io_uring_sqe& sqe = ring.pSqes[iIndex];
+  memset(&sqe, 0, sizeof(sqe));
+  ring.iov[iBlock].iov_base = block.pData + block.iSkip;
+  ring.iov[iBlock].iov_len = block.iBytes;
+  sqe.opcode = IORING_OP_WRITEV;
+  sqe.fd = block.iFile;
+  sqe.off = block.iOffset;
+  sqe.addr = uint64_t(reinterpret_cast<uintptr_t>(&ring.iov[iBlock]));
+  sqe.len = 1;
+  sqe.user_data = iBlock;
+  ring.pSqArray[iIndex] = iIndex;
+  __atomic_store_n(ring.pSqTail, iTail + 1, __ATOMIC_RELEASE);
+
+  long iResult;
+  do {
+    iResult = syscall(__NR_io_uring_enter, ring.iFd, 1, 0, 0, NULL, 0);
+  } while (iResult < 0 && errno == EINTR);
+  if (iResult < 0) {
+    ring.bBroken = true;
+    Completed(iBlock, false);
+  }
+#endif
+}
+
+void AsyncFileWriter::Completed(size_t iBlock, bool bOk)
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_Free.push_back(iBlock);
+  m_iInFlight--;
+  if (!bOk) m_bFailed = true;
+  m_Changed.notify_all();
+}
+
+size_t AsyncFileWriter::AcquireBlock()
+{
+  std::unique_lock<std::mutex> lock(m_Guard);
+  while (m_Free.empty()) {
+    if (m_eBackend == BACKEND_URING) {
+      lock.unlock();
+      if (!Reap(true)) return NONE;
+      lock.lock();
+    } else {
+      m_Changed.wait(lock);
+    }
+  }
+  const size_t iBlock = m_Free.back();
+  m_Free.pop_back();
+  return iBlock;
+}
+
+bool AsyncFileWriter::Reap(bool bWait)
+{
+#ifdef HAVE_IO_URING
+  Ring& ring = *m_pRing;
+  if (ring.bBroken) return false;
+  if (bWait) {
+    long iResult;
+    do {
+      iResult = syscall(__NR_io_uring_enter, ring.iFd, 0, 1,
+                        IORING_ENTER_GETEVENTS, NULL, 0);
+    } while (iResult < 0 && errno == EINTR);
+    if (iResult < 0) {
+      ring.bBroken = true;
+      m_bFailed = true;
+      return false;
+    }
+  }
+
+  unsigned iHead = *ring.pCqHead;
+  const unsigned iTail = __atomic_load_n(ring.pCqTail, __ATOMIC_ACQUIRE);
+  for (;iHead != iTail;iHead++) {
+    const io_uring_cqe& cqe = ring.pCqes[iHead & *ring.pCqMask];
+    const size_t iBlock = size_t(cqe.user_data);
+    const Block& block = m_Blocks[iBlock];
+    // finish short or refused writes synchronously
+    bool bOk = true;
+    if (cqe.res < 0) {
+      bOk = WriteBlock(block);
+    } else if (size_t(cqe.res) < block.iBytes) {
+      bOk = WriteBlock(block, size_t(cqe.res));
+    }
+    Completed(iBlock, bOk);
+  }
+  __atomic_store_n(ring.pCqHead, iHead, __ATOMIC_RELEASE);
+  return true;
+#else
+  (void)bWait;
+  return false;
+#endif
+}
+
+void AsyncFileWriter::ThreadLoop()
+{
+  std::unique_lock<std::mutex> lock(m_Guard);
+  for (;;) {
+    m_Changed.wait(lock, [&]() {return m_bStopping || !m_Pending.empty();});
+    if (m_Pending.empty()) return;
+    const size_t iBlock = m_Pending.front();
+    m_Pending.pop_front();
+    lock.unlock();
+    const bool bOk = WriteBlock(m_Blocks[iBlock]);
+    lock.lock();
+    m_Free.push_back(iBlock);
+    m_iInFlight--;
+    if (!bOk) m_bFailed = true;
+    m_Changed.notify_all();
+  }
+}
+
+bool AsyncFileWriter::Flush()
+{
+  if (!IsOpen()) return false;
+  if (m_iRun != NONE) SubmitRun(false);
+  if (m_eBackend == BACKEND_URING) {
+    while (m_iInFlight > 0 && Reap(true)) {}
+  } else {
+    std::unique_lock<std::mutex> lock(m_Guard);
+    m_Changed.wait(lock, [&]() {return m_iInFlight == 0;});
+  }
+  return !m_bFailed;
+}
+
+bool AsyncFileWriter::Close()
+{
+  if (!IsOpen()) return false;
+  bool bOk = Flush();
+
+  {
+    std::lock_guard<std::mutex> lock(m_Guard);
+    m_bStopping = true;
+  }
+  m_Changed.notify_all();
+  for (size_t i = 0;i<m_Threads.size();i++) m_Threads[i].join();
+  m_Threads.clear();
+  CloseRing();
+
+#ifdef _WIN32
+  bOk = _close(m_iFile) == 0 && bOk;
+#else
+  if (m_iDirectFile >= 0) bOk = close(m_iDirectFile) == 0 && bOk;
+  bOk = close(m_iFile) == 0 && bOk;
+#endif
+  m_iFile = m_iDirectFile = -1;
+
+  for (size_t i = 0;i<m_Blocks.size();i++) FreeAligned(m_Blocks[i].pData);
+  m_Blocks.clear();
+  m_Free.clear();
+  return bOk;
+}
+
+bool AsyncFileWriter::OpenRing()
+{
+#ifdef HAVE_IO_URING
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  // containers and older kernels often refuse io_uring
+  const long iFd = syscall(__NR_io_uring_setup, unsigned(m_Blocks.size()),
+                           &params);
+  if (iFd < 0) return false;
+
+  Ring* pRing = new Ring();
+  pRing->iFd = int(iFd);
+  pRing->bBroken = false;
+  pRing->iSqBytes = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+  pRing->iCqBytes = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+  bool bSingleMap = false;
+# ifdef IORING_FEAT_SINGLE_MMAP
+  bSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+# endif
+  if (bSingleMap) {
+    pRing->iSqBytes = pRing->iCqBytes = std::max(pRing->iSqBytes,
+                                                 pRing->iCqBytes);
+  }
+  pRing->iSqesBytes = params.sq_entries*sizeof(io_uring_sqe);
+
+  pRing->pSq = mmap(NULL, pRing->iSqBytes, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, pRing->iFd, IORING_OFF_SQ_RING);
+  pRing->pCq = bSingleMap ? pRing->pSq
+                          : mmap(NULL, pRing->iCqBytes, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, pRing->iFd,
+                                 IORING_OFF_CQ_RING);
+  void* pSqes = mmap(NULL, pRing->iSqesBytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, pRing->iFd, IORING_OFF_SQES);
+  pRing->pSqes = pSqes == MAP_FAILED ? NULL : static_cast<io_uring_sqe*>(pSqes);
+  m_pRing = pRing;
+  if (pRing->pSq == MAP_FAILED || pRing->pCq == MAP_FAILED || !pRing->pSqes) {
+    CloseRing();
+    return false;
+  }
+
+  char* pSq = static_cast<char*>(pRing->pSq);
+  char* pCq = static_cast<char*>(pRing->pCq);
+  pRing->pSqTail = reinterpret_cast<unsigned*>(pSq + params.sq_off.tail);
+  pRing->pSqMask = reinterpret_cast<unsigned*>(pSq + params.sq_off.ring_mask);
+  pRing->pSqArray = reinterpret_cast<unsigned*>(pSq + params.sq_off.array);
+  pRing->pCqHead = reinterpret_cast<unsigned*>(pCq + params.cq_off.head);
+  pRing->pCqTail = reinterpret_cast<unsigned*>(pCq + params.cq_off.tail);
+  pRing->pCqMask = reinterpret_cast<unsigned*>(pCq + params.cq_off.ring_mask);
+  pRing->pCqes = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+  pRing->iov.resize(m_Blocks.size());
+  return true;
+#else
+  return false;
+#endif
+}
+
+void AsyncFileWriter::CloseRing()
+{
+#ifdef HAVE_IO_URING
+  if (!m_pRing) return;
+  if (m_pRing->pSqes) munmap(m_pRing->pSqes, m_pRing->iSqesBytes);
+  if (m_pRing->pCq != MAP_FAILED && m_pRing->pCq != m_pRing->pSq) {
+    munmap(m_pRing->pCq, m_pRing->iCqBytes);
+  }
+  if (m_pRing->pSq != MAP_FAILED) munmap(m_pRing->pSq, m_pRing->iSqBytes);
+  close(m_pRing->iFd);
+#endif
+  delete m_pRing;
+  m_pRing = NULL;
+}
@@ -0,0 +1,153 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    AsyncWriter.h
+  \brief   Positioned file output that overlaps the disk with the caller.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Writes a file at arbitrary offsets without waiting for the disk.
+/// Contiguous writes are gathered into blocks of a few MB, which go out
+/// through io_uring or a few pwrite threads while the caller fills the
+/// next block; Write() only blocks once every block is in flight.  With
+/// direct I/O the page aligned middle of each block bypasses the page
+/// cache, the unaligned ends are written through it.
+class AsyncFileWriter {
+  public:
+    enum Backend {
+      BACKEND_AUTO,     ///< io_uring if the kernel allows it, else threads
+      BACKEND_URING,
+      BACKEND_THREADS,
+      BACKEND_SYNC      ///< plain pwrite on the calling thread
+    };
+
+    /// Accepts "auto", "uring", "threads" and "sync".
+    static bool ParseBackend(const std::string& strName, Backend& eBackend);
+    static const char* BackendName(Backend eBackend);
+
+    /// Backend and direct I/O used by the two argument constructor.
+    static void SetDefaults(Backend eBackend, bool bDirect);
+
+    /// Opens strFilename for writing, creating it if needed and emptying
+    /// it with bTruncate; check IsOpen() afterwards.  Backends that are not
+    /// available fall back to threads, then to sync, and direct I/O is
+    /// dropped where the file system refuses it.
+    AsyncFileWriter(const std::string& strFilename, bool bTruncate);
+    AsyncFileWriter(const std::string& strFilename, bool bTruncate,
+                    Backend eBackend, bool bDirect,
+                    size_t iBlockBytes = size_t(2) << 20, size_t iDepth = 8);
+    ~AsyncFileWriter();
+
+    bool IsOpen() const {return m_iFile >= 0;}
+    /// The backend actually in use, never BACKEND_AUTO.
+    Backend GetBackend() const {return m_eBackend;}
+    bool IsDirect() const {return m_iDirectFile >= 0;}
+
+    /// Copies iBytes to iOffset; pData may be reused when this returns.
+    /// Not thread safe.  Returns false once any write failed.
+    bool Write(uint64_t iOffset, const void* pData, size_t iBytes);
+
+    /// Returns once everything written so far has reached the OS.
+    bool Flush();
+
+    /// Flushes and closes the file.
+    bool Close();
+
+  private:
+    /// A buffer of iBlockBytes plus one page; once submitted, iBytes
+    /// from pData+iSkip go to iOffset in iFile.
+    struct Block {
+      uint8_t* pData;
+      size_t   iSkip;
+      uint64_t iOffset;
+      size_t   iBytes;
+      int      iFile;
+    };
+
+    AsyncFileWriter(const AsyncFileWriter&);
+    AsyncFileWriter& operator=(const AsyncFileWriter&);
+
+    void Open(const std::string& strFilename, bool bTruncate, bool bDirect);
+    bool OpenRing();
+    void CloseRing();
+    /// Hands the gathered run to the backend; with bKeepTail its last,
+    /// unaligned bytes start the next run instead of going out now.
+    void SubmitRun(bool bKeepTail);
+    void Submit(size_t iBlock);
+    /// Waits for a block to come back and returns its index.
+    size_t AcquireBlock();
+    bool WriteBlock(const Block& block, size_t iDone = 0);
+    void Completed(size_t iBlock, bool bOk);
+    /// Collects finished io_uring writes, with bWait at least one.
+    /// Fails if the ring itself broke.
+    bool Reap(bool bWait);
+    void ThreadLoop();
+
+    Backend             m_eBackend;
+    int                 m_iFile;
+    int                 m_iDirectFile;
+    size_t              m_iBlockBytes;
+    std::vector<Block>  m_Blocks;
+    std::vector<size_t> m_Free;
+    size_t              m_iInFlight;
+    std::atomic<bool>   m_bFailed;
+
+    // the block being gathered
+    size_t   m_iRun;
+    uint64_t m_iRunBase;
+    uint64_t m_iRunStart;
+    uint64_t m_iRunEnd;
+
+    // BACKEND_THREADS
+    std::mutex              m_Guard;
+    std::condition_variable m_Changed;
+    std::deque<size_t>      m_Pending;
+    std::vector<std::thread> m_Threads;
+    bool                    m_bStopping;
+
+    // BACKEND_URING
+    struct Ring;
+    Ring* m_pRing;
+};
+
+#endif // ASYNCWRITER_H
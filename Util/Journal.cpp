@@ -0,0 +1,124 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    Journal.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "Journal.h"
+#include "ProcessStats.h"
+
+namespace {
+  const char* const HEADER = "TuvokDataConverter journal 1";
+}
+
+Journal::Journal(const std::string& strFilename,
+                 const std::string& strSignature) :
+  m_strFilename(strFilename),
+  m_iSignature(Hash(strSignature)),
+  m_bResumed(false)
+{
+  std::ifstream in(strFilename.c_str());
+  std::string line;
+  if (!std::getline(in, line) || line != HEADER) return;
+
+  uint64_t iSignature = 0;
+  std::string key;
+  if (!(in >> key >> iSignature) || key != "signature" ||
+      iSignature != m_iSignature) {
+    return;
+  }
+  uint64_t iValue;
+  while (in >> key >> iValue) m_Values[key] = iValue;
+  m_bResumed = true;
+}
+
+uint64_t Journal::Get(const std::string& strKey, uint64_t iDefault) const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  auto v = m_Values.find(strKey);
+  return v == m_Values.end() ? iDefault : v->second;
+}
+
+bool Journal::Set(const std::string& strKey, uint64_t iValue)
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_Values[strKey] = iValue;
+  return Save();
+}
+
+bool Journal::Save() const
+{
+  const std::string strTemp = m_strFilename + ".tmp";
+  {
+    std::ofstream out(strTemp.c_str(), std::ios::trunc);
+    out << HEADER << "\n" << "signature " << m_iSignature << "\n";
+    for (auto v = m_Values.cbegin(); v != m_Values.cend(); ++v) {
+      out << v->first << " " << v->second << "\n";
+    }
+    out.close();
+    if (out.fail()) return false;
+  }
+#ifdef _WIN32
+  // rename() does not replace an existing file on Windows
+  std::remove(m_strFilename.c_str());
+#endif
+  return std::rename(strTemp.c_str(), m_strFilename.c_str()) == 0;
+}
+
+void Journal::Remove()
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  std::remove(m_strFilename.c_str());
+  m_Values.clear();
+}
+
+uint64_t Journal::Hash(const std::string& str)
+{
+  // 64 bit FNV-1a
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0;i<str.size();i++) {
+    h ^= uint8_t(str[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+std::string Journal::FileStamp(const std::string& strFilename)
+{
+  std::ostringstream stamp;
+  stamp << ProcessStats::FileSize(strFilename) << " "
+        << ProcessStats::FileModificationTime(strFilename);
+  return stamp.str();
+}
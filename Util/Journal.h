@@ -0,0 +1,86 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    Journal.h
+  \brief   Persistent progress record that lets an interrupted conversion
+           continue where it stopped.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/// A few named counters kept in a small text file.  Every Set() rewrites
+/// the file and renames it into place, so a run killed at any point leaves
+/// either the old or the new state behind.
+///
+/// The journal remembers a hash of the signature it was created with.  A
+/// file written for another signature, i.e. other inputs or settings, is
+/// ignored and replaced.
+class Journal {
+  public:
+    Journal(const std::string& strFilename, const std::string& strSignature);
+
+    /// True if an existing journal for the same signature was loaded.
+    bool IsResumed() const {return m_bResumed;}
+    const std::string& GetFilename() const {return m_strFilename;}
+
+    uint64_t Get(const std::string& strKey, uint64_t iDefault = 0) const;
+    /// Stores and persists a value; safe to call from several threads.
+    bool Set(const std::string& strKey, uint64_t iValue);
+
+    /// Deletes the file, typically once the conversion succeeded.
+    void Remove();
+
+    /// "size mtime" of a file, for building signatures that change when an
+    /// input does.
+    static std::string FileStamp(const std::string& strFilename);
+    /// Hash of a signature, stable across runs and platforms unlike
+    /// std::hash.
+    static uint64_t Hash(const std::string& str);
+
+  private:
+    bool Save() const;
+
+    std::string m_strFilename;
+    uint64_t    m_iSignature;
+    bool        m_bResumed;
+    std::map<std::string, uint64_t> m_Values;
+    mutable std::mutex m_Guard;
+};
+
+#endif // JOURNAL_H
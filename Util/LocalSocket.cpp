@@ -0,0 +1,240 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    LocalSocket.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "LocalSocket.h"
+
+#ifndef _WIN32
+# include <poll.h>
+# include <sys/socket.h>
+# include <sys/time.h>
+# include <sys/stat.h>
+# include <sys/un.h>
+# include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+#ifndef _WIN32
+  bool MakeAddress(const std::string& strPath, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strPath.empty() || strPath.size() >= sizeof(address.sun_path)) {
+      return false;
+    }
+    memcpy(address.sun_path, strPath.c_str(), strPath.size());
+    return true;
+  }
+
+  int OpenSocket() {
+    const int s = socket(AF_UNIX, SOCK_STREAM, 0);
+# ifdef SO_NOSIGPIPE
+    if (s >= 0) {
+      const int iOn = 1;
+      setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &iOn, sizeof(iOn));
+    }
+# endif
+    return s;
+  }
+#endif
+}
+
+LocalSocket::LocalSocket() :
+  m_iSocket(-1)
+{
+}
+
+LocalSocket::~LocalSocket()
+{
+  Close();
+}
+
+bool LocalSocket::Listen(const std::string& strPath)
+{
+#ifndef _WIN32
+  Close();
+  sockaddr_un address;
+  if (!MakeAddress(strPath, address)) return false;
+
+  // a socket file nobody accepts on is left over from a server that died;
+  // anything else at strPath is not ours to remove
+  struct stat info;
+  if (lstat(strPath.c_str(), &info) == 0) {
+    LocalSocket probe;
+    if (!S_ISSOCK(info.st_mode) || probe.Connect(strPath)) return false;
+    std::remove(strPath.c_str());
+  }
+
+  m_iSocket = OpenSocket();
+  if (m_iSocket < 0) return false;
+  if (bind(m_iSocket, reinterpret_cast<const sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(m_iSocket, 16) != 0) {
+    Close();
+    return false;
+  }
+  m_strPath = strPath;
+  return true;
+#else
+  (void)strPath;
+  return false;
+#endif
+}
+
+bool LocalSocket::Connect(const std::string& strPath)
+{
+#ifndef _WIN32
+  Close();
+  sockaddr_un address;
+  if (!MakeAddress(strPath, address)) return false;
+  m_iSocket = OpenSocket();
+  if (m_iSocket < 0) return false;
+  if (connect(m_iSocket, reinterpret_cast<const sockaddr*>(&address),
+              sizeof(address)) != 0) {
+    Close();
+    return false;
+  }
+  return true;
+#else
+  (void)strPath;
+  return false;
+#endif
+}
+
+bool LocalSocket::Accept(LocalSocket& client)
+{
+#ifndef _WIN32
+  client.Close();
+  int s;
+  do {
+    s = accept(m_iSocket, NULL, NULL);
+  } while (s < 0 && errno == EINTR);
+  if (s < 0) return false;
+# ifdef SO_NOSIGPIPE
+  const int iOn = 1;
+  setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &iOn, sizeof(iOn));
+# endif
+  client.m_iSocket = s;
+  return true;
+#else
+  (void)client;
+  return false;
+#endif
+}
+
+bool LocalSocket::WaitForClient(int iMilliseconds)
+{
+#ifndef _WIN32
+  pollfd fd;
+  fd.fd = m_iSocket;
+  fd.events = POLLIN;
+  fd.revents = 0;
+  return poll(&fd, 1, iMilliseconds) > 0;
+#else
+  (void)iMilliseconds;
+  return false;
+#endif
+}
+
+bool LocalSocket::SetReadTimeout(int iMilliseconds)
+{
+#ifndef _WIN32
+  timeval timeout;
+  timeout.tv_sec = iMilliseconds / 1000;
+  timeout.tv_usec = (iMilliseconds % 1000) * 1000;
+  return setsockopt(m_iSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                    sizeof(timeout)) == 0;
+#else
+  (void)iMilliseconds;
+  return false;
+#endif
+}
+
+void LocalSocket::Close()
+{
+#ifndef _WIN32
+  if (m_iSocket >= 0) close(m_iSocket);
+  if (!m_strPath.empty()) std::remove(m_strPath.c_str());
+#endif
+  m_iSocket = -1;
+  m_strPath.clear();
+  m_strBuffer.clear();
+}
+
+bool LocalSocket::ReadLine(std::string& strLine)
+{
+#ifndef _WIN32
+  for (;;) {
+    const size_t iEnd = m_strBuffer.find('\n');
+    if (iEnd != std::string::npos) {
+      strLine = m_strBuffer.substr(0, iEnd);
+      m_strBuffer.erase(0, iEnd + 1);
+      return true;
+    }
+    char buffer[4096];
+    const ssize_t n = recv(m_iSocket, buffer, sizeof(buffer), 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    m_strBuffer.append(buffer, size_t(n));
+  }
+#else
+  (void)strLine;
+  return false;
+#endif
+}
+
+bool LocalSocket::WriteLine(const std::string& strLine)
+{
+#ifndef _WIN32
+  const std::string strData = strLine + "\n";
+  std::lock_guard<std::mutex> lock(m_WriteGuard);
+  size_t iSent = 0;
+  while (iSent < strData.size()) {
+    const ssize_t n = send(m_iSocket, strData.data() + iSent,
+                           strData.size() - iSent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    iSent += size_t(n);
+  }
+  return true;
+#else
+  (void)strLine;
+  return false;
+#endif
+}
@@ -0,0 +1,84 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    LocalSocket.h
+  \brief   Line based stream over a UNIX domain socket.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef LOCALSOCKET_H
+#define LOCALSOCKET_H
+
+#include <mutex>
+#include <string>
+
+/// One end of a UNIX domain stream socket, or a listening socket.  Lines
+/// end in '\n'.  Writes are safe from several threads; a peer that went
+/// away makes them fail instead of raising SIGPIPE.  Not available on
+/// Windows, where every call fails.
+class LocalSocket {
+  public:
+    LocalSocket();
+    ~LocalSocket();
+
+    /// Binds strPath and listens on it.  A stale socket file of a server
+    /// that is gone is replaced; fails if a server still answers there.
+    bool Listen(const std::string& strPath);
+    bool Connect(const std::string& strPath);
+    /// Waits for the next client of a listening socket and hands it to
+    /// client.
+    bool Accept(LocalSocket& client);
+    /// True once a client waits to be accepted, false if none came within
+    /// iMilliseconds, so a server can check for shutdown in between.
+    bool WaitForClient(int iMilliseconds);
+    /// Makes ReadLine fail once no data arrived for iMilliseconds, 0 waits
+    /// forever.
+    bool SetReadTimeout(int iMilliseconds);
+
+    bool IsOpen() const {return m_iSocket >= 0;}
+    void Close();
+
+    /// Reads up to the next newline, which is not stored.  Fails at the end
+    /// of the stream.
+    bool ReadLine(std::string& strLine);
+    bool WriteLine(const std::string& strLine);
+
+  private:
+    LocalSocket(const LocalSocket&);
+    LocalSocket& operator=(const LocalSocket&);
+
+    int         m_iSocket;
+    std::string m_strPath;    ///< removed on Close() by the listener
+    std::string m_strBuffer;
+    std::mutex  m_WriteGuard;
+};
+
+#endif // LOCALSOCKET_H
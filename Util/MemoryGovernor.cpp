@@ -0,0 +1,207 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    MemoryGovernor.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "MemoryGovernor.h"
+#include "ProcessStats.h"
+#include "WorkerPool.h"
+
+namespace {
+  // what the calling thread holds; it must not wait for itself
+  thread_local uint64_t tHeld = 0;
+}
+
+const unsigned MemoryGovernor::STALL_MS;
+
+MemoryGovernor& MemoryGovernor::Instance()
+{
+  static MemoryGovernor governor;
+  return governor;
+}
+
+MemoryGovernor::MemoryGovernor() :
+  m_iBudget(0),
+  m_iReservable(std::numeric_limits<uint64_t>::max()),
+  m_iReserved(0),
+  m_iHighWater(0),
+  m_iThrottled(0),
+  m_iReleases(0),
+  m_iOvershoots(0),
+  m_iOvershootBytes(0),
+  m_iJobShare(0)
+{
+}
+
+void MemoryGovernor::SetBudget(uint64_t iBytes)
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_iBudget = iBytes;
+  m_iReservable = iBytes == 0 ? std::numeric_limits<uint64_t>::max()
+                              : iBytes - ConverterShare(iBytes);
+}
+
+uint64_t MemoryGovernor::GetBudget() const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  return m_iBudget;
+}
+
+uint64_t MemoryGovernor::GetConverterBudget() const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  return ConverterShare(m_iBudget);
+}
+
+uint64_t MemoryGovernor::ConverterShare(uint64_t iBytes)
+{
+  return iBytes - iBytes / 4;
+}
+
+void MemoryGovernor::SetJobShare(uint64_t iBytes)
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_iJobShare = iBytes;
+}
+
+bool MemoryGovernor::Fits(const void* pJob, uint64_t iMinimum) const
+{
+  if (m_iReserved != 0 && iMinimum > m_iReservable - std::min(m_iReservable,
+                                                               m_iReserved)) {
+    return false;
+  }
+  if (pJob && m_iJobShare != 0) {
+    auto held = m_JobReserved.find(pJob);
+    if (held != m_JobReserved.end() &&
+        iMinimum > m_iJobShare - std::min(m_iJobShare, held->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t MemoryGovernor::Reserve(uint64_t iBytes, uint64_t iMinimum)
+{
+  typedef std::chrono::steady_clock Clock;
+  const void* pJob = WorkerPool::GetJobTag();
+  std::unique_lock<std::mutex> lock(m_Guard);
+  // every release restarts the clock; if none comes, the holders are most
+  // likely waiting on this thread and the minimum is granted regardless
+  const std::chrono::milliseconds stall(STALL_MS);
+  uint64_t iReleases = m_iReleases;
+  Clock::time_point deadline = Clock::now() + stall;
+  while (tHeld == 0 && !Fits(pJob, iMinimum)) {
+    if (m_iReleases != iReleases) {
+      iReleases = m_iReleases;
+      deadline = Clock::now() + stall;
+    } else if (Clock::now() >= deadline) {
+      break;
+    }
+    m_Released.wait_until(lock, deadline);
+  }
+
+  uint64_t iFree = m_iReservable - std::min(m_iReservable, m_iReserved);
+  if (m_iBudget != 0) {
+    // the resident size already contains what was reserved and allocated,
+    // so it only bounds what is about to be added
+    const uint64_t iRSS = ProcessStats::CurrentRSS();
+    iFree = std::min(iFree, m_iBudget - std::min(m_iBudget, iRSS));
+  }
+  if (pJob && m_iJobShare != 0) {
+    auto held = m_JobReserved.find(pJob);
+    const uint64_t iHeld = held == m_JobReserved.end() ? 0 : held->second;
+    iFree = std::min(iFree, m_iJobShare - std::min(m_iJobShare, iHeld));
+  }
+
+  const uint64_t iGranted = std::max(iMinimum, std::min(iBytes, iFree));
+  if (iGranted < iBytes) m_iThrottled++;
+  m_iReserved += iGranted;
+  m_iHighWater = std::max(m_iHighWater, m_iReserved);
+  if (m_iReserved > m_iReservable) {
+    m_iOvershoots++;
+    m_iOvershootBytes = std::max(m_iOvershootBytes,
+                                 m_iReserved - m_iReservable);
+  }
+  if (pJob && iGranted != 0) m_JobReserved[pJob] += iGranted;
+  tHeld += iGranted;
+  return iGranted;
+}
+
+void MemoryGovernor::Release(uint64_t iBytes)
+{
+  const void* pJob = WorkerPool::GetJobTag();
+  tHeld -= std::min(tHeld, iBytes);
+  std::lock_guard<std::mutex> lock(m_Guard);
+  m_iReserved -= std::min(m_iReserved, iBytes);
+  if (pJob) {
+    auto held = m_JobReserved.find(pJob);
+    if (held != m_JobReserved.end()) {
+      held->second -= std::min(held->second, iBytes);
+      if (held->second == 0) m_JobReserved.erase(held);
+    }
+  }
+  m_iReleases++;
+  m_Released.notify_all();
+}
+
+uint64_t MemoryGovernor::GetReserved() const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  return m_iReserved;
+}
+
+uint64_t MemoryGovernor::GetHighWater() const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  return m_iHighWater;
+}
+
+uint64_t MemoryGovernor::GetThrottled() const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  return m_iThrottled;
+}
+
+uint64_t MemoryGovernor::GetOvershoots() const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  return m_iOvershoots;
+}
+
+uint64_t MemoryGovernor::GetOvershootBytes() const
+{
+  std::lock_guard<std::mutex> lock(m_Guard);
+  return m_iOvershootBytes;
+}
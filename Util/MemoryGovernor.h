@@ -0,0 +1,129 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    MemoryGovernor.h
+  \brief   Process wide memory budget that the conversion stages reserve
+           their buffers from.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef MEMORYGOVERNOR_H
+#define MEMORYGOVERNOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+/// Splits the --memory budget between Tuvok's converters, which get
+/// their share through Controller::SetMaxCPUMem, and the stages of this
+/// tree: staging queues and per-worker scratch.  Those reserve before they
+/// allocate and are granted less when the budget, or the resident size of
+/// the process, is tight.  They then run fewer workers or keep fewer bytes
+/// queued for the disk instead of overshooting.
+class MemoryGovernor {
+  public:
+    static MemoryGovernor& Instance();
+
+    /// iBytes for the whole process, 0 for no limit.  A quarter of it is
+    /// left to reservations, the rest to the converters.
+    void SetBudget(uint64_t iBytes);
+    uint64_t GetBudget() const;
+    uint64_t GetConverterBudget() const;
+    /// Part of a budget of iBytes that SetBudget() leaves to the converters.
+    static uint64_t ConverterShare(uint64_t iBytes);
+
+    /// Caps what the reservations of any one job, as told apart by
+    /// WorkerPool's job tag, hold at once; 0 lifts the cap.  The daemon
+    /// splits the budget between the jobs it runs concurrently this way.
+    void SetJobShare(uint64_t iBytes);
+
+    /// Grants up to iBytes but never less than iMinimum.  Blocks until
+    /// iMinimum fits next to what the other threads hold.  It is granted
+    /// at once, over the budget, if waiting could not help: nothing else
+    /// is reserved, the calling thread already holds a reservation, or no
+    /// reservation was released for STALL_MS.  Returns the granted amount,
+    /// to be handed back with Release() from the reserving thread.
+    uint64_t Reserve(uint64_t iBytes, uint64_t iMinimum = 0);
+    void Release(uint64_t iBytes);
+
+    uint64_t GetReserved() const;
+    /// Largest amount reserved at any one time.
+    uint64_t GetHighWater() const;
+    /// Number of reservations granted less than they asked for.
+    uint64_t GetThrottled() const;
+    /// Number of reservations granted past the budget, and the most that
+    /// was reserved beyond it at any one time.
+    uint64_t GetOvershoots() const;
+    uint64_t GetOvershootBytes() const;
+
+    /// How long Reserve() waits without any release before it gives up.
+    static const unsigned STALL_MS = 500;
+
+  private:
+    MemoryGovernor();
+
+    /// True if iMinimum fits next to what is reserved, in all and by pJob,
+    /// or nothing is held that a release could free.  The resident size is
+    /// left out; it need not shrink when a reservation is released.
+    bool Fits(const void* pJob, uint64_t iMinimum) const;
+
+    mutable std::mutex m_Guard;
+    std::condition_variable m_Released;
+    uint64_t m_iBudget;
+    uint64_t m_iReservable;
+    uint64_t m_iReserved;
+    uint64_t m_iHighWater;
+    uint64_t m_iThrottled;
+    uint64_t m_iReleases;
+    uint64_t m_iOvershoots;
+    uint64_t m_iOvershootBytes;
+    uint64_t m_iJobShare;
+    std::map<const void*, uint64_t> m_JobReserved;
+};
+
+/// Reservation that is released when it goes out of scope.
+class MemoryReservation {
+  public:
+    MemoryReservation(uint64_t iBytes, uint64_t iMinimum = 0) :
+      m_iBytes(MemoryGovernor::Instance().Reserve(iBytes, iMinimum)) {}
+    ~MemoryReservation() {MemoryGovernor::Instance().Release(m_iBytes);}
+
+    uint64_t GetBytes() const {return m_iBytes;}
+
+  private:
+    MemoryReservation(const MemoryReservation&);
+    MemoryReservation& operator=(const MemoryReservation&);
+
+    uint64_t m_iBytes;
+};
+
+#endif // MEMORYGOVERNOR_H
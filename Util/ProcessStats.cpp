@@ -0,0 +1,186 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    ProcessStats.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <fstream>
+#include <sstream>
+
+#include "ProcessStats.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+# include <windows.h>
+# include <psapi.h>
+#else
+# include <fcntl.h>
+# include <sys/resource.h>
+# include <time.h>
+# include <unistd.h>
+#endif
+
+namespace {
+#ifdef __linux__
+  /// Reads a "Name:   1234 kB" line from /proc/self/status.
+  uint64_t StatusField(const char* name)
+  {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    const std::string prefix = std::string(name) + ":";
+    while (std::getline(status, line)) {
+      if (line.compare(0, prefix.size(), prefix) == 0) {
+        std::istringstream value(line.substr(prefix.size()));
+        uint64_t kb = 0;
+        value >> kb;
+        return kb * 1024;
+      }
+    }
+    return 0;
+  }
+#endif
+}
+
+uint64_t ProcessStats::CurrentRSS()
+{
+#if defined(__linux__)
+  return StatusField("VmRSS");
+#elif defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+  return pmc.WorkingSetSize;
+#else
+  return 0;
+#endif
+}
+
+uint64_t ProcessStats::PeakRSS()
+{
+#if defined(__linux__)
+  return StatusField("VmHWM");
+#elif defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+  return pmc.PeakWorkingSetSize;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+# ifdef __APPLE__
+  return uint64_t(usage.ru_maxrss);
+# else
+  return uint64_t(usage.ru_maxrss) * 1024;
+# endif
+#endif
+}
+
+void ProcessStats::ResetPeakRSS()
+{
+#ifdef __linux__
+  std::ofstream clear("/proc/self/clear_refs");
+  clear << "5";
+#endif
+}
+
+double ProcessStats::CPUSeconds()
+{
+#ifdef _WIN32
+  FILETIME create, exit, kernel, user;
+  if (!GetProcessTimes(GetCurrentProcess(), &create, &exit, &kernel, &user)) {
+    return 0.0;
+  }
+  ULARGE_INTEGER k, u;
+  k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+  u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+  return double(k.QuadPart + u.QuadPart) * 1e-7;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+double ProcessStats::ThreadCPUSeconds()
+{
+#if defined(_WIN32)
+  FILETIME create, exit, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &create, &exit, &kernel, &user)) {
+    return CPUSeconds();
+  }
+  ULARGE_INTEGER k, u;
+  k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+  u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+  return double(k.QuadPart + u.QuadPart) * 1e-7;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return CPUSeconds();
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+  return CPUSeconds();
+#endif
+}
+
+uint64_t ProcessStats::FileSize(const std::string& strFilename)
+{
+  std::ifstream file(strFilename.c_str(), std::ios::in | std::ios::binary |
+                                          std::ios::ate);
+  if (!file.is_open()) return 0;
+  return uint64_t(file.tellg());
+}
+
+uint64_t ProcessStats::FileModificationTime(const std::string& strFilename)
+{
+#if defined(_WIN32)
+  struct _stat64 st;
+  if (_stat64(strFilename.c_str(), &st) != 0) return 0;
+#else
+  struct stat st;
+  if (stat(strFilename.c_str(), &st) != 0) return 0;
+#endif
+  return uint64_t(st.st_mtime);
+}
+
+bool ProcessStats::DropFileCache(const std::string& strFilename)
+{
+#if defined(__linux__)
+  int fd = open(strFilename.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  fdatasync(fd);
+  bool bOk = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close(fd);
+  return bOk;
+#else
+  (void)strFilename;
+  return false;
+#endif
+}
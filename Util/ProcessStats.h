@@ -0,0 +1,68 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    ProcessStats.h
+  \brief   Resource usage of the running process.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef PROCESSSTATS_H
+#define PROCESSSTATS_H
+
+#include <cstdint>
+#include <string>
+
+namespace ProcessStats {
+  /// Current resident set size in bytes, 0 if unknown.
+  uint64_t CurrentRSS();
+  /// Largest resident set size in bytes since start or the last
+  /// ResetPeakRSS(), 0 if unknown.
+  uint64_t PeakRSS();
+  /// Restarts peak tracking where the OS supports it (Linux >= 4.0);
+  /// elsewhere PeakRSS() keeps reporting the lifetime peak.
+  void ResetPeakRSS();
+  /// User plus system CPU time of all threads, in seconds.
+  double CPUSeconds();
+  /// CPU time of the calling thread in seconds; falls back to CPUSeconds()
+  /// where per-thread accounting is unavailable.
+  double ThreadCPUSeconds();
+  /// Size of a file in bytes, 0 if it cannot be opened.
+  uint64_t FileSize(const std::string& strFilename);
+  /// Last modification of a file in seconds since the epoch, 0 if it
+  /// cannot be queried.
+  uint64_t FileModificationTime(const std::string& strFilename);
+  /// Asks the OS to evict the file from the page cache so the next read
+  /// hits the device.  Returns false where that is not supported.
+  bool DropFileCache(const std::string& strFilename);
+}
+
+#endif // PROCESSSTATS_H
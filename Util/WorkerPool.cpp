@@ -0,0 +1,105 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    WorkerPool.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkerPool.h"
+
+namespace {
+  thread_local const void* s_pJobTag = NULL;
+}
+
+WorkerPool::WorkerPool(size_t iWorkers) :
+  m_iWorkers(iWorkers == 0 ? HardwareThreads() : iWorkers)
+{
+}
+
+size_t WorkerPool::HardwareThreads()
+{
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+const void* WorkerPool::GetJobTag()
+{
+  return s_pJobTag;
+}
+
+void WorkerPool::SetJobTag(const void* pTag)
+{
+  s_pJobTag = pTag;
+}
+
+void WorkerPool::Run(size_t iCount,
+                     const std::function<void (size_t, size_t)>& task) const
+{
+  std::atomic<size_t> next(0);
+  std::exception_ptr firstError;
+  std::mutex errorGuard;
+  const void* pJobTag = s_pJobTag;
+
+  auto work = [&](size_t worker) {
+    s_pJobTag = pJobTag;
+    for (size_t i = next++; i < iCount; i = next++) {
+      try {
+        task(i, worker);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorGuard);
+        if (!firstError) firstError = std::current_exception();
+      }
+    }
+  };
+
+  const size_t iThreads = std::min(m_iWorkers, iCount);
+  if (iThreads <= 1) {
+    // no point in spawning a thread, and it keeps single job runs simple to
+    // debug.
+    work(0);
+  } else {
+    std::vector<std::thread> threads;
+    threads.reserve(iThreads);
+    for (size_t w = 0; w < iThreads; ++w) {
+      threads.push_back(std::thread(work, w));
+    }
+    for (auto t = threads.begin(); t != threads.end(); ++t) {
+      t->join();
+    }
+  }
+
+  if (firstError) std::rethrow_exception(firstError);
+}
@@ -0,0 +1,71 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    WorkerPool.h
+  \brief   Runs a fixed set of independent tasks on a small thread pool.
+  \version 1.0
+  \date    October 2026
+*/
+
+#pragma once
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <cstddef>
+#include <functional>
+
+class WorkerPool {
+  public:
+    /// \param iWorkers number of threads to use; 0 picks one per core.
+    explicit WorkerPool(size_t iWorkers);
+
+    size_t GetWorkerCount() const {return m_iWorkers;}
+
+    /// Calls task(i, worker) once for every i in [0, iCount), handing out
+    /// indices in increasing order.  Blocks until all tasks are done.  If a
+    /// task throws, the remaining tasks still run and the first exception is
+    /// rethrown afterwards.
+    void Run(size_t iCount,
+             const std::function<void (size_t, size_t)>& task) const;
+
+    /// Number of hardware threads, at least 1.
+    static size_t HardwareThreads();
+
+    /// Opaque tag of the job the calling thread works for, NULL if none.
+    /// Run() passes the caller's tag on to its threads, so per job output
+    /// can follow the work.
+    static const void* GetJobTag();
+    static void SetJobTag(const void* pTag);
+
+  private:
+    size_t m_iWorkers;
+};
+
+#endif // WORKERPOOL_H
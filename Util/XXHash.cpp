@@ -0,0 +1,129 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2008 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+/**
+  \file    XXHash.cpp
+  \version 1.0
+  \date    October 2026
+*/
+
+#include <cstring>
+
+#include "XXHash.h"
+
+namespace {
+  const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+  const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+  const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+  const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+  const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+  uint64_t Rotate(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  // little endian loads; memcpy keeps unaligned access legal
+  uint64_t Read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+  }
+
+  uint64_t Read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+  }
+
+  uint64_t Round(uint64_t iAcc, uint64_t iInput) {
+    iAcc += iInput * PRIME2;
+    return Rotate(iAcc, 31) * PRIME1;
+  }
+
+  uint64_t MergeRound(uint64_t iAcc, uint64_t iVal) {
+    iAcc ^= Round(0, iVal);
+    return iAcc * PRIME1 + PRIME4;
+  }
+}
+
+uint64_t XXHash64(const void* pData, size_t iSize, uint64_t iSeed)
+{
+  const uint8_t* p = static_cast<const uint8_t*>(pData);
+  const uint8_t* const pEnd = p + iSize;
+  uint64_t h;
+
+  if (iSize >= 32) {
+    // four independent lanes keep the multipliers busy
+    uint64_t v1 = iSeed + PRIME1 + PRIME2;
+    uint64_t v2 = iSeed + PRIME2;
+    uint64_t v3 = iSeed;
+    uint64_t v4 = iSeed - PRIME1;
+    const uint8_t* const pLimit = pEnd - 32;
+    do {
+      v1 = Round(v1, Read64(p));
+      v2 = Round(v2, Read64(p+8));
+      v3 = Round(v3, Read64(p+16));
+      v4 = Round(v4, Read64(p+24));
+      p += 32;
+    } while (p <= pLimit);
+    h = Rotate(v1, 1) + Rotate(v2, 7) + Rotate(v3, 12) + Rotate(v4, 18);
+    h = MergeRound(h, v1);
+    h = MergeRound(h, v2);
+    h = MergeRound(h, v3);
+    h = MergeRound(h, v4);
+  } else {
+    h = iSeed + PRIME5;
+  }
+  h += uint64_t(iSize);
+
+  for (;p + 8 <= pEnd;p += 8) {
+    h ^= Round(0, Read64(p));
+    h = Rotate(h, 27) * PRIME1 + PRIME4;
+  }
+  if (p + 4 <= pEnd) {
+    h ^= Read32(p) * PRIME1;
+    h = Rotate(h, 23) * PRIME2 + PRIME3;
+    p += 4;
+  }
+  for (;p<pEnd;p++) {
+    h ^= (*p) * PRIME5;
+    h = Rotate(h, 11) * PRIME1;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME2;
+  h ^= h >> 29;
+  h *= PRIME3;
+  h ^= h >> 32;
+  return h;
+}
@@ -36,13 +36,55 @@
 //!    Copyright (C) 2008 SCI Institute
 
 #include <StdTuvokDefines.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <sstream>
+#include <streambuf>
+#include <thread>
 #include <vector>
+#ifdef _WIN32
+#  include <direct.h>
+#else
+#  include <unistd.h>
+#endif
 
-#include "DebugOut/HRConsoleOut.h"
+#include "DebugOut/AsyncConsoleOut.h"
+#include "DebugOut/JobOut.h"
+#include "DebugOut/ProfileOut.h"
+#include "DebugOut/StatsTimer.h"
+#include "Expr/Expression.h"
+#include "Convert/AutoTune.h"
+#include "Convert/BrickLayout.h"
+#include "Convert/BrickedExpression.h"
+#include "Convert/CompressionChoice.h"
+#include "Convert/MeshMerge.h"
+#include "Convert/MeshStream.h"
+#include "Convert/Quantizer.h"
+#include "Convert/StackScan.h"
+#include "Convert/UVFChecksums.h"
+#include "Convert/UVFExport.h"
+#include "Convert/UVFReBricker.h"
+#include "Util/AsyncWriter.h"
+#include "Util/Journal.h"
+#include "Util/LocalSocket.h"
+#include "Util/MemoryGovernor.h"
+#include "Util/ProcessStats.h"
+#include "Util/WorkerPool.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
@@ -99,9 +141,12 @@ enum {
     EXIT_FAILURE_MERGE_NO_UVF,  // attempting to merge to format other than UVF
     EXIT_FAILURE_GENERAL_DIR,   // general error during conversion in dir mode
     EXIT_FAILURE_NEED_UVF,      // UVFs must be input to eval expressions.
+    EXIT_FAILURE_BATCH,         // at least one job in batch mode failed
+    EXIT_FAILURE_VERIFY,        // the file does not match its checksums
 };
 
-static int export_data( const IOManager&, const std::string in, const std::string out);
+static int export_data( const IOManager&, const std::string in, const std::string out,
+                        const std::string tmpdir);
 
 // reads an entire file into a string.
 static std::string readfile(const std::string& filename)
@@ -128,110 +173,646 @@ static std::string readfile(const std::string& filename)
     return std::string(&contents[0]);
 }
 
-int main(int argc, const char* argv[])
-{
-    typedef std::vector<std::string> Strings;
+typedef std::vector<std::string> Strings;
+
+// Settings of a single conversion.  main() fills one from the command line,
+// batch mode fills one per job on top of those.
+struct ConvOptions {
+    ConvOptions() :
+        merge("max"),
+        quantizeTo8bits(false),
+        quantizeBits(0),
+        resume(false),
+        listStacks(false),
+        lod(0),
+        bricksize(64),
+        bricklayout(0),   // 0 is default scanline layout
+        brickoverlap(2),
+        compression("1"), // 1 is default zlib compression
+        level(1),         // generic compression level 1 is best speed
+        autoTune(false),
+        optimize("convert-speed"),
+        checksums(false),
+        memory("80%"),
+        fMem(0.8f),
+        jobs(1),
+        threads(0)
+    {}
+
     Strings input;
     std::string expression;
-
-    // temp
-    string strInFile;
-    string strInFile2;
     string strInDir;
     string strOutFile;
-    double fScale = 0.0;
-    double fBias = 0.0;
-    bool debug = false;
-    bool experimental = false;
-    bool quantizeTo8bits = false;
-    uint32_t bricksize = 64;
-    uint32_t bricklayout = 0; // 0 is default scanline layout
-    uint32_t brickoverlap = 2;
-    uint32_t compression = 1; // 1 is default zlib compression
-    uint32_t level = 1; // generic compression level 1 is best speed
-    float fMem = 0.8f;
+    string strTempDir;
+    string strScanIndex;
+    std::vector<double> scale;
+    std::vector<double> bias;
+    string merge;
+    bool quantizeTo8bits;
+    uint32_t quantizeBits;
+    bool resume;
+    bool listStacks;
+    uint32_t lod;
+    std::string roi;
+    uint32_t bricksize;
+    uint32_t bricklayout;
+    std::string layoutTrace;
+    uint32_t brickoverlap;
+    std::string compression;
+    uint32_t level;
+    bool autoTune;
+    std::string optimize;
+    bool checksums;
+    std::string memory;
+    float fMem;       // share of physical memory for Tuvok, from memory
+    uint32_t jobs;
+    uint32_t threads;
+};
 
-    try
-    {
-        po::options_description options( "uvf converter" );
-        std::string clientString("");
-        std::string serverString("");
-        bool showHelp(false);
+// registers the options that describe a single conversion.  Current values
+// in opt become the defaults.
+static void add_conversion_options(po::options_description& options,
+                                   ConvOptions& opt)
+{
+    options.add_options()
+        ( "input,i", po::value< Strings >( &opt.input ), "input file(s)" )
+        ( "directory,d", po::value< std::string >( &opt.strInDir ), "input directory" )
+        ( "output,o", po::value< std::string >( &opt.strOutFile ), "uvf output file" )
+        ( "expression,e", po::value< std::string >( &opt.expression ), "merge expression" )
+        ( "tmpdir", po::value< std::string >( &opt.strTempDir ), "directory for intermediate files (default: the output file's directory)" )
+        ( "scan-index", po::value< std::string >( &opt.strScanIndex ), "file caching the stacks found in the input directory; reused while no file in it changes" )
+        ( "lod", po::value< uint32_t >( &opt.lod ), "LOD to export from a UVF, 0 is full resolution" )
+        ( "roi", po::value< std::string >( &opt.roi ), "region to export from a UVF as x0,y0,z0,x1,y1,z1 in full resolution voxels, upper bounds exclusive" )
+        ( "list-stacks", po::bool_switch(&opt.listStacks)->default_value( opt.listStacks ), "list the stacks found in the input directory and exit" )
+        ( "bias,b", po::value< std::vector<double> >( &opt.bias ), "merge bias, once per input or once per input after the first (default 0)" )
+        ( "scale,s", po::value< std::vector<double> >( &opt.scale ), "merge scale, once per input or once per input after the first (default 1)" )
+        ( "merge", po::value< std::string >( &opt.merge ), "how merged voxels combine, max: largest scaled value, sum: sum of the scaled values" )
+        ( "memory,m", po::value< std::string >( &opt.memory ), "memory budget: a size such as 4G or 512M, a plain number of MB, a percentage of physical memory, or a fraction of it below 1 such as 0.8 (default 80%)" )
+        ( "bricksize", po::value< uint32_t >( &opt.bricksize ), "maximum brick size" )
+        ( "brickoverlap", po::value< uint32_t >( &opt.brickoverlap ), "brick overlap in voxels" )
+        ( "bricklayout", po::value< uint32_t >( &opt.bricklayout ), "brick layout on disk 0: scanline, 1: morton, 2: hilbert, 3: random order, 4: whichever of these serves --layout-trace, or a simulated viewer, with the fewest seeks" )
+        ( "layout-trace", po::value< std::string >( &opt.layoutTrace ), "brick requests recorded from a renderer for --bricklayout 4, one 'lod x y z' line each" )
+        ( "compression", po::value< std::string >( &opt.compression ), "UVF compression method 0: no compression, 1: zlib, 2: lzma, 3: lz4, 4: bzlib, 5: lzham, auto: chosen per dataset from a sample of its data" )
+        ( "level", po::value< uint32_t >( &opt.level ), "UVF compression level (1..10)" )
+        ( "auto-tune", po::bool_switch(&opt.autoTune)->default_value( opt.autoTune ), "pick brick size, compression and level from trial conversions of a sample of the (first) input" )
+        ( "optimize", po::value< std::string >( &opt.optimize ), "what --auto-tune optimizes: convert-speed, file-size or read-latency (default convert-speed)" )
+        ( "checksums", po::bool_switch(&opt.checksums)->default_value( opt.checksums ), "record a checksum of every brick of the UVF output in <output>.xxh, for --verify" )
+        ( "quantize,q", po::bool_switch(&opt.quantizeTo8bits)->default_value( opt.quantizeTo8bits ), "Quantize to 8 bits" )
+        ( "resume", po::bool_switch(&opt.resume)->default_value( opt.resume ), "journal progress next to the output and continue an interrupted UVF re-brick, merge or expression; in directory mode skip stacks that did not change since the last run" )
+        ( "quantize-bits", po::value< uint32_t >( &opt.quantizeBits ), "Quantize to 8..16 bits, stored as 8 bit up to 8 bits and 16 bit above" )
+        ( "jobs,j", po::value< uint32_t >( &opt.jobs ), "number of concurrent workers for directory stacks and batch or served jobs (0: one per core)" )
+        ( "threads", po::value< uint32_t >( &opt.threads ), "threads streaming the bricks of one UVF re-brick, merge or expression (0: one per core)" );
+}
 
-        options.add_options()
-          ( "help,h", po::bool_switch(&showHelp)->default_value( false ), "show help message" ),
-            ( "input,i", po::value< Strings >( &input ), "input file(s)" ),
-            ( "directory,d", po::value< std::string >( &strInDir ), "input directory" ),
-            ( "output,o", po::value< std::string >( &strOutFile ), "uvf output file" ),
-            ( "expression,e", po::value< std::string >( &expression ), "merge expression" ),
-            ( "bias,b", po::value< double >( &fBias ), "merge bias value for second file" ),
-            ( "scale,s", po::value< double >( &fScale ), "merge scale value for second file" ),
-            ( "memory,m", po::value< float >( &fMem ), "MB of maximum allowed memory usage" ),
-            ( "bricksize", po::value< uint32_t >( &bricksize ), "maximum brick size" ),
-            ( "brickoverlap", po::value< uint32_t >( &brickoverlap ), "brick overlap in voxels" ),
-            ( "bricklayout", po::value< uint32_t >( &bricklayout ), "brick layout on disk 0: scanline, 1: morton, 2: hilbert, 3: random order" ),
-            ( "compression", po::value< uint32_t >( &compression ), "UVF compression method 0: no compression, 1: zlib, 2: lzma, 3: lz4, 4: bzlib, 5: lzham" ),
-            ( "level", po::value< uint32_t >( &level ), "UVF compression level (1..10)" ),
-            ( "debug", po::bool_switch(&debug)->default_value( false ), "Enable debug mode" ),
-            ( "experimental", po::bool_switch(&experimental)->default_value( false ), "Enable experimental features" ),
-            ( "quantize,q", po::bool_switch(&quantizeTo8bits)->default_value( false ), "Quantize to 8 bits" );
+// directory for the intermediate files of a conversion writing strTarget:
+// --tmpdir if given, otherwise next to the target.
+static std::string temp_dir(const ConvOptions& opt, const std::string& strTarget)
+{
+    if (opt.strTempDir.empty()) return SysTools::GetPath(strTarget);
+    const char last = opt.strTempDir[opt.strTempDir.size()-1];
+    if (last == '/' || last == '\\') return opt.strTempDir;
+    return opt.strTempDir + "/";
+}
 
-        // parse program options
-        po::variables_map variableMap;
-        po::store( po::command_line_parser( argc, argv ).options(
-                       options ).allow_unregistered().run(), variableMap );
-        po::notify( variableMap );
+// parses --roi "x0,y0,z0,x1,y1,z1" into six values; empty stays empty.
+static bool parse_roi(const std::string& value, std::vector<uint64_t>& vROI)
+{
+    vROI.clear();
+    if (value.empty()) return true;
+    std::istringstream in(value);
+    uint64_t v;
+    char sep = ',';
+    while (sep == ',' && in >> v) {
+        vROI.push_back(v);
+        if (!(in >> sep)) break;
+    }
+    if (!in.eof() || vROI.size() != 6) return false;
+    return vROI[0] < vROI[3] && vROI[1] < vROI[4] && vROI[2] < vROI[5];
+}
 
-        // evaluate parsed arguments
-        if( showHelp )
-        {
-            std::cout << options << std::endl;
-            return EXIT_SUCCESS;
+// parses a numeric --compression value.
+static bool parse_compression(const std::string& value, uint32_t& iCompression)
+{
+    if (value.size() != 1 || value[0] < '0' || value[0] > '5') return false;
+    iCompression = uint32_t(value[0] - '0');
+    return true;
+}
+
+// parses --memory into bytes: a size with unit (4G, 512M), a plain number
+// of MB, a percentage of physical memory or, as earlier versions took it,
+// a fraction of it such as 0.8.  Only a value with a decimal point below 1
+// is a fraction; 1 is a megabyte.
+static bool parse_memory(const std::string& value, uint64_t& iBytes)
+{
+    const double fPhysical =
+        double(Controller::Instance().SysInfo()->GetCPUMemSize());
+    char* end = NULL;
+    const double f = strtod(value.c_str(), &end);
+    if (end == value.c_str() || !(f > 0.0)) return false;
+
+    const std::string unit = SysTools::ToLowerCase(end);
+    double fBytes;
+    if (unit.empty()) {
+        const bool bFraction = f < 1.0 && value.find('.') != std::string::npos;
+        fBytes = bFraction ? f * fPhysical : f * 1024.0 * 1024.0;
+    } else if (unit == "%") {
+        fBytes = f / 100.0 * fPhysical;
+    } else if (unit == "k" || unit == "kb") {
+        fBytes = f * 1024.0;
+    } else if (unit == "m" || unit == "mb") {
+        fBytes = f * 1024.0 * 1024.0;
+    } else if (unit == "g" || unit == "gb") {
+        fBytes = f * 1024.0 * 1024.0 * 1024.0;
+    } else if (unit == "t" || unit == "tb") {
+        fBytes = f * 1024.0 * 1024.0 * 1024.0 * 1024.0;
+    } else {
+        return false;
+    }
+    if (fBytes < 1.0) return false;
+    iBytes = uint64_t(fBytes);
+    return true;
+}
+
+// Controller::SetMaxCPUMem takes a share of physical memory.
+static float physical_share(uint64_t iBytes)
+{
+    const uint64_t iPhysical = Controller::Instance().SysInfo()->GetCPUMemSize();
+    return iPhysical == 0 ? 1.0f : float(double(iBytes) / double(iPhysical));
+}
+
+// the streams that served jobs report on instead of stdout, by job tag.
+static std::mutex consoleGuard;
+static std::map<const void*, std::ostream*> jobConsoles;
+// progress that the console sink may still hold back for its refresh rate
+static AsyncConsoleOut* consoleSink = NULL;
+
+// where status output goes: stdout, or the client of the served job the
+// calling thread works for, found by job tag as JobOut does.  Progress the
+// console sink still holds is printed first, so that it cannot land after
+// or inside the status line.
+static std::ostream& console()
+{
+    const void* pTag = WorkerPool::GetJobTag();
+    if (pTag) {
+        std::lock_guard<std::mutex> lock(consoleGuard);
+        auto c = jobConsoles.find(pTag);
+        if (c != jobConsoles.end()) return *c->second;
+    }
+    if (consoleSink) consoleSink->Flush();
+    return cout;
+}
+
+// sends each completed line written to it to a served job's client as a
+// "message" line; blank lines are left out.
+class ClientLineBuf : public std::streambuf {
+  public:
+    explicit ClientLineBuf(const std::shared_ptr<LocalSocket>& client) :
+        m_client(client) {}
+    ~ClientLineBuf() { sync(); }
+
+  protected:
+    virtual int overflow(int c) {
+        if (c == traits_type::eof()) return traits_type::not_eof(c);
+        std::lock_guard<std::mutex> lock(m_guard);
+        if (c != '\n') {
+            m_strLine += char(c);
+        } else if (!m_strLine.empty()) {
+            m_client->WriteLine("message " + m_strLine);
+            m_strLine.clear();
         }
+        return c;
+    }
+
+    // a flush sends what there is of the current line
+    virtual int sync() {
+        std::lock_guard<std::mutex> lock(m_guard);
+        if (!m_strLine.empty()) m_client->WriteLine("message " + m_strLine);
+        m_strLine.clear();
+        return 0;
+    }
+
+  private:
+    std::shared_ptr<LocalSocket> m_client;
+    std::mutex m_guard;
+    std::string m_strLine;
+};
+
+// compression method for a sample, as --compression auto picks it.
+static uint32_t sampled_compression(const DataSample& sample)
+{
+    const uint32_t iCompression = ChooseCompression(sample);
+    MESSAGE("Sampled %u blocks: %.2f bits/byte, %.0f%% constant -> %s",
+            unsigned(sample.iBlocks), sample.fEntropy, sample.fConstant*100.0,
+            CompressionName(iCompression));
+    return iCompression;
+}
+
+// compression method for --compression auto, chosen from a sample of the
+// given sources: of the bricks of a UVF, else of the bytes the files store.
+// Volumes that need decoding are sampled from their staged voxels only by
+// convert_sampled(), which goes on from the staged copy.
+static uint32_t auto_compression(const IOManager& ioMan, const Strings& sources)
+{
+    ProfileScope stage("SampleCompression");
+    if (sources.size() == 1 && !ioMan.NeedsConversion(sources[0])) {
+        return sampled_compression(SampleUVF(ioMan, sources[0]));
+    }
+    return sampled_compression(SampleFiles(sources));
+}
+
+// --compression auto for a single volume into a UVF.  The converter stages
+// the source once, the compression is chosen from a sample of its voxels
+// and, if the converter had to decode it into a file of its own, the UVF is
+// bricked from that copy instead of decoding the source a second time.
+static bool convert_sampled(const ConvOptions& opt, IOManager& ioMan,
+                            const std::string& strInFile)
+{
+    const std::string strTempDir = temp_dir(opt, opt.strOutFile);
+    std::string strRaw;
+    uint64_t iHeaderSkip = 0;
+    bool bSwap = false;
+    bool bDelete = false;
+    RawVolumeInfo info;
+    bool bStaged;
+    {
+        ProfileScope stage("StageRawSource");
+        bStaged = StageRawSource(ioMan, strInFile, strTempDir, strRaw,
+                                 iHeaderSkip, bSwap, info, bDelete);
+    }
+    uint32_t iCompression;
+    {
+        ProfileScope stage("SampleCompression");
+        iCompression = sampled_compression(bStaged
+            ? SampleRawFile(strRaw, iHeaderSkip, info)
+            : SampleFiles(Strings(1, strInFile)));
+    }
+    console() << "Auto compression: " << CompressionName(iCompression) << "\n";
+    ioMan.SetCompression(iCompression);
+
+    // BuildUVFFromRaw takes headerless voxels in native order, which is
+    // what the converters decode to
+    if (bDelete && iHeaderSkip == 0 && !bSwap) {
+        return BuildUVFFromRaw(ioMan, strRaw, info, opt.strOutFile, strTempDir,
+                               opt.bricksize, opt.brickoverlap);
+    }
+    if (bDelete) std::remove(strRaw.c_str());
+    ProfileScope stage("ConvertDataset");
+    if (!ioMan.ConvertDataset(strInFile, opt.strOutFile, strTempDir, true,
+                              opt.bricksize, opt.brickoverlap)) {
+        return false;
+    }
+    stage.SetBytes(ProcessStats::FileSize(strInFile),
+                   ProcessStats::FileSize(opt.strOutFile));
+    return true;
+}
 
-        // which of "-i" or "-d" did they give?
-        if( !input.empty()) {
-            strInFile = input.front();
-            if(input.size() > 1)
-                strInFile2 = input[1];
+// brick layout for --bricklayout 4: the one that serves the --layout-trace
+// requests, or those of a simulated viewer, with the least seeking.  The
+// grid comes from a UVF input, else from the trace, else a 512^3 16 bit
+// volume stands in.
+static bool choose_layout(const ConvOptions& opt, const IOManager& ioMan,
+                          uint32_t& iLayout)
+{
+    ProfileScope stage("ChooseLayout");
+    uint64_t iSize[3] = {0, 0, 0};
+    uint64_t iBytesPerVoxel = 2;
+    if (opt.input.size() == 1 && !ioMan.NeedsConversion(opt.input[0])) {
+        std::unique_ptr<Dataset> ds(ioMan.CreateDataset(opt.input[0], 256, false));
+        if (ds) {
+            const UINT64VECTOR3 domain = ds->GetDomainSize(0, 0);
+            iSize[0] = domain.x;
+            iSize[1] = domain.y;
+            iSize[2] = domain.z;
+            iBytesPerVoxel = ds->GetBitWidth()/8 * ds->GetComponentCount();
         }
+    }
 
-        if(SysTools::FileExists(expression))
-            expression = readfile(expression);
+    BrickTrace trace;
+    if (!opt.layoutTrace.empty()) {
+        if (!LoadBrickTrace(opt.layoutTrace, trace)) {
+            std::cerr << "error: cannot read brick trace '" << opt.layoutTrace
+                      << "', expected lines of 'lod x y z'\n";
+            return false;
+        }
+        if (iSize[0] == 0) {
+            TraceExtent(trace, opt.bricksize, opt.brickoverlap, iSize);
+        }
+    }
+    if (iSize[0] == 0) iSize[0] = iSize[1] = iSize[2] = 512;
+
+    const BrickGrid grid(iSize, opt.bricksize, opt.brickoverlap, iBytesPerVoxel);
+    if (trace.empty()) trace = ViewerTrace(grid, 16);
+
+    std::vector<LayoutCost> vCosts;
+    iLayout = ChooseBrickLayout(grid, trace, ReadCostModel(), &vCosts);
+    console() << "\nBrick layout for " << trace.size() << " "
+              << (opt.layoutTrace.empty() ? "simulated" : "traced")
+              << " brick requests:\n";
+    for (size_t i = 0;i<vCosts.size();i++) {
+        console() << "  " << BrickLayoutName(BrickLayout(i)) << ": "
+                  << vCosts[i].iSeeks << " seeks for " << vCosts[i].iReads
+                  << " bricks, " << vCosts[i].iBytes/1024/1024 << " MB read\n";
+    }
+    console() << "Using " << BrickLayoutName(BrickLayout(iLayout)) << " layout\n";
+    return true;
+}
 
-        Controller::Instance().ExperimentalFeatures( experimental );
+// --auto-tune: converts a sample of the first input with candidate brick
+// sizes and compression methods and puts the best for eGoal into opt.
+static bool auto_tune(ConvOptions& opt, IOManager& ioMan, TuneGoal eGoal,
+                      TuneResult& tune)
+{
+    if (!AutoTune(ioMan, opt.input.front(), temp_dir(opt, opt.strOutFile),
+                  eGoal, opt.brickoverlap, tune)) {
+        return false;
     }
-    catch( std::exception& exception )
+    console() << "\nAuto-tune trials on a " << tune.iSampleBytes/1024/1024
+              << " MB sample, optimizing " << TuneGoalName(eGoal) << ":\n";
+    for (size_t i = 0;i<tune.vTrials.size();i++) {
+        const TuneTrial& t = tune.vTrials[i];
+        console() << "  bricksize " << t.iBrickSize << ", "
+                  << CompressionName(t.iCompression) << " level " << t.iLevel << ": ";
+        if (!t.bOk) {
+            console() << "failed\n";
+            continue;
+        }
+        console() << tune.Throughput(i) << " MB/s, "
+                  << double(tune.iSampleBytes) / double(std::max<uint64_t>(t.iUVFBytes, 1))
+                  << ":1, " << t.fViewMs << " ms per view\n";
+    }
+    const TuneTrial& best = tune.vTrials[tune.iBest];
+    opt.bricksize = best.iBrickSize;
+    opt.compression = std::to_string(best.iCompression);
+    opt.level = best.iLevel;
+    console() << "Using bricksize " << opt.bricksize << ", brickoverlap "
+              << opt.brickoverlap << ", " << CompressionName(best.iCompression)
+              << " level " << opt.level << "\n";
+    return true;
+}
+
+// expands the --scale or --bias values given for a merge of iInputs files
+// into one value per input.  iInputs-1 values apply to all but the first
+// input, no values leave every input at fDefault.  Fails for values that
+// are not finite, which the merge expression cannot hold.
+static bool merge_factors(const std::vector<double>& given, size_t iInputs,
+                          double fDefault, std::vector<double>& factors)
+{
+    factors.assign(iInputs, fDefault);
+    if (given.empty()) return true;
+    if (given.size() != iInputs && given.size()+1 != iInputs) return false;
+    for (size_t i = 0;i<given.size();i++) {
+        if (!std::isfinite(given[i])) return false;
+    }
+    std::copy(given.begin(), given.end(), factors.end()-given.size());
+    return true;
+}
+
+// identifies the settings and source files of a conversion, so a journal or
+// stack manifest of an earlier run is only trusted for the same work.
+static std::string conversion_signature(const ConvOptions& opt, const Strings& sources)
+{
+    std::ostringstream sig;
+    sig.precision(17);
+    sig << opt.expression << "|" << opt.bricksize << " " << opt.brickoverlap
+        << " " << opt.bricklayout << " " << opt.compression << " " << opt.level
+        << " " << opt.quantizeTo8bits << " " << opt.quantizeBits << " " << opt.merge;
+    for (size_t i = 0;i<opt.scale.size();i++) sig << " s" << opt.scale[i];
+    for (size_t i = 0;i<opt.bias.size();i++) sig << " b" << opt.bias[i];
+    for (auto f = sources.cbegin(); f != sources.cend(); ++f) {
+        sig << "|" << *f << " " << Journal::FileStamp(*f);
+    }
+    return sig.str();
+}
+
+// output file of each of iStacks stacks found in directory mode.
+static Strings stack_filenames(const std::string& strOutFile, size_t iStacks)
+{
+    if (iStacks == 1) return Strings(1, strOutFile);
+    Strings vStrFilenames(iStacks);
+    for (size_t i = 0;i<iStacks;i++) {
+        vStrFilenames[i] = SysTools::AppendFilename(strOutFile, int(i)+1);
+    }
+    return vStrFilenames;
+}
+
+// manifest of a directory mode stack converted to strTarget, see --resume.
+static std::string manifest_name(const std::string& strTarget)
+{
+    return strTarget + ".manifest";
+}
+
+// true if the manifest records a successful conversion of the same element
+// files with the same settings into strTarget.
+static bool stack_unchanged(const Journal& manifest, const std::string& strTarget)
+{
+    return manifest.Get("complete") == 1 && SysTools::FileExists(strTarget);
+}
+
+// scans opt.strInDir for stacks.  The headers of vFiles are read ahead in
+// parallel first, so Tuvok's single threaded parser finds them cached;
+// reading is I/O bound, hence several threads per core by default.
+// With --scan-index the result is recorded under iListing.
+static vector<std::shared_ptr<FileStackInfo>>
+scan_directory(const ConvOptions& opt, IOManager& ioMan, const Strings& vFiles,
+               uint64_t iListing)
+{
     {
-        std::cerr << "Command line parse error: " << exception.what()
-                  << std::endl;
+        ProfileScope stage("ReadAhead");
+        ReadAhead(vFiles, opt.threads != 0 ? opt.threads
+                                           : 4*WorkerPool::HardwareThreads());
+    }
+    vector<std::shared_ptr<FileStackInfo>> dirinfo;
+    {
+        ProfileScope stage("ScanDirectory");
+        dirinfo = ioMan.ScanDirectory(opt.strInDir);
+    }
+    if (!opt.strScanIndex.empty() &&
+        !SaveScanIndex(opt.strScanIndex, opt.strInDir, iListing,
+                       SummarizeStacks(dirinfo))) {
+        WARNING("Could not write scan index %s", opt.strScanIndex.c_str());
+    }
+    return dirinfo;
+}
+
+// prints the stacks of opt.strInDir, from the scan index if it is current.
+static int list_stacks(const ConvOptions& opt, IOManager& ioMan)
+{
+    const Strings vFiles = ListDirectory(opt.strInDir);
+    const uint64_t iListing = opt.strScanIndex.empty() ? 0 : ListingSignature(vFiles);
+    std::vector<StackSummary> stacks;
+    if (opt.strScanIndex.empty() ||
+        !LoadScanIndex(opt.strScanIndex, opt.strInDir, iListing, stacks)) {
+        stacks = SummarizeStacks(scan_directory(opt, ioMan, vFiles, iListing));
+    }
+
+    const Strings vTargets = opt.strOutFile.empty()
+        ? Strings() : stack_filenames(opt.strOutFile, stacks.size());
+    console() << "\n" << stacks.size() << " stacks in " << opt.strInDir << "\n";
+    for (size_t i = 0;i<stacks.size();i++) {
+        const StackSummary& s = stacks[i];
+        console() << "Stack " << i+1 << ": " << s.strType << " " << s.iSize[0]
+                  << "x" << s.iSize[1] << "x" << s.iSize[2] << ", "
+                  << s.iComponents << "x" << s.iBits << " bit, "
+                  << s.vFiles.size() << " files (" << s.strDesc << ")";
+        if (!vTargets.empty()) console() << " -> " << vTargets[i];
+        console() << "\n";
+    }
+    return EXIT_SUCCESS;
+}
+
+// name for an unquantized intermediate UVF of strTarget.
+static std::string unquantized_name(const ConvOptions& opt, const std::string& strTarget)
+{
+    return SysTools::FindNextSequenceName(
+        temp_dir(opt, strTarget) +
+        SysTools::GetFilename(SysTools::RemoveExt(strTarget)) + "-unquantized.uvf");
+}
+
+// true if the conversion described by opt cannot quantize on its own.
+// Re-bricking, the bricked expression evaluator and ConvertQuantized
+// quantize while they stage the volume, directory mode handles each stack;
+// only Tuvok's evaluator and merger need a quantizing pass afterwards.
+static bool needs_quantize_pass(const ConvOptions& opt, const IOManager& ioMan)
+{
+    if (!opt.strInDir.empty() || opt.input.empty()) return false;
+    if (SysTools::ToLowerCase(SysTools::GetExt(opt.strOutFile)) != "uvf") return false;
+    if (opt.expression.empty() && opt.input.size() == 1) return false;
+    return !CanEvaluateBricked(ioMan, opt.input);
+}
+
+// Runs the conversion, merge, export or expression evaluation described by
+// opt.  Returns EXIT_SUCCESS or one of the EXIT_FAILURE_* codes.
+static int convert(ConvOptions opt, IOManager& ioMan)
+{
+    if (opt.checksums && opt.strInDir.empty()) {
+        // directory mode checksums each stack as it is done
+        opt.checksums = false;
+        const int iResult = convert(opt, ioMan);
+        if (iResult != EXIT_SUCCESS || opt.listStacks ||
+            SysTools::ToLowerCase(SysTools::GetExt(opt.strOutFile)) != "uvf") {
+            return iResult;
+        }
+        return WriteUVFChecksums(ioMan, opt.strOutFile, opt.threads != 0
+                                 ? opt.threads : WorkerPool::HardwareThreads())
+            ? EXIT_SUCCESS : EXIT_FAILURE_GENERAL;
+    }
+
+    if (opt.autoTune) {
+        TuneGoal eGoal;
+        if (!ParseTuneGoal(opt.optimize, eGoal)) {
+            std::cerr << "error: --optimize must be convert-speed, file-size "
+                      << "or read-latency\n";
+            return EXIT_FAILURE_ARG;
+        }
+        opt.autoTune = false;
+        TuneResult tune;
+        if (opt.input.empty()) {
+            WARNING("--auto-tune needs an input file, keeping the given settings");
+            return convert(opt, ioMan);
+        }
+        if (!auto_tune(opt, ioMan, eGoal, tune)) {
+            WARNING("Could not sample '%s' for --auto-tune, keeping the given "
+                    "settings", opt.input.front().c_str());
+            return convert(opt, ioMan);
+        }
+        const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        const int iResult = convert(opt, ioMan);
+        const double fSeconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        if (iResult == EXIT_SUCCESS && fSeconds > 0.0) {
+            console() << "\nAuto-tune: predicted " << tune.Throughput(tune.iBest)
+                      << " MB/s from the sample, measured "
+                      << tune.volume.Bytes() / 1024.0 / 1024.0 / fSeconds
+                      << " MB/s\n";
+        }
+        return iResult;
+    }
+
+    uint32_t iCompression = 1;
+    const bool bAutoCompression = opt.compression == "auto";
+    if (!bAutoCompression && !parse_compression(opt.compression, iCompression)) {
+        std::cerr << "error: --compression must be 0..5 or 'auto'\n";
+        return EXIT_FAILURE_ARG;
+    }
+    // a single volume converted to UVF is sampled once it is staged, by
+    // convert_sampled() further down
+    const bool bSampleStaged = bAutoCompression && opt.input.size() == 1 &&
+        opt.strInDir.empty() && opt.expression.empty() &&
+        opt.quantizeBits == 0 && !opt.quantizeTo8bits &&
+        ioMan.NeedsConversion(opt.input.front()) &&
+        ioMan.GetConverterForExt(SysTools::ToLowerCase(SysTools::GetExt(
+            opt.input.front())), false, false) != NULL &&
+        SysTools::ToLowerCase(SysTools::GetExt(opt.strOutFile)) == "uvf";
+    if (bAutoCompression && !opt.input.empty() && !bSampleStaged) {
+        // merges and expressions are sampled through their first input
+        iCompression = auto_compression(ioMan, Strings(1, opt.input.front()));
+        console() << "\nAuto compression: " << CompressionName(iCompression) << "\n";
+    }
+    ioMan.SetCompression(iCompression);
+    ioMan.SetCompressionLevel(opt.level);
+    if (opt.bricklayout == LAYOUT_COUNT && !choose_layout(opt, ioMan, opt.bricklayout)) {
         return EXIT_FAILURE_ARG;
     }
+    ioMan.SetLayout(opt.bricklayout);
 
-    HRConsoleOut* debugOut = new HRConsoleOut();
-    debugOut->SetOutput(true, true, true, false);
-    if(!debug) {
-        debugOut->SetClearOldMessage(true);
+    const unsigned iQuantizeBits = opt.quantizeBits != 0 ? opt.quantizeBits
+                                                         : (opt.quantizeTo8bits ? 8 : 0);
+    if (iQuantizeBits != 0 && (iQuantizeBits < 8 || iQuantizeBits > 16)) {
+        std::cerr << "error: --quantize-bits must be between 8 and 16\n";
+        return EXIT_FAILURE_ARG;
+    }
+    if (iQuantizeBits != 0 && needs_quantize_pass(opt, ioMan)) {
+        // run unquantized into an uncompressed temporary UVF, whose recorded
+        // value range lets the re-bricker quantize in a single pass
+        ConvOptions plain = opt;
+        plain.strOutFile = unquantized_name(opt, opt.strOutFile);
+        plain.compression = "0";
+        plain.quantizeTo8bits = false;
+        plain.quantizeBits = 0;
+        const int iResult = convert(plain, ioMan);
+        bool bOk = iResult == EXIT_SUCCESS;
+        if (bOk) {
+            ioMan.SetCompression(iCompression);
+            console() << "\nQuantizing to " << iQuantizeBits << " bits into "
+                      << opt.strOutFile << "\n";
+            bOk = ReBrickUVF(ioMan, plain.strOutFile, opt.strOutFile,
+                             temp_dir(opt, opt.strOutFile), opt.bricksize,
+                             opt.brickoverlap, opt.threads, iQuantizeBits);
+        }
+        std::remove(plain.strOutFile.c_str());
+        if (iResult != EXIT_SUCCESS) return iResult;
+        return bOk ? EXIT_SUCCESS : EXIT_FAILURE_TO_UVF;
     }
 
-    Controller::Instance().AddDebugOut(debugOut);
+    // the streaming UVF paths record their progress here with --resume
+    std::unique_ptr<Journal> journal;
+    if (opt.resume && opt.strInDir.empty() && !opt.strOutFile.empty()) {
+        journal.reset(new Journal(opt.strOutFile + ".journal",
+                                  conversion_signature(opt, opt.input)));
+        if (journal->IsResumed()) {
+            console() << "\nResuming from " << journal->GetFilename() << "\n";
+        }
+    }
 
-    Controller::Instance().SetMaxCPUMem(fMem);
-    uint32_t mem = uint32_t(Controller::Instance().SysInfo()->GetMaxUsableCPUMem()/1024/1024);
-    MESSAGE("Using up to %u MB RAM", mem);
-    cout << endl;
+    // which of "-i" or "-d" did they give?
+    string strInFile;
+    string strInFile2;
+    if( !opt.input.empty()) {
+        strInFile = opt.input.front();
+        if(opt.input.size() > 1)
+            strInFile2 = opt.input[1];
+    }
 
-    IOManager ioMan;
-    ioMan.SetCompression(compression);
-    ioMan.SetCompressionLevel(level);
-    ioMan.SetLayout(bricklayout);
+    if(SysTools::FileExists(opt.expression))
+        opt.expression = readfile(opt.expression);
 
     // If they gave us an expression, evaluate that.  Otherwise we're doing a
     // normal conversion.
-    if(!expression.empty()) {
+    if(!opt.expression.empty()) {
         // All the input files need to be UVFs if they're merging volumes.
-        for(std::vector<std::string>::const_iterator f = input.begin();
-            f != input.end(); ++f) {
+        for(std::vector<std::string>::const_iterator f = opt.input.begin();
+            f != opt.input.end(); ++f) {
             if(ioMan.NeedsConversion(*f)) {
                 T_ERROR("Expression evaluation currently requires all input volumes "
                         "to be stored as UVFs.");
@@ -239,7 +820,26 @@ int main(int argc, const char* argv[])
             }
         }
         try {
-            ioMan.EvaluateExpression(expression.c_str(), input, strOutFile);
+            ProfileScope stage("EvaluateExpression");
+            // Inputs bricked alike are streamed brick by brick on all
+            // workers; anything else goes through Tuvok's evaluator.
+            std::unique_ptr<Expression> expr;
+            try {
+                expr.reset(new Expression(opt.expression));
+            } catch(const std::runtime_error& e) {
+                WARNING("%s, passing the expression on unchanged", e.what());
+            }
+            if(expr && CanEvaluateBricked(ioMan, opt.input)) {
+                if(!EvaluateExpressionBricked(ioMan, *expr, opt.input, opt.strOutFile,
+                                              temp_dir(opt, opt.strOutFile),
+                                              opt.bricksize, opt.brickoverlap,
+                                              opt.threads, iQuantizeBits,
+                                              journal.get())) {
+                    return EXIT_FAILURE;
+                }
+            } else {
+                ioMan.EvaluateExpression(opt.expression.c_str(), opt.input, opt.strOutFile);
+            }
         } catch(const std::exception& e) {
             std::cerr << "expr exception: " << e.what() << "\n";
             return EXIT_FAILURE;
@@ -250,8 +850,8 @@ int main(int argc, const char* argv[])
     // Verify we can actually convert the data.  We can't do this for
     // directories unless we've scanned the directory already, so delay
     // error detection there.
-    if(strInDir.empty()) {
-        for(auto f = input.cbegin(); f != input.cend(); ++f) {
+    if(opt.strInDir.empty()) {
+        for(auto f = opt.input.cbegin(); f != opt.input.cend(); ++f) {
             std::string ext = SysTools::ToLowerCase(SysTools::GetExt(*f));
             bool conv_vol = ioMan.GetConverterForExt(ext, false, true) != NULL;
             bool conv_geo = ioMan.GetGeoConverterForExt(ext, false, true) != NULL;
@@ -264,7 +864,7 @@ int main(int argc, const char* argv[])
         }
     }
 
-    string targetType = SysTools::ToLowerCase(SysTools::GetExt(strOutFile));
+    string targetType = SysTools::ToLowerCase(SysTools::GetExt(opt.strOutFile));
     if (!strInFile.empty()) {
         string sourceType = SysTools::ToLowerCase(SysTools::GetExt(strInFile));
 
@@ -274,7 +874,23 @@ int main(int argc, const char* argv[])
         bool bIsGeoExt1 = ioMan.GetGeoConverterForExt(sourceType, false, false) != NULL;
 
         if(!ioMan.NeedsConversion(strInFile)) {
-            return export_data(ioMan, strInFile, strOutFile);
+            std::vector<uint64_t> vROI;
+            if (!parse_roi(opt.roi, vROI)) {
+                std::cerr << "error: --roi must be x0,y0,z0,x1,y1,z1 with "
+                          << "x0<x1, y0<y1 and z0<z1\n";
+                return EXIT_FAILURE_ARG;
+            }
+            // raw data and sub-volumes stream from the bricks, everything
+            // else goes through Tuvok's exporter
+            if (opt.lod != 0 || !vROI.empty() ||
+                targetType == "raw" || targetType == "nhdr") {
+                return ExportUVF(ioMan, strInFile, opt.strOutFile,
+                                 temp_dir(opt, opt.strOutFile), opt.lod, vROI,
+                                 opt.bricksize, opt.brickoverlap, opt.threads)
+                    ? EXIT_SUCCESS : EXIT_FAILURE_GENERAL;
+            }
+            return export_data(ioMan, strInFile, opt.strOutFile,
+                               temp_dir(opt, opt.strOutFile));
         }
 
         if (!bIsVolExt1 && !bIsGeoExt1)  {
@@ -325,188 +941,983 @@ int main(int argc, const char* argv[])
         if (strInFile2.empty()) {
             if (bIsVolExt1) {
                 if (targetType == "uvf" && sourceType == "uvf") {
-                    cout << endl << "Running in UVF to UVF mode, "
-                         << "perserving only the raw data from " << strInFile << " to "
-                         << strOutFile << endl;
-
-                    cout << "Step 1. Extracting raw data" << endl;
-                    /// use some simple format as intermediate file
-                    string tmpFile = SysTools::ChangeExt(strOutFile,"nrrd");
-
-                    // HACK: use the output file's dir as temp dir
-                    if (ioMan.ConvertDataset(strInFile, tmpFile,
-                                             SysTools::GetPath(tmpFile), true,
-                                             bricksize, brickoverlap)) {
-                        cout << endl << "Success." << endl << endl;
+                    console() << endl << "Running in UVF to UVF mode, "
+                              << "re-bricking the raw data from " << strInFile << " to "
+                              << opt.strOutFile << endl;
+
+                    if (ReBrickUVF(ioMan, strInFile, opt.strOutFile,
+                                   temp_dir(opt, opt.strOutFile),
+                                   opt.bricksize, opt.brickoverlap, opt.threads,
+                                   iQuantizeBits, journal.get())) {
+                        console() << "\nSuccess.\n\n";
+                        return EXIT_SUCCESS;
                     } else {
-                        cout << endl << "Extraction failed!" << endl << endl;
-                        return EXIT_FAILURE_TO_RAW;
+                        console() << "\nRe-bricking failed!\n\n";
+                        return EXIT_FAILURE_TO_UVF;
                     }
-
-                    cout << "Step 2. Writing new UVF file" << endl;
-                    // HACK: use the output file's dir as temp dir
-                    if (ioMan.ConvertDataset(tmpFile, strOutFile,
-                                             SysTools::GetPath(strOutFile), true,
-                                             bricksize, brickoverlap)) {
-                        if(std::remove(tmpFile.c_str()) == -1) {
-                            cout << endl << "Conversion succeeded but "
-                                 << " could not delete tmp file " << tmpFile << "\n\n";
-                        } else {
-                            cout << "\nSuccess.\n\n";
-                        }
+                } else if (iQuantizeBits > 8 && targetType == "uvf") {
+                    // Tuvok's converters only quantize to 8 bits
+                    console() << endl << "Running in volume file mode.\nConverting "
+                              << strInFile << " to " << opt.strOutFile
+                              << " quantized to " << iQuantizeBits << " bits\n\n";
+                    if (ConvertQuantized(ioMan, strInFile, opt.strOutFile,
+                                         temp_dir(opt, opt.strOutFile),
+                                         opt.bricksize, opt.brickoverlap,
+                                         opt.threads, iQuantizeBits)) {
+                        console() << "\nSuccess.\n\n";
                         return EXIT_SUCCESS;
                     } else {
-                        if(std::remove(tmpFile.c_str()) == -1) {
-                            cout << "\nUVF write failed and could not delete tmp file "
-                                 << tmpFile << "\n\n";
-                        } else {
-                            cout << "\nUVF write failed.\n\n";
-                        }
-                        return EXIT_FAILURE_TO_UVF;
+                        console() << "\nConversion failed!\n\n";
+                        return EXIT_FAILURE_GENERAL;
+                    }
+                } else if (bSampleStaged) {
+                    console() << endl << "Running in volume file mode.\nConverting "
+                              << strInFile << " to " << opt.strOutFile << "\n\n";
+                    if (convert_sampled(opt, ioMan, strInFile)) {
+                        console() << "\nSuccess.\n\n";
+                        return EXIT_SUCCESS;
+                    } else {
+                        console() << "\nConversion failed!\n\n";
+                        return EXIT_FAILURE_GENERAL;
                     }
                 } else {
-                    cout << endl << "Running in volume file mode.\nConverting "
-                         << strInFile << " to " << strOutFile << "\n\n";
-                    // HACK: use the output file's dir as temp dir
-                    if (ioMan.ConvertDataset(strInFile, strOutFile,
-                                             SysTools::GetPath(strOutFile), true,
-                                             bricksize, brickoverlap)) {
-                        cout << "\nSuccess.\n\n";
+                    console() << endl << "Running in volume file mode.\nConverting "
+                              << strInFile << " to " << opt.strOutFile << "\n\n";
+                    ProfileScope stage("ConvertDataset");
+                    if (ioMan.ConvertDataset(strInFile, opt.strOutFile,
+                                             temp_dir(opt, opt.strOutFile), true,
+                                             opt.bricksize, opt.brickoverlap,
+                                             iQuantizeBits == 8)) {
+                        stage.SetBytes(ProcessStats::FileSize(strInFile),
+                                       ProcessStats::FileSize(opt.strOutFile));
+                        console() << "\nSuccess.\n\n";
                         return EXIT_SUCCESS;
                     } else {
-                        cout << "\nConversion failed!\n\n";
+                        console() << "\nConversion failed!\n\n";
                         return EXIT_FAILURE_GENERAL;
                     }
                 }
             } else {
+                // OBJ is copied a chunk at a time; meshes with attributes and
+                // other formats are loaded whole by Tuvok
+                if (CanStreamMesh(strInFile)) {
+                    console() << "\nRunning in geometry file mode.\n"
+                              << "Streaming " << strInFile << " to "
+                              << opt.strOutFile << "\n";
+                    bool bUnsupported = false;
+                    {
+                        ProfileScope stage("StreamMesh");
+                        if (StreamMesh(ioMan, strInFile, opt.strOutFile,
+                                       temp_dir(opt, opt.strOutFile),
+                                       bUnsupported)) {
+                            stage.SetBytes(ProcessStats::FileSize(strInFile),
+                                           ProcessStats::FileSize(opt.strOutFile));
+                            console() << "\nSuccess.\n\n";
+                            return EXIT_SUCCESS;
+                        }
+                    }
+                    if (!bUnsupported) {
+                        cerr << "Error writing target mesh\n";
+                        return EXIT_FAILURE_OUT_MESH_WRITE;
+                    }
+                }
                 AbstrGeoConverter* sourceConv = ioMan.GetGeoConverterForExt(sourceType, false, true);
                 AbstrGeoConverter* targetConv = ioMan.GetGeoConverterForExt(targetType, true, false);
 
-                cout << "\nRunning in geometry file mode.\n"
-                     << "Converting " << strInFile
-                     << " (" << sourceConv->GetDesc() << ") to "
-                     << strOutFile << " (" << targetConv->GetDesc() << ")\n";
+                console() << "\nRunning in geometry file mode.\n"
+                          << "Converting " << strInFile
+                          << " (" << sourceConv->GetDesc() << ") to "
+                          << opt.strOutFile << " (" << targetConv->GetDesc() << ")\n";
                 std::shared_ptr<Mesh> m;
                 try {
+                    ProfileScope stage("ConvertToMesh");
                     m = sourceConv->ConvertToMesh(strInFile);
                 } catch ( std::exception& err) {
                     cerr << "Error trying to open the input mesh "
                          << "(" << err.what() << ")\n";
                     return EXIT_FAILURE_IN_MESH_LOAD;
                 }
-                if (!targetConv->ConvertToNative(*m,strOutFile)) {
+                ProfileScope stage("ConvertToNative");
+                if (!targetConv->ConvertToNative(*m,opt.strOutFile)) {
                     cerr << "Error writing target mesh\n";
                     return EXIT_FAILURE_OUT_MESH_WRITE;
                 }
             }
+        } else if (bIsGeoExt1) {
+            for(auto f = opt.input.cbegin()+1; f != opt.input.cend(); ++f) {
+                string sourceType2 = SysTools::ToLowerCase(SysTools::GetExt(*f));
+                if (!CanStreamMesh(*f) &&
+                    ioMan.GetGeoConverterForExt(sourceType2, false, true) == NULL) {
+                    std::cerr << "error: cannot merge a mesh with '" << *f << "'\n";
+                    return EXIT_FAILURE_MESH_MERGE;
+                }
+            }
+            if (!bIsGeoExtOut) {
+                std::cerr << "error: cannot convert geometry to volume\n";
+                return EXIT_FAILURE_CROSS_2;
+            }
+
+            console() << endl << "Running in mesh merge mode.\nMerging";
+            for (auto f = opt.input.cbegin(); f != opt.input.cend(); ++f) {
+                console() << " " << *f;
+            }
+            console() << " into " << opt.strOutFile << endl;
+
+            ProfileScope stage("MergeMeshes");
+            if (MergeMeshes(ioMan, opt.input, opt.strOutFile,
+                            temp_dir(opt, opt.strOutFile), opt.threads)) {
+                console() << "\nSuccess.\n\n";
+                return EXIT_SUCCESS;
+            } else {
+                console() << "\nMesh merge failed!\n\n";
+                return EXIT_FAILURE_MESH_MERGE;
+            }
         } else {
 
-            string sourceType2 = SysTools::ToLowerCase(SysTools::GetExt(strInFile2));
+            for(auto f = opt.input.cbegin()+1; f != opt.input.cend(); ++f) {
+                string sourceType2 = SysTools::ToLowerCase(SysTools::GetExt(*f));
 
-            bool bIsVolExt2 = ioMan.GetConverterForExt(sourceType2, false, true) != NULL;
-            bool bIsGeoExt2 = ioMan.GetGeoConverterForExt(sourceType2, false, true) != NULL;
+                bool bIsVolExt2 = ioMan.GetConverterForExt(sourceType2, false, true) != NULL;
+                bool bIsGeoExt2 = ioMan.GetGeoConverterForExt(sourceType2, false, true) != NULL;
 
-            if (!bIsVolExt2 && !bIsGeoExt2)  {
-                std::cerr << "error: Unknown file type for '" << strInFile2 << "'\n";
-                return EXIT_FAILURE_UNKNOWN_2;
-            }
+                if (!bIsVolExt2 && !bIsGeoExt2 && ioMan.NeedsConversion(*f))  {
+                    std::cerr << "error: Unknown file type for '" << *f << "'\n";
+                    return EXIT_FAILURE_UNKNOWN_2;
+                }
 
-            if (bIsGeoExt2)   {
-                std::cerr << "error: Mesh merge not supported at the moment\n";
-                return EXIT_FAILURE_MESH_MERGE;
+                if (bIsGeoExt2)   {
+                    std::cerr << "error: cannot merge a volume with a mesh\n";
+                    return EXIT_FAILURE_MESH_MERGE;
+                }
             }
 
-            vector<string> vDataSets;
+            // One scale and bias per input.  As before, a list that is one
+            // short leaves the first input unchanged.
+            vector<string> vDataSets(opt.input);
             vector<double> vScales;
             vector<double> vBiases;
-            vDataSets.push_back(strInFile);
-            vScales.push_back(1.0);
-            vBiases.push_back(0.0);
-            vDataSets.push_back(strInFile2);
-            vScales.push_back(fScale);
-            vBiases.push_back(fBias);
-
-            cout << endl << "Running in merge mode.\nConverting";
-            for (size_t i = 0;i<<vDataSets.size();i++) {
-                cout << " " << vDataSets[i];
-            }
-            cout << " to " << strOutFile << "\n\n";
-
-            // HACK: use the output file's dir as temp dir
-            if (ioMan.MergeDatasets(vDataSets, vScales, vBiases, strOutFile,
-                                    SysTools::GetPath(strOutFile))) {
-                cout << "\nSuccess.\n\n";
+            if (!merge_factors(opt.scale, vDataSets.size(), 1.0, vScales) ||
+                !merge_factors(opt.bias, vDataSets.size(), 0.0, vBiases)) {
+                std::cerr << "error: give finite --scale and --bias values once "
+                          << "per input or once per input after the first\n";
+                return EXIT_FAILURE_ARG;
+            }
+            if (opt.merge != "max" && opt.merge != "sum") {
+                std::cerr << "error: --merge must be 'max' or 'sum'\n";
+                return EXIT_FAILURE_ARG;
+            }
+            const bool bUseMaxMode = opt.merge == "max";
+
+            console() << endl << "Running in merge mode.\nConverting";
+            for (size_t i = 0;i<vDataSets.size();i++) {
+                console() << " " << vDataSets[i];
+            }
+            console() << " to " << opt.strOutFile << "\n\n";
+
+            // Inputs bricked alike are merged in one streaming pass over
+            // their bricks; anything else goes through Tuvok's merger.
+            if (CanEvaluateBricked(ioMan, vDataSets)) {
+                ProfileScope stage("MergeBricked");
+                const Expression expr(MergeExpression(vScales, vBiases, bUseMaxMode));
+                if (EvaluateExpressionBricked(ioMan, expr, vDataSets, opt.strOutFile,
+                                              temp_dir(opt, opt.strOutFile),
+                                              opt.bricksize, opt.brickoverlap,
+                                              opt.threads, iQuantizeBits,
+                                              journal.get())) {
+                    console() << "\nSuccess.\n\n";
+                    return EXIT_SUCCESS;
+                } else {
+                    console() << "\nMerging datasets failed!\n\n";
+                    return EXIT_FAILURE_MERGE;
+                }
+            }
+
+            ProfileScope stage("MergeDatasets");
+            if (ioMan.MergeDatasets(vDataSets, vScales, vBiases, opt.strOutFile,
+                                    temp_dir(opt, opt.strOutFile),
+                                    bUseMaxMode)) {
+                console() << "\nSuccess.\n\n";
                 return EXIT_SUCCESS;
             } else {
-                cout << "\nMerging datasets failed!\n\n";
+                console() << "\nMerging datasets failed!\n\n";
                 return EXIT_FAILURE_MERGE;
             }
 
         }
     } else {
         if (strInFile2 != "") {
-            cout << "\nError: Currently file merging is only supported "
-                 << " in file mode (i.e. specify -f and not -d).\n\n";
+            console() << "\nError: Currently file merging is only supported "
+                      << " in file mode (i.e. specify -f and not -d).\n\n";
             return EXIT_FAILURE_DIR_MERGE;
         }
 
+        if (opt.listStacks) return list_stacks(opt, ioMan);
+
         /// \todo: remove this restricition (one solution would be to create a UVF
         // first and then convert it to whatever is needed)
         if (targetType != "uvf") {
-            cout << "\nError: Currently UVF is the only supported "
-                 << "target type for directory processing.\n\n";
+            console() << "\nError: Currently UVF is the only supported "
+                      << "target type for directory processing.\n\n";
             return EXIT_FAILURE_MERGE_NO_UVF;
         }
 
-        cout << "\nRunning in directory mode.\nConverting "
-             << strInDir << " to " << strOutFile << "\n\n";
+        console() << "\nRunning in directory mode.\nConverting "
+                  << opt.strInDir << " to " << opt.strOutFile << "\n\n";
+
+        const Strings vDirFiles = ListDirectory(opt.strInDir);
+        const uint64_t iListing = opt.strScanIndex.empty() ? 0 : ListingSignature(vDirFiles);
+        std::vector<StackSummary> indexed;
+        if (opt.resume && !opt.strScanIndex.empty() &&
+            LoadScanIndex(opt.strScanIndex, opt.strInDir, iListing, indexed)) {
+            // a current index and complete manifests for every stack leave
+            // nothing to do, not even a scan
+            const Strings vTargets = stack_filenames(opt.strOutFile, indexed.size());
+            bool bUnchanged = true;
+            for (size_t i = 0;bUnchanged && i<indexed.size();i++) {
+                const Journal manifest(manifest_name(vTargets[i]),
+                                       conversion_signature(opt, indexed[i].vFiles));
+                bUnchanged = stack_unchanged(manifest, vTargets[i]);
+            }
+            if (bUnchanged) {
+                console() << "All " << indexed.size() << " stacks are unchanged.\n";
+                return EXIT_SUCCESS;
+            }
+        }
 
-        vector<std::shared_ptr<FileStackInfo>> dirinfo =
-                ioMan.ScanDirectory(strInDir);
+        const vector<std::shared_ptr<FileStackInfo>> dirinfo =
+            scan_directory(opt, ioMan, vDirFiles, iListing);
+        const Strings vStrFilenames = stack_filenames(opt.strOutFile, dirinfo.size());
+
+
+        // Every worker gets its own IOManager so converters never share
+        // state across threads, and an equal slice of the memory budget.
+        const size_t iJobs = std::min<size_t>(
+            opt.jobs == 0 ? WorkerPool::HardwareThreads() : opt.jobs, dirinfo.size());
+        if (iJobs > 1) {
+            Controller::Instance().SetMaxCPUMem(opt.fMem / float(iJobs));
+            console() << "Converting " << dirinfo.size() << " stacks with "
+                      << iJobs << " workers, up to "
+                      << Controller::Instance().SysInfo()->GetMaxUsableCPUMem()/1024/1024
+                      << " MB RAM each\n\n";
+        }
 
-        vector<string> vStrFilenames(dirinfo.size());
-        if (dirinfo.size() == 1) {
-            vStrFilenames[0] = strOutFile;
-        } else {
-            string strFilenameAndDirectory = SysTools::RemoveExt(strOutFile);
-            // should be "uvf" but we never know what the user specified
-            string strExt = SysTools::GetExt(strOutFile);
-            for (size_t i = 0;i<dirinfo.size();i++) {
-                vStrFilenames[i] = SysTools::AppendFilename(strOutFile, int(i)+1);
-            }
+        vector<std::unique_ptr<IOManager>> workerIO(std::max<size_t>(iJobs, 1));
+        for (size_t w = 0;w<workerIO.size();w++) {
+            workerIO[w].reset(new IOManager());
+            workerIO[w]->SetCompression(iCompression);
+            workerIO[w]->SetCompressionLevel(opt.level);
+            workerIO[w]->SetLayout(opt.bricklayout);
         }
 
+        // not vector<bool>: workers write neighbouring elements concurrently
+        vector<char> vSucceeded(dirinfo.size(), 0);
+        vector<double> vSeconds(dirinfo.size(), 0.0);
+        std::mutex coutGuard;
+
+        WorkerPool pool(iJobs);
+        pool.Run(dirinfo.size(), [&](size_t i, size_t worker) {
+            const std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+            bool bOk = false;
+            ProfileScope stage("ConvertStack");
+            // Tuvok quantizes stacks to 8 bits, deeper targets are
+            // re-bricked from an unquantized UVF
+            const bool bQuantizePass = iQuantizeBits > 8;
+            const std::string strStackOut = bQuantizePass
+                ? unquantized_name(opt, vStrFilenames[i]) : vStrFilenames[i];
+            Strings vElements;
+            for (auto e = dirinfo[i]->m_Elements.cbegin();
+                 e != dirinfo[i]->m_Elements.cend(); ++e) {
+                vElements.push_back((*e)->m_strFileName);
+            }
+            // with --resume, a stack whose files and settings match the
+            // manifest of an earlier successful run is left alone
+            Journal manifest(manifest_name(vStrFilenames[i]), opt.resume
+                             ? conversion_signature(opt, vElements) : std::string());
+            const bool bUnchanged = opt.resume &&
+                                    stack_unchanged(manifest, vStrFilenames[i]);
+            if (!bUnchanged) try {
+                if (bAutoCompression) {
+                    workerIO[worker]->SetCompression(
+                        auto_compression(*workerIO[worker], vElements));
+                }
+                bOk = workerIO[worker]->ConvertDataset(&*dirinfo[i], strStackOut,
+                                                       temp_dir(opt, vStrFilenames[i]),
+                                                       opt.bricksize, opt.brickoverlap,
+                                                       iQuantizeBits == 8);
+                if (bOk && bQuantizePass) {
+                    bOk = ReBrickUVF(*workerIO[worker], strStackOut, vStrFilenames[i],
+                                     temp_dir(opt, vStrFilenames[i]),
+                                     opt.bricksize, opt.brickoverlap,
+                                     iJobs > 1 ? 1 : opt.threads, iQuantizeBits);
+                }
+                if (bOk && opt.checksums) {
+                    bOk = WriteUVFChecksums(*workerIO[worker], vStrFilenames[i],
+                                            iJobs > 1 ? 1 : WorkerPool::HardwareThreads());
+                }
+            } catch (const std::exception& e) {
+                T_ERROR("Converting stack %u threw: %s", unsigned(i+1), e.what());
+            }
+            if (bQuantizePass) std::remove(strStackOut.c_str());
+            if (bUnchanged) {
+                bOk = true;
+            } else if (bOk && opt.resume) {
+                manifest.Set("complete", 1);
+            }
+            vSucceeded[i] = bOk;
+            if (bOk && !bUnchanged) {
+                uint64_t iBytesIn = 0;
+                for (auto e = dirinfo[i]->m_Elements.cbegin();
+                     e != dirinfo[i]->m_Elements.cend(); ++e) {
+                    iBytesIn += ProcessStats::FileSize((*e)->m_strFileName);
+                }
+                stage.SetBytes(iBytesIn, ProcessStats::FileSize(vStrFilenames[i]));
+            }
+            vSeconds[i] = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(coutGuard);
+            console() << "\nStack " << i+1 << "/" << dirinfo.size() << " ("
+                      << dirinfo[i]->m_strDesc << ") -> " << vStrFilenames[i]
+                      << (bUnchanged ? ": unchanged, skipped" :
+                          bOk ? ": success" : ": conversion failed!")
+                      << " after " << vSeconds[i] << "s\n\n";
+        });
 
         int iFailCount = 0;
         for (size_t i = 0;i<dirinfo.size();i++) {
-            if (ioMan.ConvertDataset(&*dirinfo[i], vStrFilenames[i],
-                                     SysTools::GetPath(vStrFilenames[i]),
-                                     bricksize, brickoverlap, quantizeTo8bits)) {
-                cout << "\nSuccess.\n\n";
-            } else {
-                cout << "\nConversion failed!\n\n";
+            if (!vSucceeded[i]) {
+                console() << "Failed: stack " << i+1 << " (" << dirinfo[i]->m_strDesc
+                          << ") -> " << vStrFilenames[i] << "\n";
                 iFailCount++;
-                return EXIT_FAILURE_GENERAL_DIR;
             }
         }
 
         if (iFailCount != 0)  {
-            cout << endl << iFailCount << " out of " << dirinfo.size()
-                 << " stacks failed to convert properly.\n\n";
+            console() << endl << iFailCount << " out of " << dirinfo.size()
+                      << " stacks failed to convert properly.\n\n";
+            return EXIT_FAILURE_GENERAL_DIR;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Runs every job listed in the manifest (or stdin for "-").  Each line that
+// is neither empty nor a '#' comment holds the options of one conversion,
+// with the options from the real command line as defaults.  Jobs run on
+// --jobs workers that each keep one IOManager for all of their jobs.
+static int run_batch(const std::string& manifest, const ConvOptions& defaults)
+{
+    std::ifstream file;
+    std::istream* in = &std::cin;
+    if (manifest != "-") {
+        file.open(manifest.c_str());
+        if (!file.is_open()) {
+            std::cerr << "error: could not open job file '" << manifest << "'\n";
+            return EXIT_FAILURE_ARG;
+        }
+        in = &file;
+    }
+
+    vector<size_t> vLines;
+    vector<Strings> vArgs;
+    std::string line;
+    for (size_t iLine = 1;std::getline(*in, line);iLine++) {
+        Strings args = po::split_unix(line);
+        if (args.empty() || args[0][0] == '#') continue;
+        vLines.push_back(iLine);
+        vArgs.push_back(args);
+    }
+    if (vArgs.empty()) {
+        console() << "\nNo jobs in " << manifest << "\n\n";
+        return EXIT_SUCCESS;
+    }
+
+    const size_t iWorkers = std::min<size_t>(
+        defaults.jobs == 0 ? WorkerPool::HardwareThreads() : defaults.jobs,
+        vArgs.size());
+    Controller::Instance().SetMaxCPUMem(defaults.fMem / float(iWorkers));
+    console() << "\nRunning in batch mode.\n" << vArgs.size() << " jobs on "
+              << iWorkers << " workers, up to "
+              << Controller::Instance().SysInfo()->GetMaxUsableCPUMem()/1024/1024
+              << " MB RAM each\n\n";
+
+    vector<std::unique_ptr<IOManager>> workerIO(iWorkers);
+    for (size_t w = 0;w<workerIO.size();w++) {
+        workerIO[w].reset(new IOManager());
+    }
+
+    vector<int> vResults(vArgs.size(), EXIT_SUCCESS);
+    std::mutex coutGuard;
+
+    WorkerPool pool(iWorkers);
+    pool.Run(vArgs.size(), [&](size_t i, size_t worker) {
+        const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+
+        ProfileScope stage("Job");
+        ConvOptions opt = defaults;
+        // a job only spawns workers of its own if it asks for them, and its
+        // brick threads share the cores with the other jobs
+        opt.jobs = 1;
+        opt.threads = defaults.threads != 0 ? defaults.threads :
+            uint32_t(std::max<size_t>(1, WorkerPool::HardwareThreads() / iWorkers));
+        opt.fMem = defaults.fMem / float(iWorkers);
+        try {
+            po::options_description options;
+            add_conversion_options(options, opt);
+            po::variables_map variableMap;
+            po::store( po::command_line_parser( vArgs[i] ).options(
+                           options ).run(), variableMap );
+            po::notify( variableMap );
+            uint64_t iJobBudget = 0;
+            if (opt.memory != defaults.memory) {
+                // only splits further in a directory job; the process
+                // budget stays the one given on the command line
+                if (!parse_memory(opt.memory, iJobBudget)) {
+                    throw po::error("invalid --memory '" + opt.memory + "'");
+                }
+                opt.fMem = physical_share(MemoryGovernor::ConverterShare(iJobBudget));
+            }
+            vResults[i] = convert(opt, *workerIO[worker]);
+        } catch (const po::error& e) {
+            T_ERROR("Job on line %u: %s", unsigned(vLines[i]), e.what());
+            vResults[i] = EXIT_FAILURE_ARG;
+        } catch (const std::exception& e) {
+            T_ERROR("Job on line %u: %s", unsigned(vLines[i]), e.what());
+            vResults[i] = EXIT_FAILURE_GENERAL;
+        }
+
+        const double fSeconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(coutGuard);
+        console() << "\nJob " << i+1 << "/" << vArgs.size() << " (line "
+                  << vLines[i] << "): exit code " << vResults[i] << " after "
+                  << fSeconds << "s\n\n";
+    });
+
+    int iFailCount = 0;
+    for (size_t i = 0;i<vResults.size();i++) {
+        if (vResults[i] != EXIT_SUCCESS) {
+            console() << "Failed: line " << vLines[i] << " with exit code "
+                      << vResults[i] << "\n";
+            iFailCount++;
+        }
+    }
+    if (iFailCount != 0) {
+        console() << endl << iFailCount << " out of " << vResults.size()
+                  << " jobs failed.\n\n";
+        return EXIT_FAILURE_BATCH;
+    }
+    return EXIT_SUCCESS;
+}
+
+// one job submitted to the daemon: the options of a conversion and the
+// connection its messages and exit code go back on.
+struct ServedJob {
+    std::shared_ptr<LocalSocket> client;
+    Strings args;
+};
+
+// set by SIGINT and SIGTERM to make run_server stop.
+static volatile std::sig_atomic_t serverStop = 0;
+
+static void stop_server(int iSignal)
+{
+    serverStop = 1;
+    // a second signal ends the daemon without waiting for its jobs
+    std::signal(iSignal, SIG_DFL);
+}
+
+// Runs the conversion jobs submitted by --client on the socket at strPath
+// until SIGINT or SIGTERM.  Jobs queue in arrival order and run on --jobs
+// workers, which split the memory and threads given on the daemon's
+// command line just like batch mode; the daemon's options are the defaults
+// of every job, which may not set --jobs, --memory or --threads.  Each job
+// reserves its buffers from its own share of the memory budget.  The
+// messages and progress of a job go back to its client, as lines of
+// "message|warning|error <text>", followed by "exit <code>".  On a signal
+// the daemon stops accepting, finishes the queued jobs and removes the
+// socket.
+static int run_server(const std::string& strPath, const ConvOptions& defaults)
+{
+    LocalSocket listener;
+    if (!listener.Listen(strPath)) {
+        std::cerr << "error: could not listen on '" << strPath << "'\n";
+        return EXIT_FAILURE_ARG;
+    }
+    serverStop = 0;
+    std::signal(SIGINT, stop_server);
+    std::signal(SIGTERM, stop_server);
+
+    const size_t iWorkers = defaults.jobs == 0 ? WorkerPool::HardwareThreads()
+                                               : defaults.jobs;
+    Controller::Instance().SetMaxCPUMem(defaults.fMem / float(iWorkers));
+    const uint64_t iBudget = MemoryGovernor::Instance().GetBudget();
+    MemoryGovernor::Instance().SetJobShare(
+        (iBudget - MemoryGovernor::ConverterShare(iBudget)) / iWorkers);
+    console() << "\nServing jobs on " << strPath << " with " << iWorkers
+              << " workers, up to "
+              << Controller::Instance().SysInfo()->GetMaxUsableCPUMem()/1024/1024
+              << " MB RAM each\n\n";
+
+    JobOut* jobOut = new JobOut();
+    jobOut->SetOutput(true, true, true, false);
+    Controller::Instance().AddDebugOut(jobOut);
+
+    std::mutex queueGuard;
+    std::condition_variable queued;
+    std::deque<std::shared_ptr<ServedJob>> queue;
+    size_t iSubmitted = 0;
+    bool bDraining = false;
+
+    vector<std::thread> workers;
+    for (size_t w = 0;w<iWorkers;w++) {
+        workers.push_back(std::thread([&]() {
+            IOManager ioMan;
+            for (;;) {
+                std::shared_ptr<ServedJob> job;
+                size_t iJob;
+                {
+                    std::unique_lock<std::mutex> lock(queueGuard);
+                    queued.wait(lock, [&]() { return !queue.empty() || bDraining; });
+                    if (queue.empty()) return;
+                    job = queue.front();
+                    queue.pop_front();
+                    iJob = ++iSubmitted;
+                }
+                const std::chrono::steady_clock::time_point start =
+                    std::chrono::steady_clock::now();
+
+                std::shared_ptr<LocalSocket> client = job->client;
+                jobOut->Register(job.get(), [client](DebugChannel channel,
+                                                     const char* msg) {
+                    std::string strLine = channel == CHANNEL_ERROR ? "error " :
+                        channel == CHANNEL_WARNING ? "warning " : "message ";
+                    strLine += msg;
+                    std::replace(strLine.begin(), strLine.end(), '\n', ' ');
+                    client->WriteLine(strLine);
+                });
+                ClientLineBuf clientLines(client);
+                std::ostream clientConsole(&clientLines);
+                {
+                    std::lock_guard<std::mutex> lock(consoleGuard);
+                    jobConsoles[job.get()] = &clientConsole;
+                }
+                WorkerPool::SetJobTag(job.get());
+
+                ProfileScope stage("Job");
+                ConvOptions opt = defaults;
+                opt.jobs = 1;
+                opt.threads = defaults.threads != 0 ? defaults.threads :
+                    uint32_t(std::max<size_t>(1, WorkerPool::HardwareThreads() / iWorkers));
+                opt.fMem = defaults.fMem / float(iWorkers);
+                int iResult;
+                try {
+                    po::options_description options;
+                    add_conversion_options(options, opt);
+                    po::variables_map variableMap;
+                    po::store( po::command_line_parser( job->args ).options(
+                                   options ).run(), variableMap );
+                    po::notify( variableMap );
+                    // the cores and memory were split between the workers
+                    // when the daemon started, one job cannot claim more
+                    static const char* daemonOptions[] = {"jobs", "memory", "threads"};
+                    for (size_t o = 0;o<3;o++) {
+                        if (variableMap.count(daemonOptions[o]) &&
+                            !variableMap[daemonOptions[o]].defaulted()) {
+                            throw po::error(std::string("--") + daemonOptions[o] +
+                                            " is set when the daemon starts, not per job");
+                        }
+                    }
+                    iResult = convert(opt, ioMan);
+                } catch (const po::error& e) {
+                    T_ERROR("Job %u: %s", unsigned(iJob), e.what());
+                    iResult = EXIT_FAILURE_ARG;
+                } catch (const std::exception& e) {
+                    T_ERROR("Job %u: %s", unsigned(iJob), e.what());
+                    iResult = EXIT_FAILURE_GENERAL;
+                }
+
+                WorkerPool::SetJobTag(NULL);
+                {
+                    std::lock_guard<std::mutex> lock(consoleGuard);
+                    jobConsoles.erase(job.get());
+                }
+                clientConsole.flush();
+                jobOut->Unregister(job.get());
+                std::ostringstream exitLine;
+                exitLine << "exit " << iResult;
+                client->WriteLine(exitLine.str());
+                client->Close();
+
+                const double fSeconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+                std::lock_guard<std::mutex> lock(queueGuard);
+                console() << "\nJob " << iJob << ": exit code " << iResult
+                          << " after " << fSeconds << "s\n\n";
+            }
+        }));
+    }
+
+    // a client that is slow to send its job only holds up its own reader,
+    // for at most the read timeout; finished readers are joined as new
+    // clients come in
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::list<Reader> readers;
+    while (!serverStop) {
+        for (auto r = readers.begin(); r != readers.end();) {
+            if (*r->done) {
+                r->thread.join();
+                r = readers.erase(r);
+            } else {
+                ++r;
+            }
+        }
+        if (!listener.WaitForClient(250)) continue;
+        std::shared_ptr<LocalSocket> client(new LocalSocket());
+        if (!listener.Accept(*client)) {
+            // out of descriptors or an aborted connection, try again shortly
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        client->SetReadTimeout(10000);
+        Reader reader;
+        reader.done.reset(new std::atomic<bool>(false));
+        std::shared_ptr<std::atomic<bool>> done = reader.done;
+        reader.thread = std::thread([client, done, &queueGuard, &queued, &queue,
+                                     &bDraining]() {
+            std::shared_ptr<ServedJob> job(new ServedJob());
+            job->client = client;
+            std::string line;
+            if (client->ReadLine(line)) {
+                job->args = po::split_unix(line);
+                size_t iAhead = 0;
+                bool bQueued = false;
+                {
+                    std::lock_guard<std::mutex> lock(queueGuard);
+                    if (!bDraining) {
+                        iAhead = queue.size();
+                        queue.push_back(job);
+                        bQueued = true;
+                    }
+                }
+                if (bQueued) {
+                    queued.notify_one();
+                    std::ostringstream queuedLine;
+                    queuedLine << "message Queued behind " << iAhead << " jobs";
+                    client->WriteLine(queuedLine.str());
+                } else {
+                    std::ostringstream exitLine;
+                    exitLine << "exit " << EXIT_FAILURE_GENERAL;
+                    client->WriteLine("error The daemon is shutting down");
+                    client->WriteLine(exitLine.str());
+                }
+            }
+            *done = true;
+        });
+        readers.push_back(std::move(reader));
+    }
+
+    console() << "\nShutting down, finishing the queued jobs\n\n";
+    listener.Close();
+    for (auto r = readers.begin(); r != readers.end(); ++r) r->thread.join();
+    {
+        std::lock_guard<std::mutex> lock(queueGuard);
+        bDraining = true;
+    }
+    queued.notify_all();
+    for (size_t w = 0;w<workers.size();w++) workers[w].join();
+    return EXIT_SUCCESS;
+}
+
+// strPath relative to the working directory, which the daemon does not share.
+static std::string absolute_path(const std::string& strPath)
+{
+    if (strPath.empty() || strPath[0] == '/') return strPath;
+#ifdef _WIN32
+    if (strPath.size() > 1 && strPath[1] == ':') return strPath;
+    char* cwd = _getcwd(NULL, 0);
+#else
+    char* cwd = getcwd(NULL, 0);
+#endif
+    if (!cwd) return strPath;
+    std::string strAbsolute = std::string(cwd) + "/" + strPath;
+    free(cwd);
+    return strAbsolute;
+}
+
+// Submits the conversion options of this command line to the daemon at
+// strPath and prints its messages until the job finishes.  Returns the exit
+// code of the job.
+static int run_client(const std::string& strPath, int argc, const char* argv[])
+{
+    ConvOptions opt;
+    po::options_description options;
+    add_conversion_options(options, opt);
+    po::parsed_options parsed = po::command_line_parser( argc, argv ).options(
+        options ).allow_unregistered().run();
+
+    static const char* pathOptions[] = {
+        "input", "directory", "output", "tmpdir", "scan-index", "layout-trace"
+    };
+    std::string strJob;
+    for (size_t i = 0;i<parsed.options.size();i++) {
+        const po::option& o = parsed.options[i];
+        if (o.unregistered) continue;
+        const bool bPath = std::find_if(std::begin(pathOptions), std::end(pathOptions),
+            [&](const char* p) { return o.string_key == p; }) != std::end(pathOptions);
+        Strings tokens(1, "--" + o.string_key);
+        for (size_t v = 0;v<o.value.size();v++) {
+            tokens.push_back(bPath ? absolute_path(o.value[v]) : o.value[v]);
+        }
+        // quoted for po::split_unix on the other end
+        for (size_t t = 0;t<tokens.size();t++) {
+            if (!strJob.empty()) strJob += ' ';
+            strJob += '"';
+            for (size_t c = 0;c<tokens[t].size();c++) {
+                if (tokens[t][c] == '"' || tokens[t][c] == '\\') strJob += '\\';
+                strJob += tokens[t][c];
+            }
+            strJob += '"';
         }
+    }
 
+    LocalSocket server;
+    if (!server.Connect(strPath) || !server.WriteLine(strJob)) {
+        std::cerr << "error: no daemon answers on '" << strPath << "'\n";
+        return EXIT_FAILURE_ARG;
+    }
+    std::string line;
+    while (server.ReadLine(line)) {
+        const size_t iSpace = line.find(' ');
+        const std::string strKind = line.substr(0, iSpace);
+        const std::string strText = iSpace == std::string::npos ? "" :
+                                    line.substr(iSpace+1);
+        if (strKind == "exit") {
+            return atoi(strText.c_str());
+        } else if (strKind == "error" || strKind == "warning") {
+            std::cerr << strKind << ": " << strText << "\n";
+        } else {
+            console() << strText << "\n";
+        }
+    }
+    std::cerr << "error: the daemon closed the connection before the job "
+              << "finished\n";
+    return EXIT_FAILURE_GENERAL;
+}
+
+// checks strFile against the checksums recorded when it was written.
+static int run_verify(const std::string& strFile, const ConvOptions& opt)
+{
+    IOManager ioMan;
+    const VerifyReport report = VerifyUVF(ioMan, strFile, opt.threads != 0
+                                          ? opt.threads
+                                          : WorkerPool::HardwareThreads());
+    if (!report.bChecked) {
+        std::cerr << "error: cannot verify " << strFile << ": "
+                  << report.strError << "\n";
+        return EXIT_FAILURE_ARG;
+    }
+    console() << "\nVerified " << report.iBytes / 1024.0 / 1024.0 << " MB in "
+              << report.fSeconds << "s";
+    if (report.fSeconds > 0.0) {
+        console() << " (" << report.iBytes / 1024.0 / 1024.0 / report.fSeconds
+                  << " MB/s)";
+    }
+    if (report.iBricks != 0) {
+        console() << ", decoded " << report.iBricks << " bricks";
+    }
+    console() << "\n";
+    if (report.bOk) {
+        console() << strFile << ": OK\n";
         return EXIT_SUCCESS;
     }
+    console() << strFile << ": CORRUPT, " << report.strError << "\n";
+    if (report.bBrickFound) {
+        console() << "First corrupt brick: LOD " << report.iLOD << ", brick "
+                  << report.iBrick[0] << "," << report.iBrick[1] << ","
+                  << report.iBrick[2] << "\n";
+    } else if (report.iBricks != 0) {
+        console() << "All bricks decode as recorded, the damage is outside the "
+                  << "brick data\n";
+    }
+    return EXIT_FAILURE_VERIFY;
+}
+
+int main(int argc, const char* argv[])
+{
+    ConvOptions opt;
+    bool debug = false;
+    bool experimental = false;
+    std::string batch;
+    std::string clientString;
+    std::string serverString;
+    std::string verify;
+    std::string profile;
+    float fRefresh = 10.0f;
+    std::string io("auto");
+    bool directIO = false;
+
+    try
+    {
+        po::options_description options( "uvf converter" );
+        bool showHelp(false);
+
+        options.add_options()
+          ( "help,h", po::bool_switch(&showHelp)->default_value( false ), "show help message" );
+        add_conversion_options(options, opt);
+        options.add_options()
+            ( "batch", po::value< std::string >( &batch ), "run every line of this job file (- for stdin) as a separate conversion" )
+            ( "serve", po::value< std::string >( &serverString ), "run as a daemon taking conversion jobs from --client on this UNIX socket, --jobs at a time, until SIGINT or SIGTERM" )
+            ( "client", po::value< std::string >( &clientString ), "submit the conversion on this command line to the daemon on this UNIX socket and show its progress" )
+            ( "verify", po::value< std::string >( &verify ), "check this UVF against the checksums recorded with --checksums, --threads at a time, and report the first corrupt brick" )
+            ( "profile", po::value< std::string >( &profile ), "write a per-stage timeline in Chrome trace format (chrome://tracing, Perfetto) to this file" )
+            ( "refresh", po::value< float >( &fRefresh ), "console progress updates per second (0: show every message)" )
+            ( "io", po::value< std::string >( &io ), "how staging files are written, auto: io_uring where the kernel allows it, else writer threads; uring; threads; sync: by the staging thread itself" )
+            ( "direct-io", po::bool_switch(&directIO)->default_value( false ), "write staging files past the page cache (O_DIRECT)" )
+            ( "debug", po::bool_switch(&debug)->default_value( false ), "Enable debug mode" )
+            ( "experimental", po::bool_switch(&experimental)->default_value( false ), "Enable experimental features" );
+
+        // parse program options
+        po::variables_map variableMap;
+        po::store( po::command_line_parser( argc, argv ).options(
+                       options ).allow_unregistered().run(), variableMap );
+        po::notify( variableMap );
+
+        // evaluate parsed arguments
+        if( showHelp )
+        {
+            std::cout << options << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        Controller::Instance().ExperimentalFeatures( experimental );
+    }
+    catch( std::exception& exception )
+    {
+        std::cerr << "Command line parse error: " << exception.what()
+                  << std::endl;
+        return EXIT_FAILURE_ARG;
+    }
+
+    if (!clientString.empty()) {
+        return run_client(clientString, argc, argv);
+    }
+
+    uint64_t iBudget = 0;
+    if (!parse_memory(opt.memory, iBudget)) {
+        std::cerr << "error: --memory must be a size such as 4G, a number of "
+                  << "MB, a percentage or a fraction below 1\n";
+        return EXIT_FAILURE_ARG;
+    }
+    MemoryGovernor::Instance().SetBudget(iBudget);
+    opt.fMem = physical_share(MemoryGovernor::Instance().GetConverterBudget());
+
+    AsyncFileWriter::Backend eBackend;
+    if (!AsyncFileWriter::ParseBackend(io, eBackend)) {
+        std::cerr << "error: --io must be auto, uring, threads or sync\n";
+        return EXIT_FAILURE_ARG;
+    }
+    AsyncFileWriter::SetDefaults(eBackend, directIO);
+
+    AsyncConsoleOut* debugOut = new AsyncConsoleOut(fRefresh);
+    debugOut->SetOutput(true, true, true, false);
+    if(!debug) {
+        debugOut->SetClearOldMessage(true);
+    }
+
+    Controller::Instance().AddDebugOut(debugOut);
+    consoleSink = debugOut;
+
+    ProfileOut* profileOut = NULL;
+    if(!profile.empty()) {
+        profileOut = new ProfileOut();
+        profileOut->SetOutput(true, true, true, true);
+        Controller::Instance().AddDebugOut(profileOut);
+        ProfileOut::SetActive(profileOut);
+    }
+
+    // Tuvok's statistics passes, to see what they cost of the conversion
+    StatsTimer* statsTimer = new StatsTimer();
+    statsTimer->SetOutput(true, true, true, true);
+    Controller::Instance().AddDebugOut(statsTimer);
+    const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    int iResult;
+    if (!verify.empty()) {
+        iResult = run_verify(verify, opt);
+    } else if (!serverString.empty()) {
+        iResult = run_server(serverString, opt);
+    } else if (!batch.empty()) {
+        iResult = run_batch(batch, opt);
+    } else {
+        Controller::Instance().SetMaxCPUMem(opt.fMem);
+        uint32_t mem = uint32_t(Controller::Instance().SysInfo()->GetMaxUsableCPUMem()/1024/1024);
+        MESSAGE("Using up to %u MB RAM", mem);
+        console() << endl;
+
+        IOManager ioMan;
+        iResult = convert(opt, ioMan);
+    }
+    statsTimer->Stop();
+
+    const double fSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    debugOut->Flush();
+    if (statsTimer->TotalSeconds() > 0.0 && fSeconds > 0.0) {
+        console() << "\nStatistics passes, as timed from Tuvok's progress "
+                  << "messages:";
+        for (int i = 0;i<StatsTimer::PASS_COUNT;i++) {
+            const StatsTimer::Pass ePass = StatsTimer::Pass(i);
+            if (statsTimer->Seconds(ePass) <= 0.0) continue;
+            console() << " " << StatsTimer::PassName(ePass) << " "
+                      << statsTimer->Seconds(ePass) << "s";
+        }
+        console() << ", " << statsTimer->TotalSeconds() << "s of " << fSeconds
+                  << "s (" << 100.0 * statsTimer->TotalSeconds() / fSeconds
+                  << "%)\n";
+    }
+    const MemoryGovernor& governor = MemoryGovernor::Instance();
+    console() << "\nPeak memory: " << ProcessStats::PeakRSS()/1024/1024
+              << " MB resident of a " << governor.GetBudget()/1024/1024
+              << " MB budget, at most " << governor.GetHighWater()/1024/1024
+              << " MB reserved for staging and workers";
+    if (governor.GetThrottled() != 0) {
+        console() << ", " << governor.GetThrottled() << " reservations throttled";
+    }
+    if (governor.GetOvershoots() != 0) {
+        console() << ", " << governor.GetOvershoots()
+                  << " reservations granted past the budget (at most "
+                  << governor.GetOvershootBytes()/1024/1024 << " MB over)";
+    }
+    console() << "\n";
+    if(profileOut) {
+        if(profileOut->Write(profile)) {
+            console() << "Profile written to " << profile << "\n";
+        } else {
+            std::cerr << "error: could not write profile to '" << profile << "'\n";
+        }
+    }
+    return iResult;
 }
 
 static int
-export_data(const IOManager& iom, const std::string in, const std::string out)
+export_data(const IOManager& iom, const std::string in, const std::string out,
+            const std::string tmpdir)
 {
     assert(iom.NeedsConversion(in) == false);
     tuvok::Dataset* ds = iom.CreateDataset(in, 256, false);
     const tuvok::UVFDataset* uvf = dynamic_cast<tuvok::UVFDataset*>(ds);
-    // use the output file's dir as temp dir
-    if(!iom.ExportDataset(uvf, 0, out, SysTools::GetPath(out))) {
+    ProfileScope stage("ExportDataset");
+    if(!iom.ExportDataset(uvf, 0, out, tmpdir)) {
         return EXIT_FAILURE_GENERAL;
     }
     return EXIT_SUCCESS;